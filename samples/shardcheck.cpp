@@ -0,0 +1,162 @@
+// Checks that a sharded backtest looks the same to strategies whatever the
+// number of shards: runs itself with 1 and N shards and compares a digest
+// of every callback, order id, position size and cash seen by the runtimes.
+//
+//   shardcheck <data file> <format> [shards]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "Simulator.h"
+#include "Strategy.h"
+
+using namespace xBacktest;
+
+#ifdef _WIN32
+#define popen  _popen
+#define pclose _pclose
+#endif
+
+static long   g_runtimes = 0;
+static long   g_events   = 0;
+static double g_digest   = 0;
+
+class ShardCheck : public Strategy
+{
+public:
+    void onCreate()
+    {
+        m_barNum = 0;
+        m_events = 0;
+        m_digest = 0;
+        g_runtimes++;
+    }
+
+    void onBar(const Bar& bar)
+    {
+        const char* instrument = bar.getInstrument();
+
+        m_barNum++;
+        note(1, getPositionSize(instrument) + getAvailableCash() * 1e-3);
+
+        if (m_barNum % 10 == 3) {
+            unsigned long id = buy(instrument, 1);
+            note(2, id);
+            cancelOrder(id);
+            note(3, getPositionSize(instrument));
+        } else if (m_barNum % 10 == 5) {
+            note(4, buy(instrument, 1, 0, true));
+            note(5, getPositionSize(instrument) + getAvailableCash() * 1e-3);
+        } else if (m_barNum % 10 == 8 && getPositionSize(instrument) > 0) {
+            note(6, sell(instrument, getPositionSize(instrument)));
+        }
+    }
+
+    void onSlice(const Bar* const* bars, int num)
+    {
+        note(9, num);
+    }
+
+    void onOrderFilled(const Order& order)
+    {
+        note(7, order.getId());
+    }
+
+    void onOrderFailed(const Order& order)
+    {
+        note(8, order.getId());
+    }
+
+    void onDestroy()
+    {
+        g_events += m_events;
+        g_digest += m_digest;
+    }
+
+private:
+    void note(int type, double value)
+    {
+        m_events++;
+        m_digest = m_digest * 1.0000001 + type * 7 + value;
+    }
+
+    int    m_barNum;
+    long   m_events;
+    double m_digest;
+};
+
+static int runBacktest(const char* dataFile, int format, int shardNum)
+{
+    Simulator* simulator = Simulator::instance();
+
+    simulator->getEnvironmentConfig().setShardNum(shardNum);
+    simulator->registerDataStream("data", Bar::MINUTE, 1, dataFile, format);
+
+    StrategyConfig config = simulator->createNewStrategyConfig();
+    config.setName("shardcheck");
+    config.setCreator(STRATEGY_CREATOR(ShardCheck));
+    config.subscribeDataStream("data");
+
+    simulator->loadStrategy(config);
+    simulator->run();
+
+    printf("SHARDCHECK %ld %ld %.6f\n", g_runtimes, g_events, g_digest);
+    return 0;
+}
+
+static bool runChild(const char* self, const char* dataFile, const char* format, int shardNum, std::string& result)
+{
+    std::string command = std::string("\"") + self + "\" \"" + dataFile + "\" " + format + " " + std::to_string(shardNum) + " child";
+    FILE* pipe = popen(command.c_str(), "r");
+    if (pipe == nullptr) {
+        return false;
+    }
+
+    char line[256];
+    while (fgets(line, sizeof(line), pipe) != nullptr) {
+        if (strncmp(line, "SHARDCHECK ", 11) == 0) {
+            result = line;
+        }
+    }
+
+    return pclose(pipe) == 0 && !result.empty();
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <data file> <format> [shards]\n", argv[0]);
+        return 2;
+    }
+
+    int shardNum = argc > 3 ? atoi(argv[3]) : 4;
+    if (argc > 4 && strcmp(argv[4], "child") == 0) {
+        return runBacktest(argv[1], atoi(argv[2]), shardNum);
+    }
+
+    std::string single, sharded;
+    if (!runChild(argv[0], argv[1], argv[2], 1, single) ||
+        !runChild(argv[0], argv[1], argv[2], shardNum, sharded)) {
+        fprintf(stderr, "Backtest failed.\n");
+        return 1;
+    }
+
+    printf("1 shard:  %s", single.c_str());
+    printf("%d shards: %s", shardNum, sharded.c_str());
+
+    long runtimes = 0;
+    sscanf(single.c_str(), "SHARDCHECK %ld", &runtimes);
+    if (runtimes < 2) {
+        fprintf(stderr, "The data file must hold more than one instrument.\n");
+        return 1;
+    }
+
+    if (single != sharded) {
+        fprintf(stderr, "Strategies see different callbacks with %d shards.\n", shardNum);
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
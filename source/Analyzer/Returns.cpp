@@ -1,7 +1,6 @@
 #include <cmath>
 #include <cassert>
 #include "Utils.h"
-#include "Event.h"
 #include "Returns.h"
 #include "Runtime.h"
 #include "Bar.h"
@@ -13,7 +12,6 @@ ReturnsAnalyzerBase::ReturnsAnalyzerBase()
 {
     m_netRet = 0;
     m_cumRet = 0;
-    m_event.setType(Event::EvtNewReturns);
 }
 
 ReturnsAnalyzerBase* ReturnsAnalyzerBase::getOrCreateShared(BacktestingBroker& broker)
@@ -31,7 +29,7 @@ void ReturnsAnalyzerBase::attached(BacktestingBroker& broker)
     m_lastPortfolioValue = broker.getEquity();
 }
 
-Event& ReturnsAnalyzerBase::getEvent()
+ReturnsAnalyzerBase::NewReturnsEvent& ReturnsAnalyzerBase::getEvent()
 {
     return m_event;
 }
@@ -83,10 +81,7 @@ void ReturnsAnalyzerBase::beforeOnBar(BacktestingBroker& broker, const Bar& bar)
     m_cumRet = (1 + m_cumRet) * (1 + netReturn) - 1;
 
     // Notify that new returns are available.
-    Event::Context ctx;
-    ctx.datetime = bar.getDateTime();
-    ctx.data     = this;
-    m_event.emit(bar.getDateTime(), &ctx);
+    m_event.emit(bar.getDateTime(), *this);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -100,7 +95,7 @@ void Returns::beforeAttach(BacktestingBroker& broker)
     // Get or create a shared ReturnsAnalyzerBase
     ReturnsAnalyzerBase* analyzer = ReturnsAnalyzerBase::getOrCreateShared(broker);
     if (analyzer != nullptr) {
-        analyzer->getEvent().subscribe(this);
+        analyzer->getEvent().subscribe<Returns, &Returns::onReturns>(this);
     }
 }
 
@@ -159,15 +154,6 @@ void Returns::onReturns(const DateTime& datetime, ReturnsAnalyzerBase& returnsAn
     }
 }
 
-void Returns::onEvent(int type, const DateTime& datetime, const void *context)
-{
-    if (type == Event::EvtNewReturns) {
-        Event::Context* ctx = (Event::Context *)context;
-        ReturnsAnalyzerBase* returnsAnalyzerBase = (ReturnsAnalyzerBase*)(ctx->data);
-        onReturns(ctx->datetime, *returnsAnalyzerBase);
-    }
-}
-
 const vector<Returns::Ret>& Returns::getReturns() const
 {
     return m_netReturns;
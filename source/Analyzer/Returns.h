@@ -1,7 +1,6 @@
 #ifndef RETURNS_H
 #define RETURNS_H
 
-#include "Event.h"
 #include "DataSeries.h"
 #include "StgyAnalyzer.h"
 #include "Trades.h"
@@ -14,13 +13,15 @@ namespace xBacktest
 class ReturnsAnalyzerBase : public StgyAnalyzer
 {
 public:
+    typedef Signal<const DateTime&, ReturnsAnalyzerBase&> NewReturnsEvent;
+
     ReturnsAnalyzerBase();
     static ReturnsAnalyzerBase* getOrCreateShared(BacktestingBroker& broker);
     void attached(BacktestingBroker& broker);
-    // An event will be notified when return are calculated at each bar. The hander should receive 1 parameter:
+    // An event will be notified when return are calculated at each bar. The hander should receive 2 parameters:
     // 1. The current datetime.
     // 2. This analyzer's instance
-    Event& getEvent();
+    NewReturnsEvent& getEvent();
     double getNetReturn() const;
     double getCumulativeReturn() const;
     double getEquity() const;
@@ -30,13 +31,13 @@ private:
     double m_netRet;
     double m_cumRet;
     double m_equity;
-    Event  m_event;
+    NewReturnsEvent m_event;
     double m_lastPortfolioValue;
 };
 
 
 // A `StgyAnalyzer` that calculates returns and cumulative returns for the whole portfolio.
-class Returns : public StgyAnalyzer, public IEventHandler
+class Returns : public StgyAnalyzer
 {
 public:
     typedef struct {
@@ -58,8 +59,6 @@ public:
     const vector<Ret>& getCumulativeReturns() const;
     const vector<Equity>& getEquities() const;
 
-    void onEvent(int type, const DateTime& datetime, const void *context);
-    
 private:
     void onReturns(const DateTime& datetime, ReturnsAnalyzerBase& returnsAnalyzerBase);
 
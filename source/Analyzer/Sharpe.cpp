@@ -95,16 +95,7 @@ void SharpeRatio::beforeAttach(BacktestingBroker& broker)
 {
     // Get or create a shared ReturnsAnalyzerBase
     ReturnsAnalyzerBase* analyzer = ReturnsAnalyzerBase::getOrCreateShared(broker);
-    analyzer->getEvent().subscribe(this);
-}
-
-void SharpeRatio::onEvent(int type, const DateTime& datetime, const void *context)
-{
-    if (type == Event::EvtNewReturns) {
-        Event::Context* ctx = (Event::Context *)context;
-        ReturnsAnalyzerBase* returnsAnalyzerBase = (ReturnsAnalyzerBase*)(ctx->data);
-        onReturns(ctx->datetime, *returnsAnalyzerBase);
-    }
+    analyzer->getEvent().subscribe<SharpeRatio, &SharpeRatio::onReturns>(this);
 }
 
 void SharpeRatio::onReturns(const DateTime& dateTime, ReturnsAnalyzerBase& returnsAnalyzerBase)
@@ -8,7 +8,7 @@ namespace xBacktest
 {
 
 // A `StgyAnalyzer` that calculates Sharpe ratio for the whole portfolio.
-class SharpeRatio : public StgyAnalyzer, public IEventHandler
+class SharpeRatio : public StgyAnalyzer
 {
 public:
     // @param useDailyReturns: True if daily returns should be used instead of the returns for each bar.
@@ -20,8 +20,6 @@ public:
     // @param annualized: True if the sharpe ratio should be annualized.
     double getSharpeRatio(double riskFreeRate, bool annualized = true);
 
-    void onEvent(int type, const DateTime& datetime, const void *context);
-
 private:
     void onReturns(const DateTime& dateTime, ReturnsAnalyzerBase& returnsAnalyzerBase);
 
@@ -41,8 +41,8 @@ void Trades::attached(BacktestingBroker& broker)
 {
     m_broker = &broker;
 
-    broker.getOrderUpdatedEvent().subscribe(this);
-    broker.getNewTradingDayEvent().subscribe(this);
+    broker.getOrderUpdatedEvent().subscribe<Trades, &Trades::onOrderUpdated>(this);
+    broker.getNewTradingDayEvent().subscribe<Trades, &Trades::onNewTradingDay>(this);
 }
 
 const int Trades::getCount() const
@@ -221,7 +221,7 @@ void Trades::onOrderUpdated(const OrderEvent& orderEvent)
     auto it = m_posTrackers.find(order.getInstrument());
     if (it == m_posTrackers.end()) {
         PositionTracker* tracker = new PositionTracker(instrument);
-        const Contract& contract = m_broker->getContract(order.getInstrument());
+        const Contract& contract = m_broker->getContract(order.getInstrumentId());
         tracker->setMultiplier(contract.multiplier);
         it = m_posTrackers.insert(make_pair(instrument, tracker)).first;
     }
@@ -310,13 +310,4 @@ void Trades::onNewTradingDay(const DateTime& lastDateTime, const DateTime& currD
     m_lastClosedPosNum = m_allClosedTransactions.size();
 }
 
-void Trades::onEvent(int type, const DateTime& datetime, const void *context)
-{
-    if (type == Event::EvtOrderUpdate) {
-        onOrderUpdated(*(OrderEvent*)context);
-    } else if (type == Event::EvtNewTradingDay) {
-        onNewTradingDay(*(DateTime*)context, datetime);
-    }
-}
-
 } // namespace xBacktest
\ No newline at end of file
@@ -2,7 +2,6 @@
 #define TRADES_H
 
 #include "Defines.h"
-#include "Event.h"
 #include "DataSeries.h"
 #include "StgyAnalyzer.h"
 #include "PositionTracker.h"
@@ -19,7 +18,7 @@ namespace xBacktest
 //
 //    * The trade's profit was $10.
 //    * The trade's return is 100%, even though your whole portfolio went from $1000 to $1020, a 2% return.
-class Trades : public StgyAnalyzer, public IEventHandler
+class Trades : public StgyAnalyzer
 {
 public:
     typedef struct {
@@ -71,8 +70,6 @@ public:
 
     void getAllTradeRecords(vector<TradingRecord>& trades) const;
 
-    void onEvent(int type, const DateTime& datetime, const void *context);
-
 private:
     const Contract& getContract(const string& instrument) const;
     void updateTrades(const DateTime& dt, PositionTracker& posTracker);
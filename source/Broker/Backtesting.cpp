@@ -128,7 +128,7 @@ void BacktestingBroker::registerContract(const Contract& contract)
         return;
     }
     
-    m_contracts[contract.instrument] = contract;
+    m_contracts[SymbolTable::intern(contract.instrument)] = contract;
 }
 
 FillStrategy& BacktestingBroker::getFillStrategy(int resolution)
@@ -163,7 +163,7 @@ void BacktestingBroker::getActiveOrders(const string& instrument)
 
 int BacktestingBroker::getShares(const string& instrument) const
 {
-    map<string, BrokerPos>::const_iterator itor = m_positions.find(instrument);
+    const auto& itor = m_positions.find(SymbolTable::find(instrument));
     if (itor != m_positions.end()) {
         return itor->second.totalShares;
     }
@@ -172,9 +172,14 @@ int BacktestingBroker::getShares(const string& instrument) const
 }
 
 int BacktestingBroker::getLongShares(const string& instrument) const
+{
+    return getLongShares(SymbolTable::find(instrument));
+}
+
+int BacktestingBroker::getLongShares(InstrumentId instrumentId) const
 {
     int shares = 0;
-    const auto& itor = m_positions.find(instrument);
+    const auto& itor = m_positions.find(instrumentId);
     if (itor != m_positions.end()) {
         for (const auto& subpos : itor->second.subPositions) {
             if (subpos.shares > 0) {
@@ -188,9 +193,14 @@ int BacktestingBroker::getLongShares(const string& instrument) const
 }
 
 int BacktestingBroker::getShortShares(const string& instrument) const
+{
+    return getShortShares(SymbolTable::find(instrument));
+}
+
+int BacktestingBroker::getShortShares(InstrumentId instrumentId) const
 {
     int shares = 0;
-    const auto& itor = m_positions.find(instrument);
+    const auto& itor = m_positions.find(instrumentId);
     if (itor != m_positions.end()) {
         for (const auto& subpos : itor->second.subPositions) {
             if (subpos.shares < 0) {
@@ -210,27 +220,25 @@ void BacktestingBroker::getPositions()
 
 const Contract& BacktestingBroker::getContract(const string& instrument) const
 {
-    static Contract defaultContract;
-    // Performance optimization
-    static Contract cachedContract;
+    return getContract(SymbolTable::find(instrument));
+}
 
-    if (cachedContract.instrument != instrument) {
-        const auto& itor = m_contracts.find(instrument);
-        if (itor != m_contracts.end()) {
-            cachedContract = itor->second;
-            return cachedContract;
-        } else {
-            return defaultContract;
-        }
-    } else {
-        return cachedContract;
+const Contract& BacktestingBroker::getContract(InstrumentId instrumentId) const
+{
+    static const Contract defaultContract;
+
+    const auto& itor = m_contracts.find(instrumentId);
+    if (itor != m_contracts.end()) {
+        return itor->second;
     }
+
+    return defaultContract;
 }
 
 // Commission models, for implementing different commission schemes.
 double BacktestingBroker::calculateCommission(const Order& order, double price, int quantity, double multiplier)
 {
-    const Contract& contract = getContract(order.getInstrument());
+    const Contract& contract = getContract(order.getInstrumentId());
 
     switch (contract.commType) {
     // Always returns 0
@@ -263,7 +271,7 @@ double BacktestingBroker::calculateCommission(const Order& order, double price,
 
 double BacktestingBroker::calculateSlippage(const Order& order, double price, int quantity, double multiplier)
 {
-    const Contract& contract = getContract(order.getInstrument());
+    const Contract& contract = getContract(order.getInstrumentId());
 
     switch (contract.slippageType) {
     default:
@@ -286,13 +294,13 @@ double BacktestingBroker::calculateSlippage(const Order& order, double price, in
 
 void BacktestingBroker::updateEquityWithBar(const Bar& bar, bool onClose)
 {
-    const char* instrument = bar.getInstrument();
+    InstrumentId instrumentId = bar.getInstrumentId();
     m_posProfit = 0;
     m_portfolioValue = 0;
 
     for (auto& pos : m_positions) {
         double instrPrice = pos.second.lastPrice;
-        if (pos.first == instrument) {
+        if (pos.first == instrumentId) {
             // Update position's last price.
             pos.second.lastPrice = bar.getClose();
             // Use close price to calculate equity.
@@ -309,8 +317,8 @@ void BacktestingBroker::updateEquityWithBar(const Bar& bar, bool onClose)
                 continue;
             }
 
-            double multiplier = getContract(bar.getInstrument()).multiplier;
-            double marginRatio = getContract(bar.getInstrument()).marginRatio;
+            double multiplier = getContract(instrumentId).multiplier;
+            double marginRatio = getContract(instrumentId).marginRatio;
 
             double profit = 0.0;
             if (shares > 0) {
@@ -368,7 +376,7 @@ void BacktestingBroker::printPositionList(Order* orderRef)
 {
     std::cout << "BacktestingBroker: OrderID: " << orderRef->getId() << std::endl;
     for (const auto& pos : m_positions) {
-        std::cout << pos.first << ":\n";
+        std::cout << SymbolTable::getName(pos.first) << ":\n";
         for (const auto& subpos : pos.second.subPositions) {
             std::cout << "Quantity: " << subpos.shares << ", Price: " << subpos.price << std::endl;
         }
@@ -387,10 +395,10 @@ bool BacktestingBroker::commitOrderExecution(Order* orderRef, const Bar& bar, co
     bool   isBuy  = orderRef->isBuy();
     double availableCash = getAvailableCash();
     double resultingCash = getCash();
-    double multiplier    = getContract(orderRef->getInstrument()).multiplier;
+    double multiplier    = getContract(orderRef->getInstrumentId()).multiplier;
     double commission    = calculateCommission(*orderRef, price, quantity, multiplier);
     double slippage      = calculateSlippage(*orderRef, price, quantity, multiplier);
-    double marginRatio   = getContract(orderRef->getInstrument()).marginRatio;
+    double marginRatio   = getContract(orderRef->getInstrumentId()).marginRatio;
 
     double cost = price * quantity * multiplier;
     double margin = marginRatio * cost;
@@ -433,7 +441,7 @@ bool BacktestingBroker::commitOrderExecution(Order* orderRef, const Bar& bar, co
     orderRef->addExecutionInfo(orderExecutionInfo);
 
     // Commit the order execution and update equity.
-    map<string, BrokerPos>::iterator it = m_positions.find(orderRef->getInstrument());
+    auto it = m_positions.find(orderRef->getInstrumentId());
     if (isOpen) {
         if (it == m_positions.end()) {
             BrokerPos pos = { 0 };
@@ -446,7 +454,7 @@ bool BacktestingBroker::commitOrderExecution(Order* orderRef, const Bar& bar, co
             item.shares = sharesDelta;
             pos.subPositions.push_back(item);
 
-            m_positions.insert(std::make_pair(orderRef->getInstrument(), pos));
+            m_positions.insert(std::make_pair(orderRef->getInstrumentId(), pos));
         } else {
             SubPosItem item = { 0 };
             item.price = price;
@@ -588,7 +596,7 @@ bool BacktestingBroker::commitOrderExecution(Order* orderRef, const Bar& bar, co
 void BacktestingBroker::placeOrder(const Order& order)
 {
     if (order.isInitial()) {
-        int sharesLong = getLongShares(order.getInstrument());
+        int sharesLong = getLongShares(order.getInstrumentId());
         if (order.getAction() == Order::Action::SELL && sharesLong < order.getQuantity()) {
             char error[64];
             sprintf(error, "Not enough shares to sell %s, shares: %d, required: %d.\n", 
@@ -596,7 +604,7 @@ void BacktestingBroker::placeOrder(const Order& order)
             ASSERT(false, error);
         }
 
-        int sharesShort = getShortShares(order.getInstrument());
+        int sharesShort = getShortShares(order.getInstrumentId());
         if (order.getAction() == Order::Action::BUY_TO_COVER && sharesShort > order.getQuantity() * -1) {
             char error[64];
             sprintf(error, "Not enough shares to covert %s, shares: %d, required: %d.\n",
@@ -623,7 +631,7 @@ void BacktestingBroker::placeOrder(const Order& order)
         // Process intra-bar order if needed.
         if (order.getExecTiming() == Order::ExecTiming::IntraBar) {
             Bar outBar;
-            if (getLastBar(order.getInstrument(), outBar)) {
+            if (getLastBar(order.getInstrumentId(), outBar)) {
                 processOrders(outBar);
             } else {
                 char str[128];
@@ -682,17 +690,17 @@ void BacktestingBroker::saveCurrBar(const Bar& bar)
         m_lastBarDateTime = bar.getDateTime();
     }
 
-    auto it = m_lastBars.find(bar.getInstrument());
+    auto it = m_lastBars.find(bar.getInstrumentId());
     if (it == m_lastBars.end()) {
-        it = m_lastBars.insert(std::make_pair(bar.getInstrument(), bar)).first;
+        it = m_lastBars.insert(std::make_pair(bar.getInstrumentId(), bar)).first;
     } else {
         it->second = bar;
     }
 }
 
-bool BacktestingBroker::getLastBar(const string& instrument, Bar& outBar) const
+bool BacktestingBroker::getLastBar(InstrumentId instrumentId, Bar& outBar) const
 {
-    unordered_map<string, Bar>::const_iterator it = m_lastBars.find(instrument);
+    const auto& it = m_lastBars.find(instrumentId);
     if (it != m_lastBars.end()) {
         outBar = it->second;
         return true;
@@ -711,8 +719,8 @@ bool BacktestingBroker::preProcessOrder(Order* orderRef, const Bar& bar)
 
     Order::Action action    = orderRef->getAction();
     int  quantity           = orderRef->getQuantity();
-    int  sharesLong         = getLongShares(orderRef->getInstrument());
-    int  sharesShort        = getShortShares(orderRef->getInstrument());
+    int  sharesLong         = getLongShares(orderRef->getInstrumentId());
+    int  sharesShort        = getShortShares(orderRef->getInstrumentId());
     bool possibilityOfTrade = true;
 
     // If the bar's shape looks like a '-', there is no possibility of trading at this bar.
@@ -761,7 +769,7 @@ bool BacktestingBroker::postProcessOrder(Order* orderRef, const Bar& bar)
     if (!orderRef->getGoodTillCanceled()) {
         bool expired = false;
         Bar bar;
-        if (getLastBar(orderRef->getInstrument(), bar)) {
+        if (getLastBar(orderRef->getInstrumentId(), bar)) {
             if (bar.getResolution() >= Bar::DAY) {
                 expired = bar.getDateTime().date() >= orderRef->getAcceptedDateTime().date();
             }
@@ -858,6 +866,7 @@ void BacktestingBroker::onBarEvent(const Bar& bar)
     getFillStrategy(bar.getResolution()).onBar(bar.getDateTime(), bar);
 
     // 3: Process remaining orders
+    expireOrders(bar.getDateTime());
     processOrders(bar);
 
     // 4: Update equity with bar.
@@ -871,6 +880,31 @@ void BacktestingBroker::onPostBarEvent(const Bar& bar)
 {
 }
 
+void BacktestingBroker::onSliceEvent(const Bar* const* bars, int num)
+{
+    if (num <= 0) {
+        return;
+    }
+
+    expireOrders(bars[0]->getDateTime());
+
+    for (int i = 0; i < num; i++) {
+        const Bar& bar = *bars[i];
+        saveCurrBar(bar);
+        getFillStrategy(bar.getResolution()).onBar(bar.getDateTime(), bar);
+        processOrders(bar);
+        updateEquityWithBar(bar);
+        notifyAnalyzers(bar);
+    }
+}
+
+void BacktestingBroker::onPostSliceEvent(const Bar* const* bars, int num)
+{
+    for (int i = 0; i < num; i++) {
+        onPostBarEvent(*bars[i]);
+    }
+}
+
 bool BacktestingBroker::checkExpired(Order* orderRef, const DateTime& datetime)
 {
     // For non-GTC orders we need to check if the order has expired.
@@ -896,28 +930,33 @@ bool BacktestingBroker::checkExpired(Order* orderRef, const DateTime& datetime)
     return false;
 }
 
-void BacktestingBroker::processOrders(const Bar& bar)
+void BacktestingBroker::expireOrders(const DateTime& datetime)
 {
     if (m_activeOrders.size() == 0) {
         return;
     }
 
     vector<Order*> orderRefs;
-
-    // Check if order has expired.
     for (auto& ord : m_activeOrders) {
         orderRefs.push_back(&(ord.second));
     }
 
     for (size_t i = 0; i < orderRefs.size(); i++) {
-        checkExpired(orderRefs[i], bar.getDateTime());
+        checkExpired(orderRefs[i], datetime);
     }
+}
 
-    orderRefs.clear();
+void BacktestingBroker::processOrders(const Bar& bar)
+{
+    if (m_activeOrders.size() == 0) {
+        return;
+    }
+
+    vector<Order*> orderRefs;
     // This is to froze the orders that will be processed in this event, to avoid new getting orders introduced
     // and processed on this very same event.
     for (auto& ord : m_activeOrders) {
-        if (ord.second.getInstrument() == bar.getInstrument()) {
+        if (ord.second.getInstrumentId() == bar.getInstrumentId()) {
             Order* ref = &(ord.second);
             orderRefs.push_back(ref);
         }
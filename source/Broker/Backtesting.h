@@ -48,8 +48,11 @@ public:
     void getPendingOrders();
     int  getShares(const string& instrument) const;
     int  getLongShares(const string& instrument) const;
+    int  getLongShares(InstrumentId instrumentId) const;
     int  getShortShares(const string& instrument) const;
+    int  getShortShares(InstrumentId instrumentId) const;
     const Contract& getContract(const string& instrument) const;
+    const Contract& getContract(InstrumentId instrumentId) const;
     void getPositions();
     void getActiveInstruments();
     void getValue();
@@ -63,6 +66,10 @@ public:
 
     void onBarEvent(const Bar& bar);
     void onPostBarEvent(const Bar& bar);
+    // Same as onBarEvent() on each bar of a time slice, bars share the same
+    // time so expired orders are only looked for once.
+    void onSliceEvent(const Bar* const* bars, int num);
+    void onPostSliceEvent(const Bar* const* bars, int num);
     
     StgyAnalyzer* getNamedAnalyzer(const string& name);
     void attachAnalyzerEx(StgyAnalyzer& strategyAnalyzer, const string& name = "");
@@ -88,7 +95,7 @@ private:
 
     void saveCurrBar(const Bar& bar);
 
-    bool getLastBar(const string& instrument, Bar& outBar) const;
+    bool getLastBar(InstrumentId instrumentId, Bar& outBar) const;
 
     // Return True if further processing is needed.
     bool preProcessOrder(Order* orderRef, const Bar& bar);
@@ -97,6 +104,7 @@ private:
 
     void onBarImpl(Order* orderRef, const Bar& bar);
     bool checkExpired(Order* orderRef, const DateTime& datetime);
+    void expireOrders(const DateTime& datetime);
     void processOrders(const Bar& bar);
     void notifyAnalyzers(const Bar& bar);
 
@@ -135,7 +143,7 @@ private:
         double lastPrice;
         list<SubPosItem> subPositions;
     } BrokerPos;
-    map<string, BrokerPos> m_positions;
+    InstrumentMap<BrokerPos> m_positions;
 
     // Active order map must be a 'Ordered Map', 
     // because of orders were processed FIFO.
@@ -146,8 +154,8 @@ private:
     bool m_allowFractions;
     bool m_allowNegativeCash;
 
-    unordered_map<string, Contract> m_contracts;
-    unordered_map<string, Bar> m_lastBars;
+    InstrumentMap<Contract> m_contracts;
+    InstrumentMap<Bar> m_lastBars;
 
     DateTime m_firstBarDateTime;
     DateTime m_lastBarDateTime;
@@ -5,8 +5,6 @@ namespace xBacktest
 
 BaseBroker::BaseBroker()
 {
-    m_orderEvent.setType(Event::EvtOrderUpdate);
-    m_newTradingDayEvent.setType(Event::EvtNewTradingDay);
 }
 
 BaseBroker::~BaseBroker()
@@ -16,20 +14,20 @@ BaseBroker::~BaseBroker()
 
 void BaseBroker::notifyOrderEvent(OrderEvent& orderEvent)
 {
-    m_orderEvent.emit(DateTime(), &orderEvent);
+    m_orderEvent.emit(orderEvent);
 }
 
 void BaseBroker::notifyNewTradingDayEvent(const DateTime& lastDateTime, const DateTime& currDateTime)
 {
-    m_newTradingDayEvent.emit(currDateTime, &lastDateTime);
+    m_newTradingDayEvent.emit(lastDateTime, currDateTime);
 }
 
-Event& BaseBroker::getOrderUpdatedEvent()
+BaseBroker::OrderUpdatedEvent& BaseBroker::getOrderUpdatedEvent()
 {
 	return m_orderEvent;
 }
 
-Event& BaseBroker::getNewTradingDayEvent()
+BaseBroker::NewTradingDayEvent& BaseBroker::getNewTradingDayEvent()
 {
     return m_newTradingDayEvent;
 }
@@ -3,7 +3,7 @@
 
 #include "Observer.h"
 #include "Order.h"
-#include "Event.h"
+#include "Signal.h"
 
 namespace xBacktest
 {
@@ -13,6 +13,9 @@ namespace xBacktest
 class BaseBroker
 {
 public:
+    typedef Signal<const OrderEvent&> OrderUpdatedEvent;
+    typedef Signal<const DateTime&, const DateTime&> NewTradingDayEvent;
+
 	BaseBroker();
 
     virtual ~BaseBroker();
@@ -21,12 +24,14 @@ public:
 
     void notifyNewTradingDayEvent(const DateTime& lastDateTime, const DateTime& currDateTime);
 
-    // Handlers should expect 2 parameters:
-    // 1: broker instance
-    // 2: OrderEvent instance
-	Event& getOrderUpdatedEvent();
+    // Handlers should expect 1 parameter:
+    // 1: OrderEvent instance
+	OrderUpdatedEvent& getOrderUpdatedEvent();
 
-    Event& getNewTradingDayEvent();
+    // Handlers should expect 2 parameters:
+    // 1: datetime of the last bar of the previous trading day
+    // 2: datetime of the first bar of the new trading day
+    NewTradingDayEvent& getNewTradingDayEvent();
 
 	// Returns the number of shares for an instrument.
 	virtual int getShares(const string& instrument) const = 0;
@@ -47,9 +52,9 @@ public:
 	virtual void cancelOrder(unsigned long orderId) = 0;
 
 private:
-	Event m_orderEvent;
+	OrderUpdatedEvent m_orderEvent;
     // The trading day is the time span that a particular stock/futures exchange is open.
-    Event m_newTradingDayEvent;
+    NewTradingDayEvent m_newTradingDayEvent;
 };
 
 } // namespace xBacktest
@@ -3,6 +3,7 @@
 #include "Backtesting.h"
 #include "Logger.h"
 #include "Errors.h"
+#include "Utils.h"
 
 namespace xBacktest
 {
@@ -21,8 +22,39 @@ void FillStrategy::onOrderFilled(const Order& order)
 // Order filling strategies
 //
 // Returns the trigger price for a Stop or StopLimit order, or None if the stop price was not yet penetrated.
-static double get_stop_price_trigger(Order::Action action, double stopPrice, const Bar& bar)
+// Same rules on prices of a fixed-price contract, compared exactly as ticks.
+static long long get_stop_ticks_trigger(Order::Action action, long long stopTicks, long long open, long long high, long long low)
 {
+    if (action == Order::Action::BUY || action == Order::Action::BUY_TO_COVER) {
+        if (low > stopTicks) {
+            return open;
+        }
+        return (stopTicks <= high && open > stopTicks) ? open : stopTicks;
+    } else if (action == Order::Action::SELL || action == Order::Action::SELL_SHORT) {
+        if (high < stopTicks) {
+            return open;
+        }
+        return (stopTicks >= low && open < stopTicks) ? open : stopTicks;
+    }
+
+    ASSERT(false, "Unknown action");
+    return 0;
+}
+
+static double get_stop_price_trigger(Order::Action action, double stopPrice, const Bar& bar, const Utils::TickScale& scale)
+{
+    if (scale.isValid()) {
+        long long ticks = get_stop_ticks_trigger(action, 
+            scale.toTicks(stopPrice), 
+            scale.toTicks(bar.getOpen()), 
+            scale.toTicks(bar.getHigh()), 
+            scale.toTicks(bar.getLow()));
+        if (ticks == 0) {
+            ASSERT(false, "Can not trigger STOP price.");
+        }
+        return scale.toPrice(ticks);
+    }
+
     double ret = 0.0;
     double open = bar.getOpen();
     double high = bar.getHigh();
@@ -68,11 +100,45 @@ static double get_stop_price_trigger(Order::Action action, double stopPrice, con
 }
 
 // Returns the trigger price for a Limit or StopLimit order, or None if the limit price was not yet penetrated.
+static long long get_limit_ticks_trigger(Order::Action action, long long limitTicks, long long open, long long high, long long low)
+{
+    if (action == Order::Action::BUY || action == Order::Action::BUY_TO_COVER) {
+        if (high < limitTicks) {
+            return open;
+        } else if (limitTicks >= low) {
+            return open < limitTicks ? open : limitTicks;
+        }
+    } else if (action == Order::Action::SELL || action == Order::Action::SELL_SHORT) {
+        if (low > limitTicks) {
+            return open;
+        } else if (limitTicks <= high) {
+            return open > limitTicks ? open : limitTicks;
+        }
+    } else {
+        assert(false);
+    }
+
+    return 0;
+}
+
 static double get_limit_price_trigger(
     Order::Action action, 
     double limitPrice, 
-    const Bar& bar)
+    const Bar& bar,
+    const Utils::TickScale& scale)
 {
+    if (scale.isValid()) {
+        long long ticks = get_limit_ticks_trigger(action, 
+            scale.toTicks(limitPrice), 
+            scale.toTicks(bar.getOpen()), 
+            scale.toTicks(bar.getHigh()), 
+            scale.toTicks(bar.getLow()));
+        if (ticks == 0) {
+            ASSERT(false, "Can not trigger LIMIT price.");
+        }
+        return scale.toPrice(ticks);
+    }
+
     double ret = 0.0;
     double open = bar.getOpen();
     double high = bar.getHigh();
@@ -113,6 +179,13 @@ static double get_limit_price_trigger(
     return ret;
 }
 
+// Tick grid of the instrument, invalid unless its contract is fixed-price.
+static Utils::TickScale get_tick_scale(BaseBroker& broker, const Bar& bar)
+{
+    const Contract& contract = ((BacktestingBroker&)broker).getContract(bar.getInstrumentId());
+    return Utils::TickScale(contract.fixedPrice ? contract.tickSize : 0);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 DefaultStrategy::DefaultStrategy(double volumeLimit)
 {
@@ -129,7 +202,7 @@ void DefaultStrategy::onBar(const DateTime& datetime, const Bar& bar)
     }
 
     // Update the volume available for each instrument.
-    const string& instrument = bar.getInstrument();
+    InstrumentId instrument = bar.getInstrumentId();
 
     if (bar.getResolution() == Bar::TICK) {
         m_volumeLeft[instrument] = bar.getVolume();
@@ -142,7 +215,7 @@ void DefaultStrategy::onOrderFilled(const Order& order)
 {
     // Update the volume left.
     if (m_volumeLimit != 0) {
-        m_volumeLeft[order.getInstrument()] -= order.getExecutionInfo().getQuantity();
+        m_volumeLeft[order.getInstrumentId()] -= order.getExecutionInfo().getQuantity();
     }
 }
 
@@ -157,7 +230,7 @@ int DefaultStrategy::calculateFillSize(const Order& order, BaseBroker& broker, c
     long long volumeLeft = 0;
     // If m_volumeLimit == 0 then allow all the order to get filled.
     if (m_volumeLimit > 0) {
-        map<string, long long>::const_iterator it = m_volumeLeft.find(order.getInstrument());
+        const auto& it = m_volumeLeft.find(order.getInstrumentId());
         if (it == m_volumeLeft.end()) {
             return 0;
         }
@@ -210,7 +283,7 @@ FillInfo DefaultStrategy::fillLimitOrder(Order* orderRef, BaseBroker& broker, co
     }
 
     BacktestingBroker& backtestBroker = (BacktestingBroker&) broker;
-    double price = get_limit_price_trigger(orderRef->getAction(), orderRef->getLimitPrice(), bar);
+    double price = get_limit_price_trigger(orderRef->getAction(), orderRef->getLimitPrice(), bar, get_tick_scale(broker, bar));
     if (price > 0.0) {
         return FillInfo(price, fillSize);
     }
@@ -224,7 +297,7 @@ FillInfo DefaultStrategy::fillStopOrder(Order* orderRef, BaseBroker& broker, con
     // First check if the stop price was hit so the market order becomes active.
     double stopPriceTrigger = 0;
     if (!orderRef->getStopHit()) {
-        stopPriceTrigger = get_stop_price_trigger(orderRef->getAction(), orderRef->getStopPrice(), bar);
+        stopPriceTrigger = get_stop_price_trigger(orderRef->getAction(), orderRef->getStopPrice(), bar, get_tick_scale(broker, bar));
         orderRef->setStopHit(stopPriceTrigger != 0);
     }
 
@@ -257,7 +330,7 @@ FillInfo DefaultStrategy::fillStopLimitOrder(Order* orderRef, BaseBroker& broker
     // First check if the stop price was hit so the limit order becomes active.
     double stopPriceTrigger = 0;
     if (!orderRef->getStopHit()) {
-        stopPriceTrigger = get_stop_price_trigger(orderRef->getAction(), orderRef->getStopPrice(), bar);
+        stopPriceTrigger = get_stop_price_trigger(orderRef->getAction(), orderRef->getStopPrice(), bar, get_tick_scale(broker, bar));
         orderRef->setStopHit(stopPriceTrigger != 0);
     }
 
@@ -269,7 +342,7 @@ FillInfo DefaultStrategy::fillStopLimitOrder(Order* orderRef, BaseBroker& broker
             return FillInfo();
         }
 
-        double price = get_limit_price_trigger(orderRef->getAction(), orderRef->getLimitPrice(), bar);
+        double price = get_limit_price_trigger(orderRef->getAction(), orderRef->getLimitPrice(), bar, get_tick_scale(broker, bar));
         if (price != 0) {
             // If we just hit the stop price, we need to make additional checks.
             if (stopPriceTrigger != 0) {
@@ -130,7 +130,7 @@ private:
 
 private:
     double m_volumeLimit;
-    map<string, long long> m_volumeLeft;
+    InstrumentMap<long long> m_volumeLeft;
 };
 
 // Tick data based fill strategy
@@ -65,6 +65,7 @@ const DateTime& OrderExecutionInfo::getDateTime() const
 Order::Order()
 {
     m_id               = 0;
+    m_instrumentId     = 0;
     m_quantity         = 0;
     m_filled           = 0;
     m_avgFillPrice     = 0;
@@ -97,6 +98,7 @@ Order::Order(unsigned long orderId, Type type, Action action, const string& inst
     m_type = type;
     m_action = action;
     m_instrument = instrument;
+    m_instrumentId = SymbolTable::intern(instrument);
     m_quantity = quantity;
     m_filled = 0;
     m_avgFillPrice = 0;
@@ -186,6 +188,11 @@ const string& Order::getInstrument() const
     return m_instrument;
 }
 
+InstrumentId Order::getInstrumentId() const
+{
+    return m_instrumentId;
+}
+
 int Order::getQuantity() const
 {
     return m_quantity;
@@ -4,6 +4,7 @@
 #include <string>
 #include <stdexcept>
 #include "DateTime.h"
+#include "SymbolTable.h"
 
 using std::string;
 using std::invalid_argument;
@@ -264,6 +265,7 @@ public:
 	bool isFilled() const;
     // Returns the instrument identifier.
 	const string& getInstrument() const;
+    InstrumentId getInstrumentId() const;
     // Returns the quantity.
 	int getQuantity() const;
     // Returns the number of shares that have been executed.
@@ -343,6 +345,7 @@ private:
 	Type               m_type;
     Action             m_action;
     string             m_instrument;
+    InstrumentId       m_instrumentId;
     int                m_quantity;
     int                m_filled;
     double             m_avgFillPrice;
@@ -5,14 +5,46 @@
 #include <map>
 #include "Defines.h"
 #include "DateTime.h"
+#include "SymbolTable.h"
 
 #define BAR_FIELD_SANITY_CHECK    (0)
 
 namespace xBacktest
 {
 
+// Compact layouts of a bar on the dispatch path. Both are trivially copyable,
+// bars are copied between feeds, events and runtimes without constructors or
+// allocations.
+//
+// BarRecord holds what every bar has, the datetime, the instrument and the
+// prices are in its first 64 bytes. TickRecord holds the L1 quote which only
+// TICK bars fill, it follows the record so that OHLCV bars never touch it.
+typedef struct {
+    DateTime     datetime;
+    InstrumentId instrumentId;
+    int          resolution;
+    int          interval;
+    short        securityType;
+    bool         valid;
+    double       open;
+    double       high;
+    double       low;
+    double       close;
+    long long    volume;
+    long long    openInt;
+    double       amount;
+} BarRecord;
+
+typedef struct {
+    double    lastPrice;
+    double    bidPrice1;
+    double    askPrice1;
+    long long bidVolume1;
+    long long askVolume1;
+} TickRecord;
+
 // A Bar is a summary of the trading activity for a security in a given period.
-// Optimization to reduce memory footprint.
+// It's a thin adapter over a BarRecord and a TickRecord.
 class DllExport Bar
 {
 public:
@@ -37,31 +69,43 @@ public:
         long long       volume, 
         long long       openInt, 
         int             resolution);
+    // Same as above without looking up the name, loaders build bars of the
+    // instrument of their feed with it.
+    Bar(InstrumentId    instrumentId,
+        const DateTime& datetime, 
+        double          open,
+        double          high, 
+        double          low, 
+        double          close, 
+        long long       volume, 
+        long long       openInt, 
+        int             resolution);
 
     const char*     getInstrument() const;     // Returns the instrument name.
-    int             getSecurityType() const;
-    void            setSecurityType(int type);
-    const DateTime& getDateTime() const;       // Returns the datetime for this bar.
-    double          getOpen() const;           // Returns the opening price.
-    void            setOpen(double price);
-    double          getHigh() const;           // Returns the highest price.
-    void            setHigh(double price);
-    double          getLow() const;            // Returns the lowest price.
-    void            setLow(double price);
-    double          getClose() const;          // Returns the closing price.
-    void            setClose(double price);
-    long long       getVolume() const;         // Returns the volume.
-    void            setVolume(long long volume);
-    long long       getOpenInt() const;        // Returns the open interest.
-    void            setOpenInt(long long amount);
-    double          getAmount() const;         // Returns the turnover.
-    void            setAmount(double amount);
-    double          getLastPrice() const;
-    void            setLastPrice(double price);
-    double          getBidPrice1() const;
-    long long       getBidVolume1() const;
-    double          getAskPrice1() const;
-    long long       getAskVolume1() const;
+    InstrumentId    getInstrumentId() const    { return m_bar.instrumentId; }
+    int             getSecurityType() const    { return m_bar.securityType; }
+    void            setSecurityType(int type)  { m_bar.securityType = (short)type; }
+    const DateTime& getDateTime() const        { return m_bar.datetime; }  // Returns the datetime for this bar.
+    double          getOpen() const            { return m_bar.open; }      // Returns the opening price.
+    void            setOpen(double price)      { m_bar.open = price; }
+    double          getHigh() const            { return m_bar.high; }      // Returns the highest price.
+    void            setHigh(double price)      { m_bar.high = price; }
+    double          getLow() const             { return m_bar.low; }       // Returns the lowest price.
+    void            setLow(double price)       { m_bar.low = price; }
+    double          getClose() const           { return m_bar.close; }     // Returns the closing price.
+    void            setClose(double price)     { m_bar.close = price; }
+    long long       getVolume() const          { return m_bar.volume; }    // Returns the volume.
+    void            setVolume(long long volume) { m_bar.volume = volume; }
+    long long       getOpenInt() const         { return m_bar.openInt; }   // Returns the open interest.
+    void            setOpenInt(long long amount) { m_bar.openInt = amount; }
+    double          getAmount() const          { return m_bar.amount; }    // Returns the turnover.
+    void            setAmount(double amount)   { m_bar.amount = amount; }
+    double          getLastPrice() const       { return m_tick.lastPrice; }
+    void            setLastPrice(double price) { m_tick.lastPrice = price; }
+    double          getBidPrice1() const       { return m_tick.bidPrice1; }
+    long long       getBidVolume1() const      { return m_tick.bidVolume1; }
+    double          getAskPrice1() const       { return m_tick.askPrice1; }
+    long long       getAskVolume1() const      { return m_tick.askVolume1; }
 
     void      setTickField(double lastPrice, 
                            double bidPrice1, 
@@ -69,33 +113,19 @@ public:
                            double askPrice1, 
                            long long askVolume1);
 
-    int       getResolution() const;           // Returns the bar's period.
-    void      setResolution(int resolution);
-    int       getInterval() const;
-    void      setInterval(int interval);
+    int       getResolution() const            { return m_bar.resolution; }  // Returns the bar's period.
+    void      setResolution(int resolution)    { m_bar.resolution = resolution; }
+    int       getInterval() const              { return m_bar.interval; }
+    void      setInterval(int interval)        { m_bar.interval = interval; }
     double    getTypicalPrice() const;         // Returns the typical price.
-    bool      isValid() const;
+    bool      isValid() const                  { return m_bar.valid; }
 
-private:
-    int       m_securityType;
-    string    m_instrument;
-	DateTime  m_datetime;
-	double    m_open;
-	double    m_high;
-	double    m_low;
-	double    m_close;
-    long long m_volume;
-    long long m_openInt;
-    double    m_amount;
-	int       m_resolution;
-    int       m_interval;
+    const BarRecord&  getRecord() const        { return m_bar; }
+    const TickRecord& getTickRecord() const    { return m_tick; }
 
-    double    m_lastPrice;
-    double    m_bidPrice1;
-    long long m_bidVolume1;
-    double    m_askPrice1;
-    long long m_askVolume1;
-    bool      m_isValid;
+private:
+    BarRecord  m_bar;
+    TickRecord m_tick;
 };
 
 } // namespace xBacktest
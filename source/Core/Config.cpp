@@ -193,11 +193,21 @@ void DataFeedConfig::registerStream(const string& symbol, int resolution, int in
     return m_implementor->registerStream(symbol, resolution, interval, filename, fromat);
 }
 
+void DataFeedConfig::registerStream(const string& symbol, int resolution, int interval, const string& filename, int format, const DataRange& range)
+{
+    return m_implementor->registerStream(symbol, resolution, interval, filename, format, range);
+}
+
 void DataFeedConfig::registerStream(DataStreamConfig& stream)
 {
     return m_implementor->registerStream(stream);
 }
 
+void DataFeedConfig::registerComposedStream(const string& name, const string& source, const TradingSession& session, int resolution, int interval)
+{
+    return m_implementor->registerComposedStream(name, source, session, resolution, interval);
+}
+
 void DataFeedConfig::setMultiplier(const string& symbol, double multiplier)
 {
     return m_implementor->setMultiplier(symbol, multiplier);
@@ -208,6 +218,11 @@ void DataFeedConfig::setTickSize(const string& symbol, double size)
     return m_implementor->setTickSize(symbol, size);
 }
 
+void DataFeedConfig::setFixedPrice(const string& symbol, bool fixed)
+{
+    return m_implementor->setFixedPrice(symbol, fixed);
+}
+
 void DataFeedConfig::setMarginRatio(const string& symbol, double ratio)
 {
     return m_implementor->setMarginRatio(symbol, ratio);
@@ -248,6 +263,11 @@ vector<DataStreamConfig>& DataFeedConfig::getStreams()
     return m_implementor->getStreams();
 }
 
+vector<ComposedStreamConfig>& DataFeedConfig::getComposedStreams()
+{
+    return m_implementor->getComposedStreams();
+}
+
 DataStorage* DataFeedConfig::getBarStorage()
 {
     return m_implementor->getBarStorage();
@@ -337,6 +357,66 @@ int EnvironmentConfig::getOptimizationMode() const
     return m_implementor->getOptimizationMode();
 }
 
+void EnvironmentConfig::setCacheDirectory(const string& dir)
+{
+    return m_implementor->setCacheDirectory(dir);
+}
+
+const string& EnvironmentConfig::getCacheDirectory() const
+{
+    return m_implementor->getCacheDirectory();
+}
+
+void EnvironmentConfig::enableCache(bool enable)
+{
+    return m_implementor->enableCache(enable);
+}
+
+bool EnvironmentConfig::isCacheEnabled() const
+{
+    return m_implementor->isCacheEnabled();
+}
+
+void EnvironmentConfig::setStreamingWindow(int items)
+{
+    return m_implementor->setStreamingWindow(items);
+}
+
+int EnvironmentConfig::getStreamingWindow() const
+{
+    return m_implementor->getStreamingWindow();
+}
+
+void EnvironmentConfig::enableTimeline(bool enable)
+{
+    return m_implementor->enableTimeline(enable);
+}
+
+bool EnvironmentConfig::isTimelineEnabled() const
+{
+    return m_implementor->isTimelineEnabled();
+}
+
+void EnvironmentConfig::setShardNum(int num)
+{
+    return m_implementor->setShardNum(num);
+}
+
+int EnvironmentConfig::getShardNum() const
+{
+    return m_implementor->getShardNum();
+}
+
+void EnvironmentConfig::enablePipeline(bool enable)
+{
+    return m_implementor->enablePipeline(enable);
+}
+
+bool EnvironmentConfig::isPipelineEnabled() const
+{
+    return m_implementor->isPipelineEnabled();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 ReportConfig::ReportConfig()
 {
@@ -79,17 +79,33 @@ typedef struct {
     string   uri;
     int      format;
     Contract contract;
+    string   continuous;    // continuous contract built out of `uri`, if not empty.
+    int      adjustment;    // ContinuousAdjustment of the continuous contract.
+    DataRange range;        // part of `uri` to load, all of it by default.
 } DataStreamConfig;
 
+// Stream composed of a loaded stream at load time.
+typedef struct {
+    string         name;
+    string         source;
+    TradingSession session;
+    int            resolution;
+    int            interval;
+} ComposedStreamConfig;
+
 class DllExport DataFeedConfig
 {
     friend class SimulatorImpl;
 
 public:
     void registerStream(const string& symbol, int resolution, int interval, const string& filename, int format);
+    // Load only the rows of `filename` within `range`.
+    void registerStream(const string& symbol, int resolution, int interval, const string& filename, int format, const DataRange& range);
     void registerStream(DataStreamConfig& stream);
+    void registerComposedStream(const string& name, const string& source, const TradingSession& session, int resolution, int interval);
     void setMultiplier(const string& symbol, double multiplier);
     void setTickSize(const string& symbol, double size);
+    void setFixedPrice(const string& symbol, bool fixed);
     void setMarginRatio(const string& symbol, double ratio);
     void setCommissionType(const string& symbol, int type);
     void setCommission(const string& symbol, double comm);
@@ -98,6 +114,7 @@ public:
     const Contract getContract(const string& symbol) const;
     void setBarStorage(DataStorage* storage);
     vector<DataStreamConfig>& getStreams();
+    vector<ComposedStreamConfig>& getComposedStreams();
     DataStorage* getBarStorage();
 
 private:
@@ -141,6 +158,25 @@ public:
     int  getMachineCPUNum() const;
     void setOptimizationMode(int mode);
     int  getOptimizationMode() const;
+    // Directory of the data cache, empty means the default location.
+    void setCacheDirectory(const string& dir);
+    const string& getCacheDirectory() const;
+    void enableCache(bool enable);
+    bool isCacheEnabled() const;
+    // Items per streaming window of binary files, 0 maps files as a whole.
+    // Timestamps (8 bytes per item) are kept in memory for the whole file.
+    void setStreamingWindow(int items);
+    int  getStreamingWindow() const;
+    // Replay every data stream as one merged timeline.
+    void enableTimeline(bool enable);
+    bool isTimelineEnabled() const;
+    // Threads running the runtimes of a backtest, partitioned by instrument,
+    // 0 or less (the default) doesn't shard, see Executor::setShardNum().
+    void setShardNum(int num);
+    int  getShardNum() const;
+    // Decode and merge bars on a thread of their own, ahead of strategies.
+    void enablePipeline(bool enable);
+    bool isPipelineEnabled() const;
 
 private:
     EnvironmentConfig();
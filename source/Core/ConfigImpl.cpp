@@ -262,6 +262,11 @@ bool StrategyConfigImpl::check() const
 
 ////////////////////////////////////////////////////////////////////////////////
 void DataFeedConfigImpl::registerStream(const string& symbol, int resolution, int interval, const string& filename, int format)
+{
+    registerStream(symbol, resolution, interval, filename, format, DataRange());
+}
+
+void DataFeedConfigImpl::registerStream(const string& symbol, int resolution, int interval, const string& filename, int format, const DataRange& range)
 {
     for (size_t i = 0; i < m_items.size(); i++) {
         if (m_items[i].name == symbol) {
@@ -277,6 +282,8 @@ void DataFeedConfigImpl::registerStream(const string& symbol, int resolution, in
     stream.format     = format;
     stream.resolution = resolution;
     stream.interval   = interval;
+    stream.adjustment = NoAdjustment;
+    stream.range      = range;
 
     strncpy(stream.contract.productId, symbol.c_str(), sizeof(stream.contract.productId) - 1);
     stream.contract.commType   = 0;
@@ -292,6 +299,26 @@ void DataFeedConfigImpl::registerStream(DataStreamConfig& stream)
     m_items.push_back(stream);
 }
 
+void DataFeedConfigImpl::registerComposedStream(const string& name, const string& source, const TradingSession& session, int resolution, int interval)
+{
+    for (size_t i = 0; i < m_composedItems.size(); i++) {
+        if (m_composedItems[i].name == name) {
+            char str[128] = { 0 };
+            sprintf(str, "Data stream '%s' already existed.", name.c_str());
+            ASSERT(false, str);
+        }
+    }
+
+    ComposedStreamConfig stream;
+    stream.name       = name;
+    stream.source     = source;
+    stream.session    = session;
+    stream.resolution = resolution;
+    stream.interval   = interval;
+
+    m_composedItems.push_back(stream);
+}
+
 void DataFeedConfigImpl::setMultiplier(const string& symbol, double multiplier)
 {
     for (size_t i = 0; i < m_items.size(); i++) {
@@ -312,6 +339,16 @@ void DataFeedConfigImpl::setTickSize(const string& symbol, double size)
     }
 }
 
+void DataFeedConfigImpl::setFixedPrice(const string& symbol, bool fixed)
+{
+    for (size_t i = 0; i < m_items.size(); i++) {
+        if (m_items[i].name == symbol) {
+            m_items[i].contract.fixedPrice = fixed;
+            break;
+        }
+    }
+}
+
 void DataFeedConfigImpl::setMarginRatio(const string& symbol, double ratio)
 {
     for (size_t i = 0; i < m_items.size(); i++) {
@@ -383,6 +420,11 @@ vector<DataStreamConfig>& DataFeedConfigImpl::getStreams()
     return m_items;
 }
 
+vector<ComposedStreamConfig>& DataFeedConfigImpl::getComposedStreams()
+{
+    return m_composedItems;
+}
+
 DataStorage* DataFeedConfigImpl::getBarStorage()
 {
     return m_storage;
@@ -452,6 +494,12 @@ EnvironmentConfigImpl::EnvironmentConfigImpl()
 {
     m_coreNum = Utils::getMachineCPUNum();
     m_optimizationMode = Optimizer::Exhaustive;
+    m_cacheDir.clear();
+    m_cacheEnabled = true;
+    m_streamingWindow = 0;
+    m_timelineEnabled = false;
+    m_shardNum = 0;
+    m_pipelineEnabled = false;
 }
 
 void EnvironmentConfigImpl::setMachineCPUNum(int num)
@@ -474,6 +522,66 @@ int EnvironmentConfigImpl::getOptimizationMode() const
     return m_optimizationMode;
 }
 
+void EnvironmentConfigImpl::setCacheDirectory(const string& dir)
+{
+    m_cacheDir = dir;
+}
+
+const string& EnvironmentConfigImpl::getCacheDirectory() const
+{
+    return m_cacheDir;
+}
+
+void EnvironmentConfigImpl::enableCache(bool enable)
+{
+    m_cacheEnabled = enable;
+}
+
+bool EnvironmentConfigImpl::isCacheEnabled() const
+{
+    return m_cacheEnabled;
+}
+
+void EnvironmentConfigImpl::setStreamingWindow(int items)
+{
+    m_streamingWindow = items;
+}
+
+int EnvironmentConfigImpl::getStreamingWindow() const
+{
+    return m_streamingWindow;
+}
+
+void EnvironmentConfigImpl::enableTimeline(bool enable)
+{
+    m_timelineEnabled = enable;
+}
+
+bool EnvironmentConfigImpl::isTimelineEnabled() const
+{
+    return m_timelineEnabled;
+}
+
+void EnvironmentConfigImpl::setShardNum(int num)
+{
+    m_shardNum = num;
+}
+
+int EnvironmentConfigImpl::getShardNum() const
+{
+    return m_shardNum;
+}
+
+void EnvironmentConfigImpl::enablePipeline(bool enable)
+{
+    m_pipelineEnabled = enable;
+}
+
+bool EnvironmentConfigImpl::isPipelineEnabled() const
+{
+    return m_pipelineEnabled;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 ReportConfigImpl::ReportConfigImpl()
 {
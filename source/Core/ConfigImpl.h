@@ -70,9 +70,12 @@ class DataFeedConfigImpl
 {
 public:
     void registerStream(const string& symbol, int resolution, int interval, const string& filename, int format);
+    void registerStream(const string& symbol, int resolution, int interval, const string& filename, int format, const DataRange& range);
     void registerStream(DataStreamConfig& stream);
+    void registerComposedStream(const string& name, const string& source, const TradingSession& session, int resolution, int interval);
     void setMultiplier(const string& symbol, double multiplier);
     void setTickSize(const string& symbol, double size);
+    void setFixedPrice(const string& symbol, bool fixed);
     void setMarginRatio(const string& symbol, double ratio);
     void setCommissionType(const string& symbol, int type);
     void setCommission(const string& symbol, double comm);
@@ -81,10 +84,12 @@ public:
     const Contract getContract(const string& symbol) const;
     void setBarStorage(DataStorage* storage);
     vector<DataStreamConfig>& getStreams();
+    vector<ComposedStreamConfig>& getComposedStreams();
     DataStorage* getBarStorage();
 
 private:
     vector<DataStreamConfig> m_items;
+    vector<ComposedStreamConfig> m_composedItems;
 
     DataStorage* m_storage;
 };
@@ -113,10 +118,28 @@ public:
     int  getMachineCPUNum() const;
     void setOptimizationMode(int mode);
     int  getOptimizationMode() const;
+    void setCacheDirectory(const string& dir);
+    const string& getCacheDirectory() const;
+    void enableCache(bool enable);
+    bool isCacheEnabled() const;
+    void setStreamingWindow(int items);
+    int  getStreamingWindow() const;
+    void enableTimeline(bool enable);
+    bool isTimelineEnabled() const;
+    void setShardNum(int num);
+    int  getShardNum() const;
+    void enablePipeline(bool enable);
+    bool isPipelineEnabled() const;
 
 private:
     int m_coreNum;
     int m_optimizationMode;
+    string m_cacheDir;
+    bool m_cacheEnabled;
+    int m_streamingWindow;
+    bool m_timelineEnabled;
+    int m_shardNum;
+    bool m_pipelineEnabled;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -10,6 +10,8 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <algorithm>
+#include <climits>
 #include "Export.h"
 #include "DateTime.h"
 
@@ -118,6 +120,7 @@ typedef struct _Contract {
     double slippage;
     int    openTime;
     int    closeTime;
+    bool   fixedPrice;  // Prices are processed as integer counts of tickSize.
     _Contract()
     {
         securityType    = SecurityType::Unknown;
@@ -132,6 +135,7 @@ typedef struct _Contract {
         slippage        = 0;
         openTime        = 91500;  // 09:15:00 by default
         closeTime       = 145900; // 14:59:00 by default
+        fixedPrice      = false;
     }
 } Contract;
 
@@ -164,7 +168,15 @@ enum {
     DATA_FILE_FORMAT_UNKNOWN,
     DATA_FILE_FORMAT_CSV,
     DATA_FILE_FORMAT_BIN,
-    DATA_FILE_FORMAT_TS
+    DATA_FILE_FORMAT_TS,
+    DATA_FILE_FORMAT_COL,
+    DATA_FILE_FORMAT_CMP
+};
+
+// Prices of continuous contracts.
+enum ContinuousAdjustment {
+    NoAdjustment,   // raw prices, gaps at rolls.
+    BackAdjusted,   // earlier contracts shifted by the following roll gaps.
 };
 
 enum DataRequestType {
@@ -174,7 +186,7 @@ enum DataRequestType {
 
 enum DataLoadMode {
     DataLoadSyncMode = 1,
-    DataLoadAsyncMode,  // Not supported yet.
+    DataLoadAsyncMode,  // Delivered before the next bar.
 };
 
 typedef struct _DataRequest {
@@ -199,6 +211,44 @@ typedef struct _DataRequest {
 
 } DataRequest;
 
+// Part of a data file to load. Bounds are inclusive, an invalid bound is
+// open and an empty instrument list takes every instrument of the file.
+typedef struct _DataRange {
+    DateTime       from;
+    DateTime       to;
+    vector<string> instruments;
+
+    _DataRange()
+    {
+        from.markInvalid();
+        to.markInvalid();
+    }
+
+    bool isAll() const
+    {
+        return !from.isValid() && !to.isValid() && instruments.empty();
+    }
+
+    bool hasInstrument(const string& instrument) const
+    {
+        return instruments.empty() ||
+               std::find(instruments.begin(), instruments.end(), instrument) != instruments.end();
+    }
+
+    int64 fromTicks() const { return from.isValid() ? from.ticks() : LLONG_MIN; }
+    int64 toTicks() const { return to.isValid() ? to.ticks() : LLONG_MAX; }
+
+    // Rows of ascending `times` within the bounds, returns the number of rows
+    // and the index of the first one in `begin`.
+    int slice(const int64* times, int length, int& begin) const
+    {
+        const int64* first = std::lower_bound(times, times + length, fromTicks());
+        const int64* last = std::upper_bound(first, times + length, toTicks());
+        begin = first - times;
+        return last - first;
+    }
+} DataRange;
+
 typedef struct {
     double    initialCapital;
     long long tradingPeriod;
@@ -1,9 +1,9 @@
 #include <cassert>
 #include <algorithm>
 #include <functional>
+#include <unordered_set>
 #include "Errors.h"
 #include "Dispatcher.h"
-#include "Event.h"
 
 namespace xBacktest
 {
@@ -11,9 +11,6 @@ namespace xBacktest
 volatile unsigned long Dispatcher::m_nextId = 0;
 
 Dispatcher::Dispatcher()
-	: m_startEvent(Event::EvtDispatcherStart)
-	, m_idleEvent(Event::EvtDispatcherIdle)
-    , m_timeElapsedEvent(Event::EvtDispatcherTimeElapsed)
 {
     m_id = ++m_nextId;
 
@@ -40,67 +37,96 @@ const DateTime& Dispatcher::getPrevDateTime() const
     return m_prevDateTime;
 }
 
-Event& Dispatcher::getStartEvent()
+Dispatcher::NotifyEvent& Dispatcher::getStartEvent()
 {
     return m_startEvent;
 }
 
-Event& Dispatcher::getIdleEvent()
+Dispatcher::NotifyEvent& Dispatcher::getIdleEvent()
 {
     return m_idleEvent;
 }
 
-Event& Dispatcher::getTimeElapsedEvent()
+Dispatcher::TimeElapsedEvent& Dispatcher::getTimeElapsedEvent()
 {
     return m_timeElapsedEvent;
 }
 
+Dispatcher::NotifyEvent& Dispatcher::getSliceEndEvent()
+{
+    return m_sliceEndEvent;
+}
+
 bool Dispatcher::dispatchSubject(Subject *subject)
 {
 	// Dispatch if the datetime is currEventDateTime of if its a realtime subject.
 	return subject->dispatch();
 }
 
+bool Dispatcher::laterThan(const QueueItem& a, const QueueItem& b)
+{
+    int cmp = a.datetime.compare(b.datetime);
+    if (cmp != 0) {
+        return cmp > 0;
+    }
+
+    return a.idx > b.idx;
+}
+
+void Dispatcher::scheduleSubject(int idx)
+{
+    Subject* subject = m_subjects[idx];
+    if (subject->eof()) {
+        return;
+    }
+
+    QueueItem item;
+    item.datetime = subject->peekDateTime();
+    item.idx      = idx;
+    if (!item.datetime.isValid()) {
+        m_pendingIdxs.push_back(idx);
+        return;
+    }
+
+    m_queue.push_back(item);
+    std::push_heap(m_queue.begin(), m_queue.end(), laterThan);
+}
+
+void Dispatcher::schedulePendingSubjects()
+{
+    if (m_pendingIdxs.empty()) {
+        return;
+    }
+
+    std::vector<int> pendingIdxs;
+    pendingIdxs.swap(m_pendingIdxs);
+    for (size_t i = 0; i < pendingIdxs.size(); i++) {
+        scheduleSubject(pendingIdxs[i]);
+    }
+}
+
 bool Dispatcher::dispatch()
 {
 	bool eventsDispatched = false;
-    long index = -1;
     size_t i = 0;
 
     m_eof = true;
 
-    DateTime smallestDateTime;
-    smallestDateTime.markInvalid();
-    // Scan for the lowest datetime.
-    for (i = 0; i < m_subjects.size(); i++) {
-        if (!m_subjects[i]->eof()) {
-            if (!smallestDateTime.isValid()) {
-                smallestDateTime = m_subjects[i]->peekDateTime();
-            }
+    schedulePendingSubjects();
 
-            DateTime dt = m_subjects[i]->peekDateTime();
-            if (dt.isValid() && smallestDateTime > dt) {
-                smallestDateTime = dt;
-            }
-        }
+    if (m_queue.empty()) {
+        return false;
     }
 
-    // Collect subjects with the same lowest datetime.
+    // Pop subjects with the same lowest datetime, the heap hands them out
+    // in the order of their index.
+    DateTime smallestDateTime = m_queue.front().datetime;
     size_t subjectCount = 0;
-    for (i = 0; i < m_subjects.size(); i++) {
-        if (m_subjects[i]->eof()) {
-            continue;
-        }
-
-        DateTime dt = m_subjects[i]->peekDateTime();
-        if (!dt.isValid()) {
-            continue;
-        }
-
-        if (dt == smallestDateTime) {
-            m_subjectIdxs[subjectCount] = i;
-            subjectCount++;
-        }
+    while (!m_queue.empty() && m_queue.front().datetime.compare(smallestDateTime) == 0) {
+        m_subjectIdxs[subjectCount] = m_queue.front().idx;
+        subjectCount++;
+        std::pop_heap(m_queue.begin(), m_queue.end(), laterThan);
+        m_queue.pop_back();
     }
 
     if (subjectCount > 0) {
@@ -115,9 +141,9 @@ bool Dispatcher::dispatch()
                             m_currDateTime.toString().c_str());
                 ASSERT(false, str);
             }
-            m_timeElapsedEvent.emit(m_currDateTime, &m_prevDateTime);
+            m_timeElapsedEvent.emit(m_prevDateTime, m_currDateTime);
         } else {
-            m_timeElapsedEvent.emit(m_currDateTime, &m_currDateTime);
+            m_timeElapsedEvent.emit(m_currDateTime, m_currDateTime);
         }
 
         m_prevDateTime = m_currDateTime;
@@ -130,6 +156,13 @@ bool Dispatcher::dispatch()
         if (dispatchSubject(m_subjects[idx])) {
             eventsDispatched = true;
         }
+
+        // Re-peek only the subjects which just fired.
+        scheduleSubject(idx);
+    }
+
+    if (subjectCount > 0) {
+        m_sliceEndEvent.emit();
     }
 
     return eventsDispatched;
@@ -147,7 +180,14 @@ void Dispatcher::run()
         m_subjects[i]->start();
     }
 
-    m_startEvent.emit(DateTime(), nullptr);
+    m_queue.clear();
+    m_queue.reserve(m_subjects.size());
+    m_pendingIdxs.clear();
+    for (size_t i = 0; i < m_subjects.size(); i++) {
+        scheduleSubject(i);
+    }
+
+    m_startEvent.emit();
 
     bool eventsDispatched = false;
 
@@ -156,7 +196,7 @@ void Dispatcher::run()
         if (m_eof) {
             m_stop = true;
         } else if (!eventsDispatched) {
-            m_idleEvent.emit(DateTime(), nullptr);
+            m_idleEvent.emit();
         }
     }
 
@@ -192,7 +232,19 @@ void Dispatcher::addSubject(Subject* subject)
     }
 
     m_subjects.push_back(subject);
-    sort(m_subjects.begin(), m_subjects.end(), lowerPriority);
+    stable_sort(m_subjects.begin(), m_subjects.end(), lowerPriority);
+}
+
+void Dispatcher::addSubjects(const std::vector<Subject*>& subjects)
+{
+    std::unordered_set<Subject*> added(m_subjects.begin(), m_subjects.end());
+    for (size_t i = 0; i < subjects.size(); i++) {
+        if (subjects[i] != nullptr && added.insert(subjects[i]).second) {
+            m_subjects.push_back(subjects[i]);
+        }
+    }
+
+    stable_sort(m_subjects.begin(), m_subjects.end(), lowerPriority);
 }
 
 } // namespace xBacktest
\ No newline at end of file
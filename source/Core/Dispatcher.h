@@ -2,7 +2,7 @@
 #define DISPATCHER_H
 
 #include <vector>
-#include "Event.h"
+#include "Signal.h"
 #include "Observer.h"
 
 namespace xBacktest
@@ -12,18 +12,29 @@ namespace xBacktest
 class Dispatcher 
 {
 public:
+    typedef Signal<> NotifyEvent;
+    // Handlers receive the previous and the current datetime, both are the
+    // current one in the first round.
+    typedef Signal<const DateTime&, const DateTime&> TimeElapsedEvent;
+
     Dispatcher();
     unsigned long getId() const;
     // Returns the current event datetime. It may be None for events from real-time subjects.
     const DateTime& getCurrDateTime() const;
     const DateTime& getPrevDateTime() const;
-    Event& getStartEvent();
-    Event& getIdleEvent();
-    Event& getTimeElapsedEvent();
+    NotifyEvent& getStartEvent();
+    NotifyEvent& getIdleEvent();
+    TimeElapsedEvent& getTimeElapsedEvent();
+    // Emitted after all subjects with the current datetime have dispatched.
+    // A subject holding several events of the same datetime dispatches them
+    // in consecutive rounds, so they end up in consecutive slices.
+    NotifyEvent& getSliceEndEvent();
     
 	void run();
 	void stop();
     void addSubject(Subject* subject);
+    // Same as addSubject() for each of them, sorting once.
+    void addSubjects(const std::vector<Subject*>& subjects);
 
 private:
     // True if all subjects hit eof
@@ -33,8 +44,26 @@ private:
     //  Return True if events were dispatched.
     bool dispatchSubject(Subject *subject);
 
+    // Peek the subject's next datetime and put it back into the queue,
+    // subjects hit eof will be dropped, subjects without a valid datetime
+    // yet are kept pending.
+    void scheduleSubject(int idx);
+    // Queue pending subjects which got a valid datetime.
+    void schedulePendingSubjects();
+
     static bool lowerPriority(const Subject* s1, const Subject* s2);
 
+private:
+    // Subjects are kept in a min-heap keyed on the cached datetime of their
+    // next event, so each round only touches subjects that fire.
+    typedef struct {
+        DateTime datetime;
+        int      idx;       // index in m_subjects, keeps dispatching order stable.
+    } QueueItem;
+
+    // Heap comparator, the item with the earliest datetime goes to the top.
+    static bool laterThan(const QueueItem& a, const QueueItem& b);
+
 private:
     static volatile unsigned long m_nextId;
     
@@ -42,11 +71,16 @@ private:
 
     std::vector<Subject*> m_subjects;   
     std::vector<int> m_subjectIdxs;
+    std::vector<QueueItem> m_queue;
+    // Subjects without a valid datetime yet, e.g. real-time ones with no
+    // event so far, re-checked each round.
+    std::vector<int> m_pendingIdxs;
 
     bool m_stop;
-    Event m_startEvent;
-    Event m_idleEvent;
-    Event m_timeElapsedEvent;
+    NotifyEvent m_startEvent;
+    NotifyEvent m_idleEvent;
+    TimeElapsedEvent m_timeElapsedEvent;
+    NotifyEvent m_sliceEndEvent;
     DateTime m_currDateTime;
     DateTime m_prevDateTime;
     bool m_eof;
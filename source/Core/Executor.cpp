@@ -16,6 +16,9 @@
 namespace xBacktest
 {
 
+// Dispatching rounds the producer of a pipeline may run ahead.
+static const int PIPELINE_SLICE_NUM = 256;
+
 ////////////////////////////////////////////////////////////////////////////////
 Process::Process(Executor* executor,  const StrategyConfig& config)
     : m_executor(executor)
@@ -45,6 +48,22 @@ const string& Process::getName() const
 void Process::registerDataStreamId(int id)
 {
     m_dataStreamIds.insert(id);
+
+    if (id >= (int)m_dataStreamRoutes.size()) {
+        m_dataStreamRoutes.resize(id + 1, 0);
+    }
+    m_dataStreamRoutes[id] = 1;
+}
+
+bool Process::isRegisteredDataStream(int dataStreamId) const
+{
+    if (m_subscribeAll || m_dataStreamIds.empty()) {
+        return true;
+    }
+
+    return dataStreamId >= 0 &&
+           dataStreamId < (int)m_dataStreamRoutes.size() &&
+           m_dataStreamRoutes[dataStreamId] != 0;
 }
 
 const unordered_set<int>& Process::getDataStreamIds() const
@@ -81,66 +100,141 @@ void Process::registerContract(const Contract& contract)
 
 void Process::processNewBar(int dataStreamId, int feedId, const Bar& bar)
 {
-    if (!m_subscribeAll && 
-        (m_dataStreamIds.size() > 0 && 
-         m_dataStreamIds.find(dataStreamId) == m_dataStreamIds.end())) {
+    if (!isRegisteredDataStream(dataStreamId)) {
         return;
     }
 
-    size_t i;
-    for (i = 0; i < m_runtimeList.size(); i++) {
-        Runtime* runtime = m_runtimeList[i];
-        assert(runtime != nullptr);
-        if (runtime->isSubscribeAll() || 
-            !_stricmp(runtime->getMainInstrument(), bar.getInstrument())) {
-            runtime->onBarEvent(bar);
-            return;
+    routeBar(bar)->onBarEvent(bar);
+}
+
+Runtime* Process::routeBar(const Bar& bar)
+{
+    Runtime* runtime = nullptr;
+    if (m_subscribeAll) {
+        // One runtime takes all instruments.
+        if (m_runtimeList.size() > 0) {
+            runtime = m_runtimeList.front();
         }
+    } else {
+        auto itor = m_runtimeRoutes.find(bar.getInstrumentId());
+        if (itor != m_runtimeRoutes.end()) {
+            runtime = itor->second;
+        }
+    }
+
+    if (runtime == nullptr) {
+        runtime = createRuntime(bar);
     }
 
-    // Create a new runtime for new instrument trading.
-    if (i == m_runtimeList.size()) {
-        Runtime* runtime = new Runtime(this);
-        runtime->setId(getNextRuntimeId());
-        runtime->setStrategyObject(m_config.getCreator()());
-        runtime->registerContracts(m_contracts);
+    return runtime;
+}
+
+// Create a new runtime for new instrument trading.
+Runtime* Process::createRuntime(const Bar& bar)
+{
+    Runtime* runtime = new Runtime(this);
+    runtime->setId(getNextRuntimeId());
+    runtime->setStrategyObject(m_config.getCreator()());
+    runtime->registerContracts(m_contracts);
 
-        if (m_subscribeAll) {
-            runtime->subscribeAll();
+    if (m_subscribeAll) {
+        runtime->subscribeAll();
+    } else {
+        runtime->setMainInstrument(bar.getInstrument());
+        auto& instruments = m_config.getSubscribedInstruments();
+        if (instruments.size() > 0) {
+            for (auto& item : instruments) {
+                runtime->registerInstrument(item.instrument.c_str());
+            }
         } else {
-            runtime->setMainInstrument(bar.getInstrument());
-            auto& instruments = m_config.getSubscribedInstruments();
-            if (instruments.size() > 0) {
-                for (auto& item : instruments) {
-                    runtime->registerInstrument(item.instrument.c_str());
-                }
-            } else {
-                // User don't assign the subscribed instrument.
-                runtime->registerInstrument(bar.getInstrument());
+            // User don't assign the subscribed instrument.
+            runtime->registerInstrument(bar.getInstrument());
+        }
+    }
+
+    // Set permissible trading period.
+    if (!m_subscribeAll) {
+        vector<SessionItem>& table = m_executor->getSessionTable();
+        for (size_t i = 0; i < table.size(); i++) {
+            if (table[i].instrument == runtime->getMainInstrument()) {
+                runtime->addActiveDateTime(table[i].begin, table[i].end);
             }
         }
+    } else {
+        DateTime begin;
+        DateTime end;
+        m_executor->getSessionTimeRange(begin, end);
+        runtime->addActiveDateTime(begin, end);
+    }
 
-        // Set permissible trading period.
-        if (!m_subscribeAll) {
-            vector<SessionItem>& table = m_executor->getSessionTable();
-            for (size_t i = 0; i < table.size(); i++) {
-                if (table[i].instrument == runtime->getMainInstrument()) {
-                    runtime->addActiveDateTime(table[i].begin, table[i].end);
-                }
+    m_runtimeList.push_back(runtime);
+    if (!m_subscribeAll) {
+        m_runtimeRoutes[runtime->getMainInstrumentId()] = runtime;
+    }
+    
+    runtime->onCreate();
+    runtime->setParameters(m_config.getParameters());
+    runtime->onStart();
+
+    return runtime;
+}
+
+const Bar* const* Process::filterSlice(const BarSlice& slice, int& num)
+{
+    const Bar* const* bars = slice.bars.data();
+    num = (int)slice.bars.size();
+
+    if (!m_subscribeAll && m_dataStreamIds.size() > 0) {
+        m_sliceBars.clear();
+        for (int i = 0; i < num; i++) {
+            if (isRegisteredDataStream(slice.dataStreamIds[i])) {
+                m_sliceBars.push_back(slice.bars[i]);
             }
-        } else {
-            DateTime begin;
-            DateTime end;
-            m_executor->getSessionTimeRange(begin, end);
-            runtime->addActiveDateTime(begin, end);
         }
+        bars = m_sliceBars.data();
+        num = (int)m_sliceBars.size();
+    }
 
-        m_runtimeList.push_back(runtime);
-        
-        runtime->onCreate();
-        runtime->setParameters(m_config.getParameters());
-        runtime->onStart();
-        runtime->onBarEvent(bar);
+    return bars;
+}
+
+void Process::processNewSlice(const BarSlice& slice)
+{
+    int num = 0;
+    const Bar* const* bars = filterSlice(slice, num);
+    if (num == 0) {
+        return;
+    }
+
+    for (int i = 0; i < num; i++) {
+        routeBar(*bars[i])->onBarEvent(*bars[i]);
+    }
+
+    for (size_t i = 0; i < m_runtimeList.size(); i++) {
+        m_runtimeList[i]->onSliceEvent(bars, num);
+    }
+}
+
+void Process::prepareSlice(const BarSlice& slice, vector<ShardTask>& tasks)
+{
+    int num = 0;
+    const Bar* const* bars = filterSlice(slice, num);
+    if (num == 0) {
+        return;
+    }
+
+    // Runtimes are created here, on the dispatching thread, so their ids
+    // and order don't depend on the workers.
+    for (int i = 0; i < num; i++) {
+        routeBar(*bars[i])->queueBar(*bars[i]);
+    }
+
+    for (size_t i = 0; i < m_runtimeList.size(); i++) {
+        ShardTask task;
+        task.runtime   = m_runtimeList[i];
+        task.sliceBars = bars;
+        task.num       = num;
+        tasks.push_back(task);
     }
 }
 
@@ -167,18 +261,15 @@ void Process::processTimeElapsed(const DateTime& prevDateTime, const DateTime& n
     }
 }
 
-void Process::processHistoricalData(int dataStreamId, const Bar& bar)
+void Process::processHistoricalData(int dataStreamId, const Bar& bar, bool isCompleted)
 {
     if (m_dataStreamIds.find(dataStreamId) == m_dataStreamIds.end()) {
         return;
     }
 
-    for (size_t i = 0; i < m_runtimeList.size(); i++) {
-        Runtime* rt = m_runtimeList[i];
-        assert(rt != nullptr);
-        if (!_stricmp(rt->getMainInstrument(), bar.getInstrument())) {
-            rt->onHistoricalData(bar, false);
-        }
+    auto itor = m_runtimeRoutes.find(bar.getInstrumentId());
+    if (itor != m_runtimeRoutes.end()) {
+        itor->second->onHistoricalData(bar, isCompleted);
     }
 }
 
@@ -229,13 +320,12 @@ void Process::destroy()
 Executor::Executor()
 {
     m_dispatcher = new Dispatcher();
-    m_dispatcher->getStartEvent().subscribe(this);
-    m_dispatcher->getIdleEvent().subscribe(this);
-    m_dispatcher->getTimeElapsedEvent().subscribe(this);
+    m_dispatcher->getTimeElapsedEvent().subscribe<Executor, &Executor::onTimeElapsedEvent>(this);
+    m_dispatcher->getSliceEndEvent().subscribe<Executor, &Executor::onSliceEndEvent>(this);
 
     m_backtestBroker = new BacktestingBroker();
     m_backtestBroker->init();
-    m_backtestBroker->getOrderUpdatedEvent().subscribe(this);
+    m_backtestBroker->getOrderUpdatedEvent().subscribe<Executor, &Executor::onNewOrderEvent>(this);
 
     m_processList.clear();
 
@@ -247,6 +337,13 @@ Executor::Executor()
     m_state        = Idle;
 
     m_historicalDataReqId = 0;
+    m_loaderPool          = nullptr;
+    m_shardNum            = 0;
+    m_shardPool           = nullptr;
+    m_pendingShardNum     = 0;
+    m_dispatchSlice       = &m_slice;
+    m_pipelineEnabled     = false;
+    m_pipeline            = nullptr;
     m_nextOrderId         = 0;
     m_nextRuntimeId       = 0;
 }
@@ -256,6 +353,14 @@ Executor::~Executor()
     // wait for thread completed.
     wait();
 
+    // Finish pending historical data requests before releasing feeds.
+    delete m_loaderPool;
+    m_loaderPool = nullptr;
+    m_asyncRequests.clear();
+
+    delete m_shardPool;
+    m_shardPool = nullptr;
+
     delete m_dispatcher;
     m_dispatcher = nullptr;
 
@@ -267,6 +372,11 @@ Executor::~Executor()
     }
     m_processList.clear();
 
+    for (auto& feed : m_mergedBarFeeds) {
+        delete feed;
+    }
+    m_mergedBarFeeds.clear();
+
     for (auto& feed : m_clonedBarFeeds) {
         delete feed;
     }
@@ -322,6 +432,28 @@ void Executor::setBrokerConfig(const BrokerConfig& config)
     m_backtestBroker->setCash(m_cash);
 }
 
+void Executor::setShardNum(int num)
+{
+    assert(m_state == Idle);
+    m_shardNum = num;
+}
+
+int Executor::getShardNum() const
+{
+    return m_shardNum;
+}
+
+bool Executor::isSharded() const
+{
+    return m_shardNum > 0;
+}
+
+void Executor::enablePipeline(bool enable)
+{
+    assert(m_state == Idle);
+    m_pipelineEnabled = enable;
+}
+
 double Executor::getAvailableCash() const
 {
     return m_backtestBroker->getAvailableCash();
@@ -367,6 +499,11 @@ void Executor::registerDataStorage(DataStorage* storage)
         for (auto& feed : feeds) {
             m_clonedBarFeeds.push_back(feed);
         }
+
+        if (stream->getTimeline() != nullptr) {
+            MergedBarFeed* mergedFeed = new MergedBarFeed(stream->getTimeline(), feeds);
+            m_mergedBarFeeds.push_back(mergedFeed);
+        }
     }
 
     registerBarFeeds(m_clonedBarFeeds);
@@ -420,6 +557,11 @@ bool Executor::createSessionTable()
                 long long secs = ticks / (1000);
                 secs -= feed->getInterval();
                 item.end = DateTime(secs * 1000);
+            } else if (feed->getResolution() == Bar::HOUR) {
+                long long ticks = item.end.ticks();
+                long long hours = ticks / (60 * 60 * 1000);
+                hours -= feed->getInterval();
+                item.end = DateTime(hours * 60 * 60 * 1000);
             } else if (feed->getResolution() == Bar::DAY) {
                 item.end = item.end.yesterday();
                 
@@ -450,6 +592,17 @@ bool Executor::createSessionTable()
 
 void Executor::registerBarFeeds(vector<BarFeed*>& feeds)
 {
+    // Feeds replayed by merged subjects aren't dispatched on their own,
+    // the merged subject takes the place of the first one.
+    unordered_map<BarFeed*, MergedBarFeed*> mergedFeeds;
+    for (auto& mergedFeed : m_mergedBarFeeds) {
+        for (auto& feed : mergedFeed->getBarFeeds()) {
+            mergedFeeds[feed] = mergedFeed;
+        }
+    }
+
+    vector<Subject*> subjects;
+    unordered_set<MergedBarFeed*> addedFeeds;
     for (size_t i = 0; i < feeds.size(); i++) {
         BarFeed* feed = feeds[i];
         if (feed != nullptr) {
@@ -458,10 +611,21 @@ void Executor::registerBarFeeds(vector<BarFeed*>& feeds)
 
             m_backtestBroker->registerContract(feed->getContract());
 
-            feed->getNewBarEvent().subscribe(this);
-            m_dispatcher->addSubject(feed);
+            feed->getNewBarEvent().subscribe<Executor, &Executor::onNewBarEvent>(this);
+            if (feed->getId() >= (int)m_barFeedRoutes.size()) {
+                m_barFeedRoutes.resize(feed->getId() + 1, nullptr);
+            }
+            m_barFeedRoutes[feed->getId()] = feed;
+            auto itor = mergedFeeds.find(feed);
+            if (itor == mergedFeeds.end()) {
+                subjects.push_back(feed);
+            } else if (addedFeeds.insert(itor->second).second) {
+                subjects.push_back(itor->second);
+            }
         }
     }
+
+    m_dispatcher->addSubjects(subjects);
 }
 
 void Executor::registerStrategy(const StrategyConfig& config)
@@ -504,8 +668,13 @@ void Executor::registerStrategy(const StrategyConfig& config)
         }
     } else {
         process->subscribeAll();
-        for (size_t i = 0; i < m_clonedBarFeeds.size(); i++) {
-            process->registerContract(m_clonedBarFeeds[i]->getContract());
+        // Feeds are cloned at init(), after strategies are registered.
+        vector<DataStream*> streams;
+        m_dataStorage->getAllDataStream(streams);
+        for (auto& stream : streams) {
+            for (auto& feed : stream->getBarFeeds()) {
+                process->registerContract(feed->getContract());
+            }
         }
     }
     
@@ -521,9 +690,8 @@ void Executor::dataCallBack(const DateTime& datetime, void* context)
 {
     assert(context != nullptr);
 
-    Executor* executor = (Executor*)context;
-
-    BarFeed::BarEventCtx* ctx = (BarFeed::BarEventCtx*)context;
+    BarFeed::HistoricalDataContext* ctx = (BarFeed::HistoricalDataContext*)context;
+    Executor* executor = (Executor*)ctx->object;
     int dataStreamId = ctx->dataStreamId;
     Bar& bar = ctx->bar;
 
@@ -538,7 +706,11 @@ int Executor::loadData(const DataRequest& request)
         return 0;
     }
 
-    BarFeed* feed = m_dataStorage->createSharedBarFeed(request.instrument, request.resolution);
+    if (request.mode == DataLoadAsyncMode) {
+        return loadDataAsync(request);
+    }
+
+    BarFeed* feed = m_dataStorage->createSharedBarFeed(request.instrument, request.resolution, request.interval);
     if (feed == nullptr) {
         return 0;
     }
@@ -549,6 +721,81 @@ int Executor::loadData(const DataRequest& request)
     return ret;
 }
 
+void Executor::asyncDataCallBack(const DateTime& datetime, void* context)
+{
+    assert(context != nullptr);
+
+    BarFeed::HistoricalDataContext* ctx = (BarFeed::HistoricalDataContext*)context;
+    AsyncDataRequest* req = (AsyncDataRequest*)ctx->object;
+    req->dataStreamId = ctx->dataStreamId;
+    req->bars.push_back(ctx->bar);
+}
+
+int Executor::loadDataAsync(const DataRequest& request)
+{
+    // Clone on the dispatcher thread, the storage isn't touched by workers.
+    BarFeed* feed = m_dataStorage->createSharedBarFeed(request.instrument, request.resolution, request.interval);
+    if (feed == nullptr) {
+        return 0;
+    }
+
+    if (m_loaderPool == nullptr) {
+        int threadNum = std::min<int>(std::thread::hardware_concurrency(), 4);
+        m_loaderPool = new Utils::ThreadPool(threadNum);
+    }
+
+    shared_ptr<AsyncDataRequest> req = make_shared<AsyncDataRequest>();
+    req->reqId        = ++m_historicalDataReqId;
+    req->dataStreamId = feed->getDataStreamId();
+    req->completed    = false;
+
+    {
+        Utils::Lock lock(m_asyncMonitor.GetMutex());
+        m_asyncRequests.push_back(req);
+    }
+
+    Utils::Condition* monitor = &m_asyncMonitor;
+    m_loaderPool->Submit([feed, req, request, monitor]() {
+        feed->loadData(req->reqId, request, req.get(), asyncDataCallBack);
+        delete feed;
+
+        Utils::Lock lock(monitor->GetMutex());
+        req->completed = true;
+        monitor->PulseAll();
+    });
+
+    return req->reqId;
+}
+
+void Executor::deliverHistoricalData()
+{
+    if (m_asyncRequests.empty()) {
+        return;
+    }
+
+    // Deliver in request order, waiting for the ones still loading, so the
+    // replay is the same no matter how the workers are scheduled.
+    vector<shared_ptr<AsyncDataRequest>> requests;
+    {
+        Utils::Lock lock(m_asyncMonitor.GetMutex());
+        for (auto& req : m_asyncRequests) {
+            while (!req->completed) {
+                m_asyncMonitor.Wait(lock);
+            }
+        }
+        requests.swap(m_asyncRequests);
+    }
+
+    for (auto& req : requests) {
+        size_t num = req->bars.size();
+        for (size_t i = 0; i < num; i++) {
+            for (size_t j = 0; j < m_processList.size(); j++) {
+                m_processList[j]->processHistoricalData(req->dataStreamId, req->bars[i], i == num - 1);
+            }
+        }
+    }
+}
+
 void Executor::writeDebugMsg(const char* msg)
 {
     if (msg) {
@@ -563,7 +810,14 @@ void Executor::threadProc(void *const context)
 
     Logger_Info() << "Start executor [ID:" << executor->m_dispatcher->getId() << "] [ThreadID:" << std::this_thread::get_id() << "]...";
 
-    executor->m_dispatcher->run();
+    if (executor->m_pipelineEnabled) {
+        executor->runPipeline();
+    } else {
+        executor->m_dispatcher->run();
+    }
+
+    // Requests issued on the last bar.
+    executor->deliverHistoricalData();
 
     for (size_t i = 0; i < executor->m_processList.size(); i++) {
         executor->m_processList[i]->stop();
@@ -1110,67 +1364,220 @@ SimplifiedMetrics Executor::getSimplifiedMetrics()
 
 void Executor::onNewBarEvent(int dataStreamId, int feedId, const Bar& bar)
 {
+    // Stored bars stay valid until the replay ends, feeds reusing their bar
+    // overwrite it on the next dispatch so a copy is kept until the slice
+    // ends. The copy is referenced at the end of the round, `copies` may
+    // still grow until then.
+    if (m_barFeedRoutes[feedId]->isCurrentBarStored()) {
+        m_dispatchSlice->bars.push_back(&bar);
+    } else {
+        m_dispatchSlice->bars.push_back(nullptr);
+        m_dispatchSlice->copies.push_back(bar);
+    }
+    m_dispatchSlice->dataStreamIds.push_back(dataStreamId);
+    m_dispatchSlice->barFeedIds.push_back(feedId);
+}
+
+void Executor::onSliceEndEvent()
+{
+    const Bar* const* bars = m_slice.bars.data();
+    int num = (int)m_slice.bars.size();
+    if (num == 0) {
+        return;
+    }
+
+    if (!m_slice.copies.empty()) {
+        size_t copyIndex = 0;
+        for (int i = 0; i < num; i++) {
+            if (m_slice.bars[i] == nullptr) {
+                m_slice.bars[i] = &m_slice.copies[copyIndex++];
+            }
+        }
+    }
+
     // It is VERY important that the broker get bars before the strategy.
-    // This is to avoid executing orders placed in the current tick.
-    m_backtestBroker->onBarEvent(bar);
+    // This is to avoid executing orders placed in the current tick, orders
+    // placed on any bar of the slice are executed from the next slice on.
+    m_backtestBroker->onSliceEvent(bars, num);
 
-    // Let strategies process this bar.
-    for (size_t i = 0; i < m_processList.size(); i++) {
-        m_processList[i]->processNewBar(dataStreamId, feedId, bar);
+    // Let strategies process this slice.
+    if (isSharded()) {
+        processShardedSlice();
+    } else {
+        for (size_t i = 0; i < m_processList.size(); i++) {
+            m_processList[i]->processNewSlice(m_slice);
+        }
     }
 
     // Process on-the-spot(intra-bar) orders, those order must be handled
-    // in current bar.
-    m_backtestBroker->onPostBarEvent(bar);
+    // in current slice.
+    m_backtestBroker->onPostSliceEvent(bars, num);
+
+    m_slice.bars.clear();
+    m_slice.dataStreamIds.clear();
+    m_slice.barFeedIds.clear();
+    m_slice.copies.clear();
 }
 
-void Executor::onNewOrderEvent(const OrderEvent& evt)
+void Executor::processShardedSlice()
 {
+    m_shardTasks.clear();
     for (size_t i = 0; i < m_processList.size(); i++) {
-        m_processList[i]->processNewOrder(evt);
+        m_processList[i]->prepareSlice(m_slice, m_shardTasks);
+    }
+
+    if (m_shardTasks.empty()) {
+        return;
+    }
+
+    // Task i takes ids `base + 1 + i + n * taskNum` of the slice, so ids are
+    // final before the barrier and don't depend on the threads.
+    unsigned long base = m_nextOrderId;
+    unsigned long taskNum = m_shardTasks.size();
+    for (size_t i = 0; i < m_shardTasks.size(); i++) {
+        m_shardTasks[i].runtime->reserveOrderIds(base + 1 + i, taskNum);
+    }
+
+    if (m_shardPool == nullptr && m_shardNum > 1) {
+        m_shardPool = new Utils::ThreadPool(m_shardNum - 1);
+    }
+
+    {
+        Utils::Lock lock(m_shardMonitor.GetMutex());
+        m_pendingShardNum = m_shardNum - 1;
+    }
+
+    for (int shard = 1; shard < m_shardNum; shard++) {
+        m_shardPool->Submit([this, shard]() {
+            runShard(shard);
+
+            Utils::Lock lock(m_shardMonitor.GetMutex());
+            if (--m_pendingShardNum == 0) {
+                m_shardMonitor.PulseAll();
+            }
+        });
+    }
+
+    runShard(0);
+
+    // Barrier: every runtime is done with the slice.
+    {
+        Utils::Lock lock(m_shardMonitor.GetMutex());
+        while (m_pendingShardNum > 0) {
+            m_shardMonitor.Wait(lock);
+        }
+    }
+
+    unsigned long orderNum = 0;
+    for (size_t i = 0; i < m_shardTasks.size(); i++) {
+        orderNum = std::max(orderNum, m_shardTasks[i].runtime->getReservedOrderNum());
+    }
+    m_nextOrderId = base + orderNum * taskNum;
+
+    // Merge in task order, i.e. by process then by runtime creation, so the
+    // broker gets the same requests in the same order whatever the shards.
+    for (size_t i = 0; i < m_shardTasks.size(); i++) {
+        m_shardTasks[i].runtime->flushRequests();
     }
 }
 
-void Executor::onTimeElapsedEvent(const DateTime& prevDateTime, const DateTime& nextDateTime)
+void Executor::runShard(int shard)
 {
-    for (size_t i = 0; i < m_processList.size(); i++) {
-        m_processList[i]->processTimeElapsed(prevDateTime, nextDateTime);
+    for (size_t i = 0; i < m_shardTasks.size(); i++) {
+        const ShardTask& task = m_shardTasks[i];
+        if ((int)(task.runtime->getId() % m_shardNum) == shard) {
+            task.runtime->runQueuedBars(task.sliceBars, task.num);
+        }
     }
 }
 
-void Executor::onEvent(int type, const DateTime& datetime, const void *context)
+void Executor::runPipeline()
 {
-    switch (type) {
-    case Event::EvtDispatcherStart:
-        break;
+    // The dispatcher now runs on the producer thread, its rounds are built
+    // into items of the ring and replayed here.
+    Dispatcher::TimeElapsedEvent& timeElapsedEvent = m_dispatcher->getTimeElapsedEvent();
+    timeElapsedEvent.unsubscribe<Executor, &Executor::onTimeElapsedEvent>(this);
+    timeElapsedEvent.subscribe<Executor, &Executor::onProducerTimeElapsedEvent>(this);
+    Dispatcher::NotifyEvent& sliceEndEvent = m_dispatcher->getSliceEndEvent();
+    sliceEndEvent.unsubscribe<Executor, &Executor::onSliceEndEvent>(this);
+    sliceEndEvent.subscribe<Executor, &Executor::onProducerSliceEndEvent>(this);
 
-    case Event::EvtDispatcherIdle:
-        break;
+    m_pipeline = new Utils::SpscRing<PipelineItem>(PIPELINE_SLICE_NUM);
 
-    case Event::EvtDispatcherTimeElapsed: {
-        const DateTime& prevDateTime = *((DateTime*)context);
-        onTimeElapsedEvent(prevDateTime, datetime);
-        break;
-    }
+    Utils::Thread producer;
+    producer.Start(producerProc, this);
 
-    case Event::EvtNewBar: {
-        BarFeed::BarEventCtx* ctx = (BarFeed::BarEventCtx*)context;
-        int dataStreamId = ctx->dataStreamId;
-        int feedId = ctx->barFeedId;
-        Bar& bar = ctx->bar;
-        onNewBarEvent(dataStreamId, feedId, bar);
+    while (true) {
+        PipelineItem* item = m_pipeline->Peek();
+        if (item->last) {
+            m_pipeline->Release();
+            break;
+        }
+
+        onTimeElapsedEvent(item->prevDateTime, item->currDateTime);
 
-        break;
+        // Trade buffers with the item, so neither side reallocates and the
+        // slot can be refilled while the slice is processed.
+        m_slice.bars.swap(item->slice.bars);
+        m_slice.dataStreamIds.swap(item->slice.dataStreamIds);
+        m_slice.barFeedIds.swap(item->slice.barFeedIds);
+        m_slice.copies.swap(item->slice.copies);
+        m_pipeline->Release();
+
+        onSliceEndEvent();
     }
 
-    case Event::EvtOrderUpdate: {
-        OrderEvent& evt = *((OrderEvent *)context);
-        onNewOrderEvent(evt);
-        break;
+    producer.Join();
+
+    delete m_pipeline;
+    m_pipeline = nullptr;
+    m_dispatchSlice = &m_slice;
+}
+
+void Executor::producerProc(void *const context)
+{
+    Executor *executor = (Executor*)context;
+    assert(executor != nullptr);
+
+    executor->m_dispatcher->run();
+
+    PipelineItem* item = executor->m_pipeline->Acquire();
+    item->last = true;
+    executor->m_pipeline->Publish();
+}
+
+void Executor::onProducerTimeElapsedEvent(const DateTime& prevDateTime, const DateTime& nextDateTime)
+{
+    // A round starts, bars go into the next free item until it ends.
+    PipelineItem* item = m_pipeline->Acquire();
+    item->prevDateTime = prevDateTime;
+    item->currDateTime = nextDateTime;
+    item->last         = false;
+    item->slice.bars.clear();
+    item->slice.dataStreamIds.clear();
+    item->slice.barFeedIds.clear();
+    item->slice.copies.clear();
+    m_dispatchSlice = &item->slice;
+}
+
+void Executor::onProducerSliceEndEvent()
+{
+    m_pipeline->Publish();
+}
+
+void Executor::onNewOrderEvent(const OrderEvent& evt)
+{
+    for (size_t i = 0; i < m_processList.size(); i++) {
+        m_processList[i]->processNewOrder(evt);
     }
+}
+
+void Executor::onTimeElapsedEvent(const DateTime& prevDateTime, const DateTime& nextDateTime)
+{
+    deliverHistoricalData();
 
-    default:
-        break;
+    for (size_t i = 0; i < m_processList.size(); i++) {
+        m_processList[i]->processTimeElapsed(prevDateTime, nextDateTime);
     }
 }
 
@@ -7,7 +7,9 @@
 #include "Lock.h"
 #include "Semaphore.h"
 #include "Condition.h"
-#include "Event.h"
+#include "ThreadPool.h"
+#include "SpscRing.h"
+#include "Signal.h"
 #include "Dispatcher.h"
 #include "Order.h"
 #include "BarFeed.h"
@@ -27,6 +29,25 @@ namespace xBacktest
 
 class Executor;
 
+// Bars of one dispatching round, i.e. all bars with the same datetime, in
+// dispatching order. Stored bars are referenced in place, bars of feeds
+// reusing their bar are copied into `copies` and referenced once the round
+// ends, until then their entries in `bars` are null.
+typedef struct {
+    vector<const Bar*> bars;
+    vector<int> dataStreamIds;
+    vector<int> barFeedIds;
+    vector<Bar> copies;
+} BarSlice;
+
+// Work of one runtime in a sharded slice: its queued bars, then the bars of
+// the slice its process takes.
+typedef struct {
+    Runtime*          runtime;
+    const Bar* const* sliceBars;
+    int               num;
+} ShardTask;
+
 // One Strategy + One Parameter tuple = One Model.
 // One Model + One Main instrument data stream = One Process.
 class Process
@@ -42,9 +63,13 @@ public:
     void registerContract(const Contract& contract);
     const unordered_set<string>& getInstruments() const;
     void processNewBar(int dataStreamId, int feedId, const Bar& bar);
+    void processNewSlice(const BarSlice& slice);
+    // Sharded counterpart of processNewSlice(), queues the bars on their
+    // runtimes and appends a task per runtime.
+    void prepareSlice(const BarSlice& slice, vector<ShardTask>& tasks);
     void processNewOrder(const OrderEvent& evt);
     void processTimeElapsed(const DateTime& prevDateTime, const DateTime& nextDateTime);
-    void processHistoricalData(int dataStreamId, const Bar& bar);
+    void processHistoricalData(int dataStreamId, const Bar& bar, bool isCompleted = false);
     Executor* getExecutor();
     unsigned long getNextOrderId();
     unsigned long getNextRuntimeId();
@@ -53,6 +78,14 @@ public:
     void stop();
     void destroy();
 
+private:
+    bool isRegisteredDataStream(int dataStreamId) const;
+    // Bars of the slice from the registered data streams.
+    const Bar* const* filterSlice(const BarSlice& slice, int& num);
+    // The runtime trading the instrument of the bar, create one if none.
+    Runtime* routeBar(const Bar& bar);
+    Runtime* createRuntime(const Bar& bar);
+
 private:
     Executor* m_executor;
     bool      m_subscribeAll;
@@ -66,6 +99,15 @@ private:
     string m_name;
 
     vector<Runtime*> m_runtimeList;
+
+    // Routing tables so a bar reaches its runtime with indexed lookups:
+    // non-zero by data stream id if the stream is registered, and the
+    // runtime by main instrument id, filled as runtimes are created.
+    vector<char>           m_dataStreamRoutes;
+    InstrumentMap<Runtime*> m_runtimeRoutes;
+
+    // Bars of the current slice from the registered data streams.
+    vector<const Bar*> m_sliceBars;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -76,7 +118,7 @@ private:
 // 4. load historical data
 // 5. ...
 ////////////////////////////////////////////////////////////////////////////////
-class Executor : public IEventHandler
+class Executor
 {
 public:
     enum State {
@@ -99,6 +141,24 @@ public:
     void registerStrategy(const StrategyConfig& config);
     void setCash(double cash);
     void setBrokerConfig(const BrokerConfig& config);
+    // Run runtimes on `num` threads, each one taking the runtimes whose id
+    // modulo `num` is its index. A slice is run in parallel up to a barrier,
+    // then the broker requests of the runtimes are replayed in creation
+    // order. Order ids are reserved per runtime before a slice runs.
+    // Strategies therefore see the same callbacks, ids and state whatever
+    // `num` is, but not the same as without sharding: orders, immediate
+    // ones included, and cancellations reach the broker after the slice,
+    // so fills, positions and cash change after onSlice() rather than
+    // within buy() or cancelOrder(). 1 runs sharded on the dispatching
+    // thread, 0 or less (the default) doesn't shard. Strategy objects must
+    // not share mutable state.
+    void setShardNum(int num);
+    int  getShardNum() const;
+    bool isSharded() const;
+    // Run the dispatcher on a producer thread which decodes and merges bars
+    // into a ring of slices ahead of the executor thread, so feed decoding
+    // overlaps with the broker and strategies. Results are the same.
+    void enablePipeline(bool enable);
     void init();
     double getAvailableCash() const;
     double getEquity() const;
@@ -122,8 +182,6 @@ public:
 
     void wait();
 
-    void onEvent(int type, const DateTime& datetime, const void *context);
-
     // Orders in the same executor has a unique id.
     // Because executor has a unique broker.
     unsigned long getNextOrderId();
@@ -141,10 +199,20 @@ private:
     void saveTransactionRecords(const string& file);
     void saveDailyMetrics(const string& file);
     void onNewBarEvent(int dataStreamId, int feedId, const Bar& bar);
+    void onSliceEndEvent();
+    void processShardedSlice();
+    void runShard(int shard);
+    void runPipeline();
+    void onProducerTimeElapsedEvent(const DateTime& prevDateTime, const DateTime& nextDateTime);
+    void onProducerSliceEndEvent();
+    static void producerProc(void *const context);
     void onNewOrderEvent(const OrderEvent& evt);
     void onTimeElapsedEvent(const DateTime& prevDateTime, const DateTime& nextDateTime);
+    int  loadDataAsync(const DataRequest& request);
+    void deliverHistoricalData();
     static void threadProc(void *const context);
     static void dataCallBack(const DateTime& datetime, void* ctx);
+    static void asyncDataCallBack(const DateTime& datetime, void* ctx);
 
 private:
     unsigned long m_id;
@@ -160,11 +228,29 @@ private:
 
     // Reference to bar feeds which inside data storage.
     vector<BarFeed*> m_clonedBarFeeds;
+    // Registered bar feeds by id, to tell whether a new bar is stored.
+    vector<BarFeed*> m_barFeedRoutes;
+    // One subject per stream with a merged timeline, replacing its feeds
+    // in the dispatcher.
+    vector<MergedBarFeed*> m_mergedBarFeeds;
     DateTime m_earliestDateTime;
     DateTime m_latestDataTime;
 
     unsigned long m_historicalDataReqId;
 
+    // Historical data requests in asynchronous mode, loaded by the pool and
+    // delivered in request order at the beginning of the next dispatch round.
+    typedef struct {
+        int         reqId;
+        int         dataStreamId;
+        vector<Bar> bars;
+        bool        completed;
+    } AsyncDataRequest;
+
+    Utils::ThreadPool* m_loaderPool;
+    Utils::Condition   m_asyncMonitor;
+    vector<shared_ptr<AsyncDataRequest>> m_asyncRequests;
+
     // roll main instrument of futures (roll trigger)
     vector<SessionItem> m_sessionTable;
 
@@ -183,6 +269,29 @@ private:
     BacktestingBroker* m_backtestBroker;
     // Dedicated to dispatch bars.
     Dispatcher*        m_dispatcher;
+    // Bars collected in the current dispatching round.
+    BarSlice           m_slice;
+    // Where new bars are collected, `m_slice` unless pipelined.
+    BarSlice*          m_dispatchSlice;
+
+    // A dispatching round built by the producer of the pipeline.
+    typedef struct {
+        DateTime prevDateTime;
+        DateTime currDateTime;
+        BarSlice slice;
+        bool     last;      // Marks the end of the replay, holds no round.
+    } PipelineItem;
+
+    bool m_pipelineEnabled;
+    Utils::SpscRing<PipelineItem>* m_pipeline;
+
+    // Sharded execution, the dispatching thread runs shard 0 and the pool
+    // the others.
+    int                m_shardNum;
+    Utils::ThreadPool* m_shardPool;
+    Utils::Condition   m_shardMonitor;
+    int                m_pendingShardNum;
+    vector<ShardTask>  m_shardTasks;
 
     Utils::Thread m_thread;
 
@@ -22,8 +22,12 @@ Runtime::Runtime(Process* process)
     m_state        = Idle;
     m_activated    = false;
     m_subscribeAll = false;
+    m_mainInstrumentId = 0;
+    m_deferred     = false;
+    m_orderSeq     = 0;
+    m_firstOrderId = 0;
+    m_orderIdStride = 1;
 
-    m_barsProcessedEvent.setType(Event::EvtBarProcessed);
     m_orders.clear();
     m_longPosList.clear();
     m_shortPosList.clear();
@@ -134,11 +138,12 @@ double Runtime::getEquity() const
 
 const Bar& Runtime::getLastBar(const char* instrument) const
 {
-    if (instrument == nullptr || instrument[0] == '\0') {
-        instrument = m_mainInstrument.c_str();
+    InstrumentId instrumentId = m_mainInstrumentId;
+    if (instrument != nullptr && instrument[0] != '\0') {
+        instrumentId = SymbolTable::find(instrument);
     }
 
-    const auto& it = m_lastBars.find(instrument);
+    const auto& it = m_lastBars.find(instrumentId);
     if (it != m_lastBars.end()) {
         return it->second;
     }
@@ -161,11 +166,17 @@ const char* Runtime::getMainInstrument() const
     return m_mainInstrument.c_str();
 }
 
+InstrumentId Runtime::getMainInstrumentId() const
+{
+    return m_mainInstrumentId;
+}
+
 void Runtime::setMainInstrument(const char* instrument)
 {
     REQUIRE(instrument && instrument[0] != '\0', "Main instrument invalid.");
 
-    m_mainInstrument = instrument;
+    m_mainInstrument   = instrument;
+    m_mainInstrumentId = SymbolTable::intern(instrument);
 }
 
 void Runtime::subscribeAll()
@@ -180,27 +191,15 @@ bool Runtime::isSubscribeAll() const
 
 const Contract& Runtime::getContract(const char* instrument) const
 {
-    static Contract cache;
-
-    string instr;
-    if (instrument == nullptr || instrument[0] == '\0') {
-        instr = m_mainInstrument;
-    } else {
-        instr = instrument;
+    InstrumentId instrumentId = m_mainInstrumentId;
+    if (instrument != nullptr && instrument[0] != '\0') {
+        instrumentId = SymbolTable::find(instrument);
     }
 
-    if (instr == cache.instrument) {
-        return cache;
-    }
-
-    const auto& itor = m_contracts.find(m_mainInstrument);
-    if (itor != m_contracts.end()) {
-        cache = itor->second;
+    const auto& itor = m_contracts.find(instrumentId);
+    ASSERT(itor != m_contracts.end(), "Contract could not be found.");
 
-        return itor->second;
-    } else {
-        ASSERT(false, "Contract could not be found."); 
-    }
+    return itor->second;
 }
 
 BarSeries& Runtime::getBarSeries(const char* instrument)
@@ -209,17 +208,35 @@ BarSeries& Runtime::getBarSeries(const char* instrument)
         ASSERT(m_barSeries.size() > 0, "Bar series is empty.");
         return *(m_barSeries.begin()->second);
     } else {
-        const auto& itor = m_barSeries.find(instrument);
-        ASSERT(itor == m_barSeries.end(), "Bar series cannot be found.");
+        const auto& itor = m_barSeries.find(SymbolTable::find(instrument));
+        ASSERT(itor != m_barSeries.end(), "Bar series cannot be found.");
         return *(itor->second);
     }
 }
 
 unsigned long Runtime::getNextOrderId()
 {
+    if (m_deferred) {
+        // Workers can't share the executor's counter, they take ids from
+        // the range reserved for the slice.
+        return m_firstOrderId + m_orderSeq++ * m_orderIdStride;
+    }
+
     return m_process->getNextOrderId();
 }
 
+void Runtime::reserveOrderIds(unsigned long firstId, unsigned long stride)
+{
+    m_firstOrderId  = firstId;
+    m_orderIdStride = stride;
+    m_orderSeq      = 0;
+}
+
+unsigned long Runtime::getReservedOrderNum() const
+{
+    return m_orderSeq;
+}
+
 void Runtime::getTransactionRecords(vector<Transaction>& outRecords)
 {
     TransactionList records;
@@ -243,17 +260,18 @@ void Runtime::registerInstrument(const char* instrument)
         return;
     }
 
-    const auto& itor = m_barSeries.find(instrument);
+    InstrumentId instrumentId = SymbolTable::intern(instrument);
+    const auto& itor = m_barSeries.find(instrumentId);
     if (itor == m_barSeries.end()) {
         BarSeries* series = new BarSeries();
-        m_barSeries.insert(std::make_pair(instrument, series));
+        m_barSeries.insert(std::make_pair(instrumentId, series));
     }
 }
 
 void Runtime::registerContracts(const vector<Contract>& contracts)
 {
     for (auto& item : contracts) {
-        m_contracts.insert(std::make_pair(item.instrument, item));
+        m_contracts.insert(std::make_pair(SymbolTable::intern(item.instrument), item));
     }
 }
 
@@ -287,6 +305,15 @@ BacktestingBroker* Runtime::getBroker()
 
 int Runtime::loadData(const DataRequest& request)
 {
+    if (m_deferred) {
+        DeferredRequest item;
+        item.type    = LoadDataRequest;
+        item.orderId = 0;
+        item.request = request;
+        m_deferredRequests.push_back(item);
+        return 0;
+    }
+
     return m_process->loadData(request);
 }
 
@@ -431,6 +458,15 @@ unsigned long Runtime::submitOrder(const Order& order)
 void Runtime::placeOrder(const Order& order)
 {
     if (m_activated) {
+        if (m_deferred) {
+            DeferredRequest item;
+            item.type    = PlaceOrderRequest;
+            item.order   = order;
+            item.orderId = order.getId();
+            m_deferredRequests.push_back(item);
+            return;
+        }
+
         return getBroker()->placeOrder(order);
     }
 }
@@ -438,6 +474,14 @@ void Runtime::placeOrder(const Order& order)
 void Runtime::cancelOrder(unsigned long orderId)
 {
     if (m_activated) {
+        if (m_deferred) {
+            DeferredRequest item;
+            item.type    = CancelOrderRequest;
+            item.orderId = orderId;
+            m_deferredRequests.push_back(item);
+            return;
+        }
+
         return getBroker()->cancelOrder(orderId);
     }
 }
@@ -463,16 +507,19 @@ void Runtime::notifyPositions(const Bar& bar)
 
 long Runtime::getPositionSize(const char* instrument) const
 {
-    string instrName = (instrument == nullptr || instrument[0] == '\0') ? m_mainInstrument : instrument;
+    InstrumentId instrumentId = m_mainInstrumentId;
+    if (instrument != nullptr && instrument[0] != '\0') {
+        instrumentId = SymbolTable::find(instrument);
+    }
     int longPos  = 0;
     int shortPos = 0;
 
-    const auto& longIt = m_longPosList.find(instrName);
+    const auto& longIt = m_longPosList.find(instrumentId);
     if (longIt != m_longPosList.end()) {
         longPos = longIt->second->getShares();
     }
 
-    const auto& shortIt = m_shortPosList.find(instrName);
+    const auto& shortIt = m_shortPosList.find(instrumentId);
     if (shortIt != m_shortPosList.end()) {
         shortPos = shortIt->second->getShares();
     }
@@ -482,13 +529,14 @@ long Runtime::getPositionSize(const char* instrument) const
 
 Position* Runtime::getCurrentPosition(const char* instrument, int side)
 {
+    InstrumentId instrumentId = SymbolTable::find(instrument);
     if (side == Position::LongPos) {
-        const auto& it = m_longPosList.find(instrument);
+        const auto& it = m_longPosList.find(instrumentId);
         if (it != m_longPosList.end()) {
             return it->second;
         }
     } else if (side == Position::ShortPos) {
-        const auto& it = m_shortPosList.find(instrument);
+        const auto& it = m_shortPosList.find(instrumentId);
         if (it != m_shortPosList.end()) {
             return it->second;
         }
@@ -514,7 +562,8 @@ void Runtime::getAllPositions(Vector<Position*>& positions)
 
 void Runtime::getAllSubPositions(const char* instrument, SubPositionList& posList)
 {
-    const auto& longIt = m_longPosList.find(instrument);
+    InstrumentId instrumentId = SymbolTable::find(instrument);
+    const auto& longIt = m_longPosList.find(instrumentId);
     if (longIt != m_longPosList.end()) {
         SubPositionList pos;
         longIt->second->getSubPositions(pos);
@@ -525,7 +574,7 @@ void Runtime::getAllSubPositions(const char* instrument, SubPositionList& posLis
         }
     }
 
-    const auto& shortIt = m_shortPosList.find(instrument);
+    const auto& shortIt = m_shortPosList.find(instrumentId);
     if (shortIt != m_shortPosList.end()) {
         SubPositionList pos;
         shortIt->second->getSubPositions(pos);
@@ -613,12 +662,12 @@ void Runtime::closeAllPositionsImmediately(double price)
 
 void Runtime::updateBarSeries(const Bar& bar)
 {
-    const string& instrument = bar.getInstrument();
+    InstrumentId instrumentId = bar.getInstrumentId();
 
-    auto itor = m_barSeries.find(instrument);
+    auto itor = m_barSeries.find(instrumentId);
     if (itor == m_barSeries.end()) {
         BarSeries* series = new BarSeries();
-        itor = m_barSeries.insert(make_pair(instrument, series)).first;
+        itor = m_barSeries.insert(make_pair(instrumentId, series)).first;
     }
 
     itor->second->appendWithDateTime(bar.getDateTime(), &bar);
@@ -696,7 +745,55 @@ void Runtime::onBarEvent(const Bar& bar)
     m_strategyObj->onBar(bar);
 
     // 4: Notify that the bar was processed.
-    m_barsProcessedEvent.emit(bar.getDateTime(), &bar);
+    m_barsProcessedEvent.emit(bar);
+}
+
+void Runtime::onSliceEvent(const Bar* const* bars, int num)
+{
+    m_strategyObj->onSlice(bars, num);
+}
+
+void Runtime::queueBar(const Bar& bar)
+{
+    m_queuedBars.push_back(&bar);
+}
+
+// Runs on a worker: the runtime only touches its own state, the broker is
+// read-only until the requests are flushed.
+void Runtime::runQueuedBars(const Bar* const* sliceBars, int num)
+{
+    m_deferred = true;
+
+    for (size_t i = 0; i < m_queuedBars.size(); i++) {
+        onBarEvent(*m_queuedBars[i]);
+    }
+    m_queuedBars.clear();
+
+    onSliceEvent(sliceBars, num);
+
+    m_deferred = false;
+}
+
+void Runtime::flushRequests()
+{
+    if (m_deferredRequests.empty()) {
+        return;
+    }
+
+    // Requests made from the order events below go to the broker directly.
+    vector<DeferredRequest> requests;
+    requests.swap(m_deferredRequests);
+
+    for (size_t i = 0; i < requests.size(); i++) {
+        const DeferredRequest& item = requests[i];
+        if (item.type == PlaceOrderRequest) {
+            getBroker()->placeOrder(item.order);
+        } else if (item.type == CancelOrderRequest) {
+            getBroker()->cancelOrder(item.orderId);
+        } else if (item.type == LoadDataRequest) {
+            m_process->loadData(item.request);
+        }
+    }
 }
 
 unsigned long Runtime::buy(const char* instrument, int quantity, double price, bool immediately, const char* signal)
@@ -778,22 +875,22 @@ void Runtime::createOrUpdatePosition(const OrderEvent& evt)
 
     Position* position = nullptr;
     if (order.getAction() == Order::Action::BUY || order.getAction() == Order::Action::SELL) {
-        const auto& it = m_longPosList.find(order.getInstrument());
+        const auto& it = m_longPosList.find(order.getInstrumentId());
         if (it != m_longPosList.end()) {
             position = it->second;
         } else {
             position = new Position();
             position->getImplementor()->init(position, this, order);
-            m_longPosList.insert(std::make_pair(order.getInstrument(), position));
+            m_longPosList.insert(std::make_pair(order.getInstrumentId(), position));
         }
     } else if (order.getAction() == Order::Action::SELL_SHORT || order.getAction() == Order::Action::BUY_TO_COVER) {
-        const auto& it = m_shortPosList.find(order.getInstrument());
+        const auto& it = m_shortPosList.find(order.getInstrumentId());
         if (it != m_shortPosList.end()) {
             position = it->second;
         } else {
             position = new Position();
             position->getImplementor()->init(position, this, order);
-            m_shortPosList.insert(std::make_pair(order.getInstrument(), position));
+            m_shortPosList.insert(std::make_pair(order.getInstrumentId(), position));
         }
     }
 
@@ -3,7 +3,7 @@
 
 #include "Thread.h"
 #include "Lock.h"
-#include "Event.h"
+#include "Signal.h"
 #include "Order.h"
 #include "BarFeed.h"
 #include "Composer.h"
@@ -53,6 +53,7 @@ public:
     double getTickSize(const char* instrument) const;
     void setMainInstrument(const char* instrument);
     const char* getMainInstrument() const;
+    InstrumentId getMainInstrumentId() const;
     void subscribeAll();
     bool isSubscribeAll() const;
     const Contract& getContract(const char* instrument = nullptr) const;
@@ -68,8 +69,12 @@ public:
     void closePosition(int posId);
     void closeAllPositions();
     void closeAllPositionsImmediately(double price);
-    // load historical data, currently only supports synchronized mode.
-    // `onHistoricalData` will be called back immediately.
+    // load historical data. In synchronized mode `onHistoricalData` will be
+    // called back immediately and the number of bars is returned. In
+    // asynchronous mode the request id is returned and the bars are
+    // delivered before the next bar, in the order of requests. Requests of
+    // a sharded runtime are served after the slice, bars are delivered
+    // before the next bar and 0 is returned.
     int  loadData(const DataRequest& request);
     void writeDebugMsg(const char* msg);
     void reset();
@@ -108,6 +113,7 @@ public:
     void onCreate();
     void onStart();
     void onBarEvent(const Bar& bar);
+    void onSliceEvent(const Bar* const* bars, int num);
     // Return True if runtime accept this order event.
     bool onOrderEvent(const OrderEvent* evt);
     void onTimeElapsed(const DateTime& prevDateTime, const DateTime& currDateTime);
@@ -115,6 +121,21 @@ public:
     void onDestroy();
     void onHistoricalData(const Bar& bar, bool isCompleted);
 
+    // Sharded execution. Bars of a slice are queued on the dispatching
+    // thread and run on a worker with broker requests deferred, the requests
+    // are then replayed on the dispatching thread. Orders created on the
+    // worker take their ids from a range reserved by the executor for the
+    // slice, see reserveOrderIds().
+    // Queued bars are kept by address, they must outlive runQueuedBars().
+    void queueBar(const Bar& bar);
+    void runQueuedBars(const Bar* const* sliceBars, int num);
+    void flushRequests();
+    // Ids of the orders created in the next deferred run are `firstId`,
+    // `firstId + stride`, ...
+    void reserveOrderIds(unsigned long firstId, unsigned long stride);
+    // Number of ids taken since reserveOrderIds().
+    unsigned long getReservedOrderNum() const;
+
     // Creates a Market order.
     // A market order is an order to buy or sell a stock at the best available price.
     // Generally, this type of order will be executed immediately. However, the price at which a market order will be executed
@@ -226,6 +247,7 @@ private:
     unsigned long m_id;
     string     m_name;
     string     m_mainInstrument;
+    InstrumentId m_mainInstrumentId;
     Bar        m_lastBar;
     Strategy*  m_strategyObj;
     ParamTuple m_paramTuple;
@@ -233,8 +255,8 @@ private:
     double m_cash;
     bool m_subscribeAll;
     vector<InstrumentDesc> m_symbols;
-    std::unordered_map<string, Contract> m_contracts;
-    unordered_map<string, Bar> m_lastBars;
+    InstrumentMap<Contract> m_contracts;
+    InstrumentMap<Bar> m_lastBars;
 
     vector<BarComposer*> m_composers;
 
@@ -253,16 +275,39 @@ private:
     // mapping order id to order
     unordered_map<unsigned long, Order> m_orders;
 
-    unordered_map<string, Position*> m_longPosList;
-    unordered_map<string, Position*> m_shortPosList;
+    InstrumentMap<Position*> m_longPosList;
+    InstrumentMap<Position*> m_shortPosList;
     vector<Position*> m_closedPosList;
 
     // Record dummy position size when running in inactive period.
     int m_dummyShares;
 
-    unordered_map<string, BarSeries*> m_barSeries;
+    InstrumentMap<BarSeries*> m_barSeries;
+
+    Signal<const Bar&> m_barsProcessedEvent;
 
-    Event m_barsProcessedEvent;
+    // Sharded execution state.
+    enum {
+        PlaceOrderRequest,
+        CancelOrderRequest,
+        LoadDataRequest,
+    };
+
+    typedef struct {
+        int           type;
+        Order         order;
+        unsigned long orderId;
+        DataRequest   request;
+    } DeferredRequest;
+
+    bool m_deferred;
+    // Ids of orders created while deferred are `m_firstOrderId +
+    // seq * m_orderIdStride`, seq counting from 0 in each slice.
+    unsigned long m_firstOrderId;
+    unsigned long m_orderIdStride;
+    unsigned long m_orderSeq;
+    vector<const Bar*> m_queuedBars;
+    vector<DeferredRequest> m_deferredRequests;
 
     typedef struct {
         string name;
@@ -0,0 +1,164 @@
+#ifndef SIGNAL_H
+#define SIGNAL_H
+
+#include <vector>
+#include <cstddef>
+
+namespace xBacktest
+{
+
+// Typed notification to a list of slots. A slot is an object and one of its
+// member functions, bound at compile time:
+//
+//   Signal<const DateTime&, const double&> signal;
+//   signal.subscribe<MA, &MA::onNewValue>(&ma);
+//   signal.emit(datetime, value);
+//
+// Slots are called in subscribing order through a plain function pointer,
+// the first ones are stored inline. Subscribing or unsubscribing while
+// emitting takes effect after the emission.
+template<typename... Args>
+class Signal
+{
+public:
+    Signal()
+    {
+        m_size         = 0;
+        m_emitting     = false;
+        m_applyChanges = false;
+    }
+
+    template<typename T, void (T::*Method)(Args...)>
+    void subscribe(T* object)
+    {
+        Slot slot = { object, &invoke<T, Method> };
+        if (m_emitting) {
+            m_toSubscribe.push_back(slot);
+            m_applyChanges = true;
+        } else {
+            add(slot);
+        }
+    }
+
+    template<typename T, void (T::*Method)(Args...)>
+    void unsubscribe(T* object)
+    {
+        Slot slot = { object, &invoke<T, Method> };
+        if (m_emitting) {
+            m_toUnsubscribe.push_back(slot);
+            m_applyChanges = true;
+        } else {
+            remove(slot);
+        }
+    }
+
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    void emit(Args... args)
+    {
+        m_emitting = true;
+        for (size_t i = 0; i < m_size; i++) {
+            const Slot& slot = at(i);
+            slot.function(slot.object, args...);
+        }
+        m_emitting = false;
+
+        if (m_applyChanges) {
+            applyChanges();
+            m_applyChanges = false;
+        }
+    }
+
+private:
+    typedef void (*Function)(void* object, Args... args);
+
+    typedef struct {
+        void*    object;
+        Function function;
+    } Slot;
+
+    enum { INLINE_SLOT_NUM = 4 };
+
+    template<typename T, void (T::*Method)(Args...)>
+    static void invoke(void* object, Args... args)
+    {
+        (static_cast<T*>(object)->*Method)(args...);
+    }
+
+    Slot& at(size_t idx)
+    {
+        return idx < INLINE_SLOT_NUM ? m_inline[idx] : m_overflow[idx - INLINE_SLOT_NUM];
+    }
+
+    size_t find(const Slot& slot)
+    {
+        for (size_t i = 0; i < m_size; i++) {
+            const Slot& item = at(i);
+            if (item.object == slot.object && item.function == slot.function) {
+                return i;
+            }
+        }
+
+        return m_size;
+    }
+
+    void add(const Slot& slot)
+    {
+        if (find(slot) < m_size) {
+            return;
+        }
+
+        if (m_size < INLINE_SLOT_NUM) {
+            m_inline[m_size] = slot;
+        } else {
+            m_overflow.push_back(slot);
+        }
+        m_size++;
+    }
+
+    void remove(const Slot& slot)
+    {
+        size_t idx = find(slot);
+        if (idx == m_size) {
+            return;
+        }
+
+        for (size_t i = idx + 1; i < m_size; i++) {
+            at(i - 1) = at(i);
+        }
+        m_size--;
+        if (m_size >= INLINE_SLOT_NUM) {
+            m_overflow.pop_back();
+        }
+    }
+
+    void applyChanges()
+    {
+        for (size_t i = 0; i < m_toSubscribe.size(); i++) {
+            add(m_toSubscribe[i]);
+        }
+        m_toSubscribe.clear();
+
+        for (size_t i = 0; i < m_toUnsubscribe.size(); i++) {
+            remove(m_toUnsubscribe[i]);
+        }
+        m_toUnsubscribe.clear();
+    }
+
+private:
+    Slot              m_inline[INLINE_SLOT_NUM];
+    std::vector<Slot> m_overflow;
+    size_t            m_size;
+
+    std::vector<Slot> m_toSubscribe;
+    std::vector<Slot> m_toUnsubscribe;
+    bool m_emitting;
+    bool m_applyChanges;
+};
+
+} // namespace xBacktest
+
+#endif // SIGNAL_H
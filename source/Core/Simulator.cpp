@@ -130,6 +130,58 @@ bool Simulator::registerDataStream(const char* symbol, int resolution, int inter
     return m_implementor->registerDataStream(symbol, resolution, interval, filename, format);
 }
 
+bool Simulator::registerDataStream(const char* symbol, int resolution, int interval, const char* filename, const DataRange& range, int format)
+{
+    if (symbol == nullptr || symbol[0] == '\0') {
+        return false;
+    }
+
+    if (filename == nullptr || filename[0] == '\0') {
+        return false;
+    }
+
+    return m_implementor->registerDataStream(symbol, resolution, interval, filename, format, range);
+}
+
+bool Simulator::registerContinuousDataStream(const char* symbol, int resolution, int interval, const char* filename, const char* instrument, int adjustment)
+{
+    if (symbol == nullptr || symbol[0] == '\0') {
+        return false;
+    }
+
+    if (filename == nullptr || filename[0] == '\0') {
+        return false;
+    }
+
+    if (instrument == nullptr || instrument[0] == '\0') {
+        return false;
+    }
+
+    return m_implementor->registerContinuousDataStream(symbol, resolution, interval, filename, instrument, adjustment);
+}
+
+bool Simulator::enableComposer(const char* symbol, const TradingSession& session, int resolution, int interval)
+{
+    if (symbol == nullptr || symbol[0] == '\0') {
+        return false;
+    }
+
+    return m_implementor->enableComposer(symbol, session, resolution, interval);
+}
+
+bool Simulator::registerComposedDataStream(const char* name, const char* source, const TradingSession& session, int resolution, int interval)
+{
+    if (name == nullptr || name[0] == '\0') {
+        return false;
+    }
+
+    if (source == nullptr || source[0] == '\0') {
+        return false;
+    }
+
+    return m_implementor->registerComposedDataStream(name, source, session, resolution, interval);
+}
+
 void Simulator::setMultiplier(const char* symbol, double multiplier)
 {
     if (symbol == nullptr || symbol[0] == '\0') {
@@ -148,6 +200,15 @@ void Simulator::setTickSize(const char* symbol, double size)
     return m_implementor->setTickSize(symbol, size);
 }
 
+void Simulator::setFixedPrice(const char* symbol, bool fixed)
+{
+    if (symbol == nullptr || symbol[0] == '\0') {
+        return;
+    }
+
+    return m_implementor->setFixedPrice(symbol, fixed);
+}
+
 void Simulator::setMarginRatio(const char* symbol, double ratio)
 {
     if (symbol == nullptr || symbol[0] == '\0') {
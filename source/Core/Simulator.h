@@ -40,10 +40,40 @@ public:
                                           int interval, 
                                           const char* filename, 
                                           int format = DATA_FILE_FORMAT_UNKNOWN);
+    // Same as above, only rows within `range` are loaded, e.g. the last two
+    // years or a few instruments of a long file.
+    bool               registerDataStream(const char* symbol,
+                                          int resolution,
+                                          int interval,
+                                          const char* filename,
+                                          const DataRange& range,
+                                          int format = DATA_FILE_FORMAT_UNKNOWN);
+    // Register one continuous contract named `instrument` (at most 7
+    // characters), stitched from the main contracts of binary file `filename`
+    // by their hot flags. It's built next to the file, e.g. 'data.rb888.back.bin'
+    // with the roll table in 'data.rb888.back.bin.roll', and rebuilt when the
+    // file changes.
+    bool               registerContinuousDataStream(const char* symbol,
+                                                    int resolution,
+                                                    int interval,
+                                                    const char* filename,
+                                                    const char* instrument,
+                                                    int adjustment = BackAdjusted);
     void               registerContract(const char* symbol, const Contract& contract);
+    // Compose bars of `resolution` out of data stream `symbol` once at load
+    // time, strategies subscribe them as data stream '<symbol>@<interval><unit>',
+    // e.g. 'rb@5m', 'rb@1h' or 'rb@1d'.
     bool               enableComposer(const char* symbol, const TradingSession& session, int resolution, int interval = 1);
+    bool               registerComposedDataStream(const char* name,
+                                                  const char* source,
+                                                  const TradingSession& session,
+                                                  int resolution,
+                                                  int interval = 1);
     void               setMultiplier(const char* symbol, double multiplier);
     void               setTickSize(const char* symbol, double size);
+    // Process prices of `symbol` as integer counts of its tick size: bars are
+    // snapped to the tick grid and fill prices are compared exactly.
+    void               setFixedPrice(const char* symbol, bool fixed);
     void               setMarginRatio(const char* symbol, double ratio);
     void               setCommissionType(const char* symbol, int type);
     void               setCommission(const char* symbol, double comm);
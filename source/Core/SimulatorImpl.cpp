@@ -3,9 +3,12 @@
 #endif
 
 #include <iostream>
+#include <thread>
+#include <algorithm>
 #include "tinyxml2.h"
 #include "Utils.h"
 #include "Timer.h"
+#include "ThreadPool.h"
 #include "Logger.h"
 #include "Simulator.h"
 #include "SimulatorImpl.h"
@@ -119,21 +122,87 @@ bool SimulatorImpl::loadDataFeed()
 
     m_dataFeedConfig.setBarStorage(m_storage);
 
+    if (!m_envConfig.isCacheEnabled()) {
+        m_storage->setCacheDirectory("");
+    } else if (!m_envConfig.getCacheDirectory().empty()) {
+        m_storage->setCacheDirectory(m_envConfig.getCacheDirectory());
+    }
+    m_storage->setStreamingWindow(m_envConfig.getStreamingWindow());
+    m_storage->enableTimeline(m_envConfig.isTimelineEnabled());
+
     std::reverse(m_dataFeedConfig.getStreams().begin(), m_dataFeedConfig.getStreams().end());
 
-    size_t size = m_dataFeedConfig.getStreams().size();
-    for (size_t i = 0; i < size; i++) {
-        if (!m_dataFeedConfig.getStreams()[i].name.empty()) {
-            if (!m_storage->loadDataStreamFile(
-                m_dataFeedConfig.getStreams()[i].name,
-                m_dataFeedConfig.getStreams()[i].uri,
-                m_dataFeedConfig.getStreams()[i].format,
-                m_dataFeedConfig.getStreams()[i].resolution,
-                m_dataFeedConfig.getStreams()[i].interval,
-                m_dataFeedConfig.getStreams()[i].contract)) {
-                Logger_Err() << "Data loading failed!";
-                return false;
+    const vector<DataStreamConfig>& configs = m_dataFeedConfig.getStreams();
+    size_t size = configs.size();
+
+    // Files are mapped and scanned in parallel, then registered one by one
+    // in configuration order so ids of streams and feeds stay the same.
+    vector<DataStream*> streams(size, nullptr);
+    {
+        int threadNum = std::min<int>(std::thread::hardware_concurrency(), size);
+        Utils::ThreadPool pool(threadNum);
+        for (size_t i = 0; i < size; i++) {
+            if (configs[i].name.empty()) {
+                continue;
             }
+
+            DataStorage* storage = m_storage;
+            const DataStreamConfig* config = &configs[i];
+            DataStream** stream = &streams[i];
+            pool.Submit([storage, config, stream]() {
+                if (!config->continuous.empty()) {
+                    *stream = storage->prepareContinuousDataStream(
+                        config->name,
+                        config->uri,
+                        config->continuous,
+                        config->adjustment,
+                        config->resolution,
+                        config->interval,
+                        config->contract,
+                        config->range);
+                    return;
+                }
+
+                *stream = storage->prepareDataStream(
+                    config->name,
+                    config->uri,
+                    config->format,
+                    config->resolution,
+                    config->interval,
+                    config->contract,
+                    config->range);
+            });
+        }
+        // Leaving the scope waits for all the files.
+    }
+
+    bool succeeded = true;
+    for (size_t i = 0; i < size; i++) {
+        if (configs[i].name.empty()) {
+            continue;
+        }
+
+        if (streams[i] == nullptr || !m_storage->registerDataStream(streams[i])) {
+            succeeded = false;
+        }
+    }
+
+    if (!succeeded) {
+        Logger_Err() << "Data loading failed!";
+        return false;
+    }
+
+    // Compose finer levels first, coarser ones are built out of them.
+    vector<ComposedStreamConfig> composedConfigs = m_dataFeedConfig.getComposedStreams();
+    std::stable_sort(composedConfigs.begin(), composedConfigs.end(),
+        [](const ComposedStreamConfig& c1, const ComposedStreamConfig& c2) {
+            return (int64)c1.resolution * c1.interval < (int64)c2.resolution * c2.interval;
+        });
+
+    for (auto& config : composedConfigs) {
+        if (!m_storage->composeDataStream(config.name, config.source, config.session, config.resolution, config.interval)) {
+            Logger_Err() << "Data loading failed!";
+            return false;
         }
     }
 
@@ -185,6 +254,51 @@ bool SimulatorImpl::parseScenario(const string& filename, StrategyConfig& config
         } else {
             m_envConfig.setOptimizationMode(Optimizer::Exhaustive);
         }
+
+        // <cache dir="..." enable="false"/>
+        if (envElem->FirstChildElement("cache")) {
+            tinyxml2::XMLElement* cacheElem = envElem->FirstChildElement("cache");
+            const char* dir = cacheElem->Attribute("dir");
+            if (dir != nullptr) {
+                m_envConfig.setCacheDirectory(dir);
+            }
+            const char* enable = cacheElem->Attribute("enable");
+            if (enable != nullptr && _stricmp(enable, "false") == 0) {
+                m_envConfig.enableCache(false);
+            }
+        }
+
+        // <streaming window="65536"/>
+        if (envElem->FirstChildElement("streaming")) {
+            const char* window = envElem->FirstChildElement("streaming")->Attribute("window");
+            if (window != nullptr) {
+                m_envConfig.setStreamingWindow(atoi(window));
+            }
+        }
+
+        // <timeline merged="true"/>
+        if (envElem->FirstChildElement("timeline")) {
+            const char* merged = envElem->FirstChildElement("timeline")->Attribute("merged");
+            if (merged != nullptr && _stricmp(merged, "true") == 0) {
+                m_envConfig.enableTimeline(true);
+            }
+        }
+
+        // <shards num="4"/>
+        if (envElem->FirstChildElement("shards")) {
+            const char* num = envElem->FirstChildElement("shards")->Attribute("num");
+            if (num != nullptr) {
+                m_envConfig.setShardNum(atoi(num));
+            }
+        }
+
+        // <pipeline enable="true"/>
+        if (envElem->FirstChildElement("pipeline")) {
+            const char* enable = envElem->FirstChildElement("pipeline")->Attribute("enable");
+            if (enable != nullptr && _stricmp(enable, "true") == 0) {
+                m_envConfig.enablePipeline(true);
+            }
+        }
     } else {
         m_envConfig.setOptimizationMode(Optimizer::Exhaustive);
     }
@@ -234,13 +348,50 @@ bool SimulatorImpl::parseScenario(const string& filename, StrategyConfig& config
                 ds.realtime = false;
             }
             
+            // continuous="rb888" adjust="back|none"
+            ds.adjustment = NoAdjustment;
+            const char* continuous = streamElem->Attribute("continuous");
+            if (continuous != nullptr) {
+                ds.continuous = continuous;
+                const char* adjust = streamElem->Attribute("adjust");
+                if (adjust != nullptr && _stricmp(adjust, "back") == 0) {
+                    ds.adjustment = BackAdjusted;
+                }
+            }
+
             const char* formatStr = streamElem->Attribute("format");
             if (formatStr != nullptr && !_stricmp(formatStr, "csv")) {
                 ds.format = DATA_FILE_FORMAT_CSV;
+            } else if (formatStr != nullptr && !_stricmp(formatStr, "col")) {
+                ds.format = DATA_FILE_FORMAT_COL;
+            } else if (formatStr != nullptr && !_stricmp(formatStr, "cbin")) {
+                ds.format = DATA_FILE_FORMAT_CMP;
             } else {
                 ds.format = DATA_FILE_FORMAT_BIN;
             }
 
+            // from="2014-01-01" to="2015-12-31T15:00:00" instruments="rb1505,rb1510"
+            const char* fromStr = streamElem->Attribute("from");
+            if (fromStr != nullptr) {
+                ds.range.from = DateTime(string(fromStr));
+            }
+            const char* toStr = streamElem->Attribute("to");
+            if (toStr != nullptr) {
+                ds.range.to = DateTime(string(toStr));
+                if (strchr(toStr, 'T') == nullptr) {
+                    // A date alone takes the whole day.
+                    ds.range.to = DateTime(ds.range.to.ticks() + 24 * 60 * 60 * 1000LL - 1);
+                }
+            }
+            if (ds.range.from.isValid() && ds.range.to.isValid() && ds.range.from > ds.range.to) {
+                Logger_Err() << "Data stream '" << ds.name << "' has an empty date range.";
+                return false;
+            }
+            const char* instruments = streamElem->Attribute("instruments");
+            if (instruments != nullptr) {
+                Utils::split(instruments, ",", ds.range.instruments);
+            }
+
             // Parse contract
             tinyxml2::XMLElement* contractElem = streamElem->FirstChildElement("contract")->ToElement();
             if (contractElem) {
@@ -254,6 +405,9 @@ bool SimulatorImpl::parseScenario(const string& filename, StrategyConfig& config
                 elem = contractElem->FirstChildElement("ticksize");
                 if (elem) {
                     contract.tickSize = atof(elem->GetText());
+                    // <ticksize fixed="true">1</ticksize>
+                    const char* fixedStr = elem->Attribute("fixed");
+                    contract.fixedPrice = (fixedStr != nullptr && !_stricmp(fixedStr, "true"));
                 }
 
                 elem = contractElem->FirstChildElement("commission");
@@ -283,6 +437,53 @@ bool SimulatorImpl::parseScenario(const string& filename, StrategyConfig& config
                 return false;
             }
 
+            // <compose name="rb5m" resolution="minute" interval="5" session="090000-101500,103000-113000"/>
+            tinyxml2::XMLElement* composeElem = streamElem->FirstChildElement("compose");
+            while (composeElem) {
+                const char* cres = composeElem->Attribute("resolution");
+                int resolution = 0;
+                if (cres != nullptr && _stricmp(cres, "day") == 0) {
+                    resolution = Bar::DAY;
+                } else if (cres != nullptr && _stricmp(cres, "hour") == 0) {
+                    resolution = Bar::HOUR;
+                } else if (cres != nullptr && _stricmp(cres, "minute") == 0) {
+                    resolution = Bar::MINUTE;
+                } else if (cres != nullptr && _stricmp(cres, "second") == 0) {
+                    resolution = Bar::SECOND;
+                } else {
+                    Logger_Err() << "Unsupported resolution of composed data stream.";
+                    return false;
+                }
+
+                int interval = 1;
+                if (composeElem->Attribute("interval") != nullptr) {
+                    interval = atoi(composeElem->Attribute("interval"));
+                }
+
+                TradingSession session;
+                const char* sessionStr = composeElem->Attribute("session");
+                if (sessionStr != nullptr) {
+                    vector<string> periods;
+                    Utils::split(sessionStr, ",", periods);
+                    for (auto& str : periods) {
+                        TradablePeriod period;
+                        if (sscanf(str.c_str(), "%ld-%ld", &period.begin, &period.end) != 2) {
+                            Logger_Err() << "Invalid trading session '" << sessionStr << "'.";
+                            return false;
+                        }
+                        session.push_back(period);
+                    }
+                }
+
+                const char* name = composeElem->Attribute("name");
+                string composedName = name != nullptr ? name : DataStorage::getComposedStreamName(ds.name, resolution, interval);
+                if (!registerComposedDataStream(composedName, ds.name, session, resolution, interval)) {
+                    return false;
+                }
+
+                composeElem = composeElem->NextSiblingElement("compose");
+            }
+
             m_dataFeedConfig.registerStream(ds);
             dsCount++;
 
@@ -472,6 +673,8 @@ bool SimulatorImpl::initRunningMode(vector<StrategyConfig>& strategies)
                 m_brokerConfig,
                 m_reportConfig,
                 strategies);
+            m_backtester->setShardNum(m_envConfig.getShardNum());
+            m_backtester->enablePipeline(m_envConfig.isPipelineEnabled());
             m_backtester->init();
         } else {
             return false;
@@ -615,10 +818,10 @@ void SimulatorImpl::setDataSeriesMaxLength(int length)
     DataSeries::DEFAULT_MAX_LEN = length;
 }
 
-bool SimulatorImpl::registerDataStream(const string& symbol, int resolution, int interval, const string& filename, int format)
+bool SimulatorImpl::registerDataStream(const string& symbol, int resolution, int interval, const string& filename, int format, const DataRange& range)
 {
     if (format != DATA_FILE_FORMAT_UNKNOWN) {
-        m_dataFeedConfig.registerStream(symbol, resolution, interval, filename, format);
+        m_dataFeedConfig.registerStream(symbol, resolution, interval, filename, format, range);
         return true;
     }
 
@@ -632,12 +835,46 @@ bool SimulatorImpl::registerDataStream(const string& symbol, int resolution, int
         fmt = DATA_FILE_FORMAT_BIN;
     } else if (ext == "ts") {
         fmt = DATA_FILE_FORMAT_TS;
+    } else if (ext == "col") {
+        fmt = DATA_FILE_FORMAT_COL;
+    } else if (ext == "cbin") {
+        fmt = DATA_FILE_FORMAT_CMP;
     } else {
         Logger_Info() << "Unknown data file extension.";
         return false;
     }
 
-    m_dataFeedConfig.registerStream(symbol, resolution, interval, filename, fmt);
+    m_dataFeedConfig.registerStream(symbol, resolution, interval, filename, fmt, range);
+
+    return true;
+}
+
+bool SimulatorImpl::registerContinuousDataStream(const string& symbol, int resolution, int interval, const string& filename, const string& instrument, int adjustment)
+{
+    m_dataFeedConfig.registerStream(symbol, resolution, interval, filename, DATA_FILE_FORMAT_BIN);
+
+    DataStreamConfig& config = m_dataFeedConfig.getStreams().back();
+    config.continuous = instrument;
+    config.adjustment = adjustment;
+
+    return true;
+}
+
+bool SimulatorImpl::enableComposer(const string& symbol, const TradingSession& session, int resolution, int interval)
+{
+    string name = DataStorage::getComposedStreamName(symbol, resolution, interval);
+    return registerComposedDataStream(name, symbol, session, resolution, interval);
+}
+
+bool SimulatorImpl::registerComposedDataStream(const string& name, const string& source, const TradingSession& session, int resolution, int interval)
+{
+    if ((resolution != Bar::SECOND && resolution != Bar::MINUTE &&
+         resolution != Bar::HOUR && resolution != Bar::DAY) || interval <= 0) {
+        Logger_Info() << "Unsupported resolution of composed data stream '" << name << "'.";
+        return false;
+    }
+
+    m_dataFeedConfig.registerComposedStream(name, source, session, resolution, interval);
 
     return true;
 }
@@ -652,6 +889,11 @@ void SimulatorImpl::setTickSize(const string& symbol, double size)
     return m_dataFeedConfig.setTickSize(symbol, size);
 }
 
+void SimulatorImpl::setFixedPrice(const string& symbol, bool fixed)
+{
+    return m_dataFeedConfig.setFixedPrice(symbol, fixed);
+}
+
 void SimulatorImpl::setMarginRatio(const string& symbol, double ratio)
 {
     return m_dataFeedConfig.setMarginRatio(symbol, ratio);
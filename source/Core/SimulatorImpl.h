@@ -39,9 +39,23 @@ public:
                                           int resolution,
                                           int interval,
                                           const string& filename,
-                                          int format = DATA_FILE_FORMAT_UNKNOWN);
+                                          int format = DATA_FILE_FORMAT_UNKNOWN,
+                                          const DataRange& range = DataRange());
+    bool               registerContinuousDataStream(const string& symbol,
+                                                    int resolution,
+                                                    int interval,
+                                                    const string& filename,
+                                                    const string& instrument,
+                                                    int adjustment);
+    bool               enableComposer(const string& symbol, const TradingSession& session, int resolution, int interval);
+    bool               registerComposedDataStream(const string& name,
+                                                  const string& source,
+                                                  const TradingSession& session,
+                                                  int resolution,
+                                                  int interval);
     void               setMultiplier(const string& symbol, double multiplier);
     void               setTickSize(const string& symbol, double size);
+    void               setFixedPrice(const string& symbol, bool fixed);
     void               setMarginRatio(const string& symbol, double ratio);
     void               setCommissionType(const string& symbol, int type);
     void               setCommission(const string& symbol, double comm);
@@ -0,0 +1,126 @@
+#include <cassert>
+#include <cstring>
+#include <atomic>
+#include "Lock.h"
+#include "Errors.h"
+#include "SymbolTable.h"
+
+namespace xBacktest
+{
+
+// Ids are found through an open addressing table of fixed size, slots are
+// only ever filled, under the mutex, after the name they point to is in
+// place. Lookups don't lock and don't allocate.
+static const size_t SLOT_NUM = SymbolTable::MAX_SYMBOL_NUM * 2;
+
+typedef struct {
+    Utils::Mutex mutex;
+    // Capacity is reserved upfront, names never move while being read.
+    std::vector<string*> names;
+    std::atomic<InstrumentId>* slots;
+} SymbolTableImpl;
+
+static size_t hashName(const char* name)
+{
+    // FNV-1a.
+    size_t hash = 2166136261u;
+    for (const char* p = name; *p != '\0'; p++) {
+        hash = (hash ^ (unsigned char)*p) * 16777619u;
+    }
+
+    return hash;
+}
+
+// Slot holding the id of `name`, or the empty slot where it would go.
+static std::atomic<InstrumentId>& findSlot(SymbolTableImpl& table, const char* name)
+{
+    size_t pos = hashName(name) & (SLOT_NUM - 1);
+    while (true) {
+        std::atomic<InstrumentId>& slot = table.slots[pos];
+        InstrumentId id = slot.load(std::memory_order_acquire);
+        if (id == INVALID_INSTRUMENT_ID || strcmp(table.names[id]->c_str(), name) == 0) {
+            return slot;
+        }
+        pos = (pos + 1) & (SLOT_NUM - 1);
+    }
+}
+
+static SymbolTableImpl* createTable()
+{
+    SymbolTableImpl* table = new SymbolTableImpl();
+    table->names.reserve(SymbolTable::MAX_SYMBOL_NUM);
+    table->slots = new std::atomic<InstrumentId>[SLOT_NUM];
+    for (size_t i = 0; i < SLOT_NUM; i++) {
+        table->slots[i].store(INVALID_INSTRUMENT_ID, std::memory_order_relaxed);
+    }
+
+    table->names.push_back(new string());
+    findSlot(*table, "").store(0, std::memory_order_release);
+
+    return table;
+}
+
+static SymbolTableImpl& getTable()
+{
+    // Names are referenced by bars until exit, the table is never destroyed.
+    static SymbolTableImpl* table = createTable();
+    return *table;
+}
+
+InstrumentId SymbolTable::intern(const char* name)
+{
+    if (name == nullptr) {
+        name = "";
+    }
+
+    SymbolTableImpl& table = getTable();
+    Utils::Lock lock(table.mutex);
+
+    std::atomic<InstrumentId>& slot = findSlot(table, name);
+    InstrumentId id = slot.load(std::memory_order_relaxed);
+    if (id != INVALID_INSTRUMENT_ID) {
+        return id;
+    }
+
+    ASSERT(table.names.size() < MAX_SYMBOL_NUM, "Too many instruments.");
+
+    id = (InstrumentId)table.names.size();
+    table.names.push_back(new string(name));
+    slot.store(id, std::memory_order_release);
+
+    return id;
+}
+
+InstrumentId SymbolTable::intern(const string& name)
+{
+    return intern(name.c_str());
+}
+
+InstrumentId SymbolTable::find(const char* name)
+{
+    if (name == nullptr) {
+        name = "";
+    }
+
+    return findSlot(getTable(), name).load(std::memory_order_acquire);
+}
+
+InstrumentId SymbolTable::find(const string& name)
+{
+    return find(name.c_str());
+}
+
+const char* SymbolTable::getName(InstrumentId id)
+{
+    return getTable().names[id]->c_str();
+}
+
+int SymbolTable::size()
+{
+    SymbolTableImpl& table = getTable();
+    Utils::Lock lock(table.mutex);
+
+    return (int)table.names.size();
+}
+
+} // namespace xBacktest
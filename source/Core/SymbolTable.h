@@ -0,0 +1,112 @@
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include <string>
+#include <vector>
+#include "Export.h"
+
+using std::string;
+
+namespace xBacktest
+{
+
+// Dense id of an instrument, 0 is the empty name.
+typedef int InstrumentId;
+
+#define INVALID_INSTRUMENT_ID   (-1)
+
+// Process-wide table of instrument names. Names are interned when data streams
+// are loaded, bars, orders and broker state carry ids and names are resolved
+// only at the API boundary and in reports. Ids are never reused.
+class DllExport SymbolTable
+{
+public:
+    enum {
+        MAX_SYMBOL_NUM = 65536
+    };
+
+    // Id of `name`, a new id is assigned if it's not interned yet.
+    static InstrumentId intern(const char* name);
+    static InstrumentId intern(const string& name);
+
+    // Id of `name`, INVALID_INSTRUMENT_ID if it's not interned. Lock free
+    // and allocation free, strategies call it on every name based query.
+    static InstrumentId find(const char* name);
+    static InstrumentId find(const string& name);
+
+    // Lock free, `id` must be a valid id.
+    static const char* getName(InstrumentId id);
+
+    // Number of ids assigned, arrays indexed by id are sized by it.
+    static int size();
+};
+
+// Values indexed by InstrumentId, in place of maps keyed by instrument names.
+// Lookups index an array, iteration walks the values in order of insertion.
+template<typename T>
+class InstrumentMap
+{
+public:
+    typedef std::pair<InstrumentId, T> value_type;
+    typedef typename std::vector<value_type>::iterator iterator;
+    typedef typename std::vector<value_type>::const_iterator const_iterator;
+
+    iterator find(InstrumentId id)
+    {
+        if (id < 0 || id >= (InstrumentId)m_slots.size() || m_slots[id] == 0) {
+            return m_items.end();
+        }
+        return m_items.begin() + (m_slots[id] - 1);
+    }
+
+    const_iterator find(InstrumentId id) const
+    {
+        if (id < 0 || id >= (InstrumentId)m_slots.size() || m_slots[id] == 0) {
+            return m_items.end();
+        }
+        return m_items.begin() + (m_slots[id] - 1);
+    }
+
+    // Nothing is inserted if `id` is already in the map.
+    std::pair<iterator, bool> insert(const value_type& value)
+    {
+        iterator it = find(value.first);
+        if (it != m_items.end()) {
+            return std::make_pair(it, false);
+        }
+
+        if (value.first >= (InstrumentId)m_slots.size()) {
+            m_slots.resize(value.first + 1, 0);
+        }
+        m_items.push_back(value);
+        m_slots[value.first] = (int)m_items.size();
+
+        return std::make_pair(m_items.end() - 1, true);
+    }
+
+    T& operator[](InstrumentId id)
+    {
+        return insert(value_type(id, T())).first->second;
+    }
+
+    iterator begin()             { return m_items.begin(); }
+    iterator end()               { return m_items.end(); }
+    const_iterator begin() const { return m_items.begin(); }
+    const_iterator end() const   { return m_items.end(); }
+    size_t size() const          { return m_items.size(); }
+    bool empty() const           { return m_items.empty(); }
+
+    void clear()
+    {
+        m_slots.clear();
+        m_items.clear();
+    }
+
+private:
+    std::vector<int>        m_slots;    // index in `m_items` plus one, 0 if absent.
+    std::vector<value_type> m_items;
+};
+
+} // namespace xBacktest
+
+#endif // SYMBOL_TABLE_H
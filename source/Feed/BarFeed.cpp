@@ -8,14 +8,17 @@ namespace xBacktest
 
 BarFeed::BarFeed(int resolution, int maxLen)
 {
-	m_event.setType(Event::EvtNewBar);
     m_maxLen = maxLen;
 
     m_id = 0;
     m_dataStreamId = 0;
     m_instrument.clear();
+    m_instrumentId = 0;
     m_resolution = (Bar::Resolution)resolution;
     m_interval = 1;
+    m_storedBar = nullptr;
+    m_length = 0;
+    m_composerEnabled = false;
 }
 
 void BarFeed::setId(int id)
@@ -40,7 +43,8 @@ int BarFeed::getDataStreamId() const
 
 void BarFeed::setContract(const Contract& contract)
 {
-    m_contract = contract;
+    m_contract  = contract;
+    m_tickScale = Utils::TickScale(contract.fixedPrice ? contract.tickSize : 0);
 }
 
 const Contract& BarFeed::getContract() const
@@ -65,16 +69,18 @@ const string& BarFeed::getInstrument() const
 
 void BarFeed::setInstrument(const string& instrument)
 {
-    m_instrument = instrument;
+    m_instrument   = instrument;
+    m_instrumentId = SymbolTable::intern(instrument);
+}
+
+InstrumentId BarFeed::getInstrumentId() const
+{
+    return m_instrumentId;
 }
 
 void BarFeed::emitNewBar(const Bar& bar)
 {
-    BarEventCtx ctx;
-    ctx.dataStreamId = m_dataStreamId;
-    ctx.barFeedId    = m_id;
-    ctx.bar          = bar;
-    m_event.emit(m_lastBar.getDateTime(), &ctx);
+    m_event.emit(m_dataStreamId, m_id, bar);
 }
 
 bool BarFeed::enableComposer(const TradingSession& session, Bar::Resolution res, int interval)
@@ -86,24 +92,62 @@ bool BarFeed::enableComposer(const TradingSession& session, Bar::Resolution res,
     return true;
 }
 
+void BarFeed::roundPrices(Bar& bar) const
+{
+    if (!m_tickScale.isValid()) {
+        return;
+    }
+
+    bar.setOpen(m_tickScale.round(bar.getOpen()));
+    bar.setHigh(m_tickScale.round(bar.getHigh()));
+    bar.setLow(m_tickScale.round(bar.getLow()));
+    bar.setClose(m_tickScale.round(bar.getClose()));
+    if (bar.getResolution() == Bar::TICK) {
+        bar.setTickField(
+            m_tickScale.round(bar.getLastPrice()),
+            m_tickScale.round(bar.getBidPrice1()),
+            bar.getBidVolume1(),
+            m_tickScale.round(bar.getAskPrice1()),
+            bar.getAskVolume1());
+    }
+}
+
 bool BarFeed::dispatch()
 {
-    if (getNextBar(m_lastBar)) {
+    m_storedBar = nullptr;
 
-        m_lastBar.setResolution(getResolution());
-        m_lastBar.setInterval(getInterval());
+    // Stored bars are emitted as they are unless they have to be fixed up.
+    if (isStored() && !m_composerEnabled && !m_tickScale.isValid()) {
+        const Bar* bar = getNextStoredBar();
+        if (bar == nullptr) {
+            return false;
+        }
 
-        if (!m_composerEnabled) {
-            // Emit new bar directly.
-            emitNewBar(m_lastBar);
-        } else {
-            // Ask composer to do composition.
-            m_barComposer.pushNewBar(m_lastBar);
+        if (bar->getResolution() == getResolution() && bar->getInterval() == getInterval()) {
+            m_storedBar = bar;
+            emitNewBar(*bar);
+            return true;
         }
-        return true;
+
+        m_lastBar = *bar;
+    } else if (!getNextBar(m_lastBar)) {
+        return false;
+    }
+
+    m_lastBar.setResolution(getResolution());
+    m_lastBar.setInterval(getInterval());
+
+    roundPrices(m_lastBar);
+
+    if (!m_composerEnabled) {
+        // Emit new bar directly.
+        emitNewBar(m_lastBar);
+    } else {
+        // Ask composer to do composition.
+        m_barComposer.pushNewBar(m_lastBar);
     }
 
-    return false;
+    return true;
 }
 
 void BarFeed::setLength(int length)
@@ -166,19 +210,24 @@ int BarFeed::getInterval() const
     return m_interval;
 }
 
-Event& BarFeed::getNewBarEvent()
+BarFeed::NewBarEvent& BarFeed::getNewBarEvent()
 {
 	return m_event;
 }
 
 const Bar& BarFeed::getCurrentBar()
 {
-    return m_lastBar;
+    return m_storedBar != nullptr ? *m_storedBar : m_lastBar;
+}
+
+bool BarFeed::isCurrentBarStored() const
+{
+    return m_storedBar != nullptr;
 }
 
 Bar BarFeed::getLastBar() const
 {
-    return m_lastBar;
+    return m_storedBar != nullptr ? *m_storedBar : m_lastBar;
 }
 
 int BarFeed::loadData(
@@ -7,6 +7,7 @@
 #include "DataSeries.h"
 #include "BarSeries.h"
 #include "Composer.h"
+#include "Utils.h"
 
 namespace xBacktest
 {
@@ -21,11 +22,10 @@ namespace xBacktest
 class BarFeed : public Subject
 {
 public:
-    typedef struct {
-        int dataStreamId;
-        int barFeedId;
-        Bar bar;
-    } BarEventCtx;
+    // Handlers receive the data stream id, the feed id and the bar. The bar
+    // is owned by the feed and valid until the feed dispatches again unless
+    // isCurrentBarStored(), consumers copy it otherwise if they keep it.
+    typedef Signal<int, int, const Bar&> NewBarEvent;
 
     typedef struct {
         int   reqId;
@@ -74,6 +74,12 @@ public:
     // Override to return the next Bar in the feed or None if there are no bars.
     virtual bool getNextBar(Bar& outBar) = 0;
 
+    // Override if the feed keeps its bars in immutable storage shared by its
+    // clones, to return the next one in place or nullptr if there are no bars.
+    // Stored bars are dispatched without being copied.
+    virtual bool isStored() const { return false; }
+    virtual const Bar* getNextStoredBar() { return nullptr; }
+
     void setLength(int length);
 
     int  getLength() const;
@@ -100,21 +106,32 @@ public:
     // Returns the current bar.
     const Bar& getCurrentBar();
 
+    // Returns true if the current bar was dispatched from storage, it then
+    // stays valid after the feed dispatches again.
+    bool isCurrentBarStored() const;
+
 	// Returns the last Bar or None
 	Bar getLastBar() const;
 
-	Event& getNewBarEvent();
+	NewBarEvent& getNewBarEvent();
 
     // Returns the instrument.
     const string& getInstrument() const;
 
     void setInstrument(const string& instrument);
 
+    InstrumentId getInstrumentId() const;
+
     // Returns the Bar DataSeries.
     void getDataSeries();
 
+    // Move to the next bar and emit it.
     bool dispatch();
 
+    // Snap prices of `bar` to the tick grid if the contract is fixed-price,
+    // bars dispatched or loaded as historical data are all snapped.
+    void roundPrices(Bar& bar) const;
+
     void emitNewBar(const Bar& bar);
 
     bool enableComposer(const TradingSession& session, Bar::Resolution res, int interval = 1);
@@ -127,7 +144,7 @@ public:
         void (*callback)(const DateTime& datetime, void* context));
 
 private:
-    Event m_event;
+    NewBarEvent m_event;
     int   m_maxLen;
 
     int      m_id;    
@@ -139,10 +156,12 @@ private:
     string   m_name;
     // Instrument contained in this bar feed.
     string   m_instrument;
+    InstrumentId m_instrumentId;
     Bar::Resolution m_resolution;
     int      m_interval;
     
     Contract m_contract;
+    Utils::TickScale m_tickScale;   // valid if the contract is fixed-price.
 
     vector<TradablePeriod> m_tradablePeriods;
 
@@ -151,6 +170,7 @@ private:
     DateTime m_prevDateTime;
     DateTime m_currDateTime;
     Bar      m_lastBar;
+    const Bar* m_storedBar;  // current bar if dispatched from storage, or nullptr.
     int      m_length;
 
     bool     m_composerEnabled;
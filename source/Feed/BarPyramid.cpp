@@ -0,0 +1,373 @@
+#include <iostream>
+#include <algorithm>
+
+#include "Logger.h"
+#include "Errors.h"
+#include "DataStorage.h"
+#include "BarPyramid.h"
+
+namespace xBacktest
+{
+
+static const int SECONDS_PER_DAY = 24 * 60 * 60;
+
+////////////////////////////////////////////////////////////////////////////////
+BarPyramid::ComposedBarFeed::ComposedBarFeed(const string& instrument, int resolution, const shared_ptr<ComposedBars>& bars)
+    : BarFeed(resolution)
+{
+    setInstrument(instrument);
+    m_readIdx = 0;
+    m_bars    = bars;
+}
+
+bool BarPyramid::ComposedBarFeed::reset()
+{
+    m_readIdx = 0;
+    return true;
+}
+
+void BarPyramid::ComposedBarFeed::getBar(int idx, Bar& outBar) const
+{
+    const ComposedBars& bars = *m_bars;
+    outBar = Bar(getInstrumentId(),
+        DateTime(bars.timestamps[idx]),
+        bars.opens[idx],
+        bars.highs[idx],
+        bars.lows[idx],
+        bars.closes[idx],
+        bars.volumes[idx],
+        bars.openInts[idx],
+        getResolution());
+    outBar.setAmount(bars.amounts[idx]);
+}
+
+bool BarPyramid::ComposedBarFeed::getNextBar(Bar& outBar)
+{
+    if (m_readIdx < getLength()) {
+        getBar(m_readIdx, outBar);
+        m_readIdx++;
+        return true;
+    }
+
+    return false;
+}
+
+int BarPyramid::ComposedBarFeed::loadData(
+    int   reqId,
+    const DataRequest& request,
+    void* object,
+    void (*callback)(const DateTime& datetime, void* ctx))
+{
+    if (request.instrument != getInstrument()) {
+        return 0;
+    }
+
+    const int64* begin = m_bars->timestamps.data();
+    const int64* end = begin + getLength();
+    int64 to = request.to.ticks();
+
+    int first = 0;
+    int count = 0;
+    if (request.type == BarsBack) {
+        const int64* pos = std::lower_bound(begin, end, to);
+        int idx = pos - begin;
+        if (pos == end || *pos != to || idx <= request.count - 1) {
+            return 0;
+        }
+        first = idx - request.count;
+        count = request.count;
+    } else if (request.type == DateTimeRange) {
+        const int64* lower = std::lower_bound(begin, end, request.from.ticks());
+        const int64* upper = std::upper_bound(lower, end, to);
+        first = lower - begin;
+        count = upper - lower;
+        if (count <= 0) {
+            return 0;
+        }
+    } else {
+        return 0;
+    }
+
+    for (int i = first; i < first + count; i++) {
+        HistoricalDataContext ctx;
+        ctx.reqId        = reqId;
+        ctx.dataStreamId = getDataStreamId();
+        ctx.barFeedId    = getId();
+        ctx.object       = object;
+        getBar(i, ctx.bar);
+        roundPrices(ctx.bar);
+        callback(ctx.bar.getDateTime(), &ctx);
+    }
+
+    return count;
+}
+
+BarPyramid::ComposedBarFeed* BarPyramid::ComposedBarFeed::clone()
+{
+    ComposedBarFeed* feed = new BarPyramid::ComposedBarFeed(*this);
+    feed->reset();
+    feed->setId(DataStorage::getNextBarFeedId());
+
+    return feed;
+}
+
+const DateTime BarPyramid::ComposedBarFeed::peekDateTime() const
+{
+    return DateTime(m_bars->timestamps[m_readIdx]);
+}
+
+bool BarPyramid::ComposedBarFeed::eof()
+{
+    return m_readIdx >= getLength();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+BarPyramid::BarPyramid()
+{
+}
+
+BarPyramid::~BarPyramid()
+{
+    for (size_t i = 0; i < m_barFeeds.size(); i++) {
+        delete m_barFeeds[i];
+    }
+    m_barFeeds.clear();
+}
+
+bool BarPyramid::isComposable(int inResolution, int inInterval, int resolution, int interval)
+{
+    if (inResolution <= 0 || inResolution >= Bar::WEEK) {
+        return false;
+    }
+
+    if (resolution >= Bar::DAY) {
+        // Intraday slices never span two trading days.
+        if (inResolution < Bar::DAY) {
+            return true;
+        }
+        return interval > inInterval && interval % inInterval == 0;
+    }
+
+    if (inResolution >= Bar::DAY) {
+        return false;
+    }
+
+    int inPeriod = inResolution * inInterval;
+    int period = resolution * interval;
+    return period > inPeriod && period % inPeriod == 0;
+}
+
+void BarPyramid::initSliceRule(const TradingSession& session, int resolution, int interval, SliceRule& rule)
+{
+    rule.resolution    = resolution;
+    rule.interval      = interval;
+    rule.slicePeriod   = resolution * interval;
+    rule.sliceTotalNum = 0;
+    rule.overnight     = false;
+    rule.periods.clear();
+    rule.sliceNums.clear();
+
+    for (size_t i = 0; i < session.size(); i++) {
+        // HHMMSS to seconds of day.
+        TradablePeriod period;
+        period.begin = (session[i].begin / 10000) * 3600 + (session[i].begin % 10000) / 100 * 60 + session[i].begin % 100;
+        period.end   = (session[i].end / 10000) * 3600 + (session[i].end % 10000) / 100 * 60 + session[i].end % 100;
+        rule.periods.push_back(period);
+
+        long length = period.end - period.begin;
+        if (length < 0) {
+            length += SECONDS_PER_DAY;
+        }
+        int sliceNum = 1;
+        if (resolution < Bar::DAY) {
+            sliceNum = std::max<int>(1, (length + rule.slicePeriod - 1) / rule.slicePeriod);
+        }
+        rule.sliceNums.push_back(sliceNum);
+        rule.sliceTotalNum += sliceNum;
+    }
+
+    if (rule.periods.size() > 0) {
+        rule.overnight = rule.periods.front().begin > rule.periods.back().end;
+    }
+}
+
+bool BarPyramid::getSliceKey(const SliceRule& rule, int64 ticks, int64& key)
+{
+    int64 secs = ticks / 1000;
+    int64 day = secs / SECONDS_PER_DAY;
+    long sec = (long)(secs % SECONDS_PER_DAY);
+
+    if (rule.periods.size() == 0) {
+        if (rule.resolution >= Bar::DAY) {
+            key = day / rule.interval;
+        } else {
+            key = secs / rule.slicePeriod;
+        }
+        return true;
+    }
+
+    int sliceIdx = -1;
+    int prevSliceNum = 0;
+    for (size_t i = 0; i < rule.periods.size(); i++) {
+        const TradablePeriod& period = rule.periods[i];
+        long offset = -1;
+        if (period.begin <= period.end) {
+            if (sec >= period.begin && sec <= period.end) {
+                offset = sec - period.begin;
+            }
+        } else if (sec >= period.begin) {
+            offset = sec - period.begin;
+        } else if (sec <= period.end) {
+            offset = sec + SECONDS_PER_DAY - period.begin;
+        }
+
+        if (offset >= 0) {
+            sliceIdx = prevSliceNum;
+            if (rule.resolution < Bar::DAY) {
+                sliceIdx += std::min<int>(offset / rule.slicePeriod, rule.sliceNums[i] - 1);
+            }
+            break;
+        }
+        prevSliceNum += rule.sliceNums[i];
+    }
+
+    if (sliceIdx < 0) {
+        return false;
+    }
+
+    int64 tradingDay = day;
+    if (rule.overnight && sec >= rule.periods.front().begin) {
+        tradingDay++;
+    }
+
+    if (rule.resolution >= Bar::DAY) {
+        key = tradingDay / rule.interval;
+    } else {
+        key = tradingDay * rule.sliceTotalNum + sliceIdx;
+    }
+
+    return true;
+}
+
+BarPyramid::ComposedBarFeed* BarPyramid::composeBarFeed(BarFeed* source, const SliceRule& rule, int& skipped)
+{
+    shared_ptr<ComposedBars> bars = make_shared<ComposedBars>();
+    bool opened = false;
+    int64 currKey = 0;
+
+    Bar bar;
+    while (source->getNextBar(bar)) {
+        int64 ticks = bar.getDateTime().ticks();
+        int64 key;
+        if (!getSliceKey(rule, ticks, key)) {
+            skipped++;
+            continue;
+        }
+
+        if (!opened || key != currKey) {
+            bars->timestamps.push_back(ticks);
+            bars->opens.push_back(bar.getOpen());
+            bars->highs.push_back(bar.getHigh());
+            bars->lows.push_back(bar.getLow());
+            bars->closes.push_back(bar.getClose());
+            bars->volumes.push_back(bar.getVolume());
+            bars->openInts.push_back(bar.getOpenInt());
+            bars->amounts.push_back(bar.getAmount());
+            opened = true;
+            currKey = key;
+        } else {
+            size_t last = bars->timestamps.size() - 1;
+            bars->timestamps[last] = ticks;
+            if (bar.getHigh() > bars->highs[last]) {
+                bars->highs[last] = bar.getHigh();
+            }
+            if (bar.getLow() < bars->lows[last]) {
+                bars->lows[last] = bar.getLow();
+            }
+            bars->closes[last]   = bar.getClose();
+            bars->volumes[last] += bar.getVolume();
+            bars->openInts[last] = bar.getOpenInt();
+            bars->amounts[last] += bar.getAmount();
+        }
+    }
+
+    if (bars->timestamps.empty()) {
+        return nullptr;
+    }
+
+    ComposedBarFeed* feed = new BarPyramid::ComposedBarFeed(source->getInstrument(), rule.resolution, bars);
+    feed->setContract(source->getContract());
+    feed->setLength((int)bars->timestamps.size());
+    feed->setBeginDateTime(DateTime(bars->timestamps.front()));
+    feed->setEndDateTime(DateTime(bars->timestamps.back()));
+    feed->setResolution((Bar::Resolution)rule.resolution);
+    feed->setInterval(rule.interval);
+    for (auto& period : source->getTradablePeriods()) {
+        feed->addTradablePeriod(period.begin, period.end);
+    }
+
+    return feed;
+}
+
+bool BarPyramid::composeDataStream(const string& name, DataStream* source, const TradingSession& session, int resolution, int interval, DataStream* stream)
+{
+    Logger_Info() << "Composing data stream '" << name << "' from '" << source->getName() << "'...";
+
+    if (name.empty()) {
+        ASSERT(false, "Symbol(name) is empty.");
+    }
+
+    if (resolution != Bar::SECOND && resolution != Bar::MINUTE &&
+        resolution != Bar::HOUR && resolution != Bar::DAY) {
+        Logger_Err() << "Unsupported resolution of composed data stream '" << name << "'.";
+        return false;
+    }
+
+    if (interval <= 0 || !isComposable(source->getResolution(), source->getInterval(), resolution, interval)) {
+        Logger_Err() << "Data stream '" << name << "' can't be composed from '" << source->getName() << "'.";
+        return false;
+    }
+
+    SliceRule rule;
+    initSliceRule(session, resolution, interval, rule);
+
+    vector<BarFeed*> inputs;
+    source->cloneSharedBarFeed(inputs);
+
+    vector<ComposedBarFeed*> barFeeds;
+    int skipped = 0;
+    for (auto& input : inputs) {
+        ComposedBarFeed* feed = composeBarFeed(input, rule, skipped);
+        if (feed != nullptr) {
+            feed->setName(name);
+            barFeeds.push_back(feed);
+        }
+        delete input;
+    }
+
+    if (skipped > 0) {
+        Logger_Info() << skipped << (skipped <= 1 ? " bar is" : " bars are") << " outside of trading session.";
+    }
+
+    stream->setCommonContract(source->getCommonContract());
+    stream->setName(name);
+    stream->setResolution(resolution);
+    stream->setInterval(interval);
+    for (auto& feed : barFeeds) {
+        stream->insertBarFeed(feed);
+    }
+
+    {
+        Utils::Lock lock(m_mutex);
+        for (auto& feed : barFeeds) {
+            m_barFeeds.push_back(feed);
+        }
+    }
+
+    int size = barFeeds.size();
+    Logger_Info() << "Construct " << size << (size <= 1 ? " barfeed." : " barfeeds.");
+
+    return size > 0;
+}
+
+} // namespace xBacktest
@@ -0,0 +1,104 @@
+#ifndef BAR_PYRAMID_H
+#define BAR_PYRAMID_H
+
+#include <memory>
+
+#include "BarFeed.h"
+#include "Lock.h"
+
+namespace xBacktest
+{
+
+class DataStream;
+
+////////////////////////////////////////////////////////////////////////////////
+// Composes bars of a higher resolution out of a loaded data stream once at
+// load time. Composed bars are kept in memory and shared by every executor,
+// just like feeds mapped from a file.
+//
+// Slicing follows BarComposer: trading time of a day is cut into slices of
+// `interval` * `resolution` seconds, counted from the beginning of every
+// period of the session, and a bar at the end of a period belongs to its
+// last slice. Without a session slices are aligned to the wall clock.
+// Daily bars cover one trading day, when the session opens in the evening
+// (first period begins after the last one ends) bars at or after the opening
+// belong to the next day. Bars outside of the session are skipped.
+//
+// A composed bar takes the time of its last input bar, it is dispatched once
+// its slice is complete and never ahead of the input bars.
+class BarPyramid
+{
+public:
+    // Composed bars of one instrument, shared by clones of a feed.
+    typedef struct {
+        vector<int64>     timestamps;
+        vector<double>    opens;
+        vector<double>    highs;
+        vector<double>    lows;
+        vector<double>    closes;
+        vector<long long> volumes;
+        vector<long long> openInts;
+        vector<double>    amounts;
+    } ComposedBars;
+
+    class ComposedBarFeed : public BarFeed
+    {
+        friend class BarPyramid;
+    public:
+        bool reset();
+        bool getNextBar(Bar& outBar);
+        bool isRealTime() { return false; }
+        const DateTime peekDateTime() const;
+        bool eof();
+        int loadData(int   reqId,
+            const DataRequest& request,
+            void* object,
+            void(*callback)(const DateTime& datetime, void* ctx));
+        ComposedBarFeed* clone();
+
+    private:
+        ComposedBarFeed(const string& instrument, int resolution, const shared_ptr<ComposedBars>& bars);
+        void getBar(int idx, Bar& outBar) const;
+
+    private:
+        int m_readIdx;
+        shared_ptr<ComposedBars> m_bars;
+    };
+
+    BarPyramid();
+    ~BarPyramid();
+
+    // Safe to call concurrently. Compose every feed of `source` into bars of
+    // `resolution` and `interval`, ids of the stream and feeds are left unset.
+    bool composeDataStream(const string& name, DataStream* source, const TradingSession& session, int resolution, int interval, DataStream* stream);
+
+    // Whether every slice of `resolution`/`interval` is made of whole slices
+    // of `inResolution`/`inInterval` under the same session.
+    static bool isComposable(int inResolution, int inInterval, int resolution, int interval);
+
+private:
+    typedef struct {
+        vector<TradablePeriod> periods;     // seconds of day.
+        vector<int>            sliceNums;   // slices of every period.
+        int                    sliceTotalNum;
+        int                    slicePeriod; // in seconds, intraday only.
+        int                    resolution;
+        int                    interval;
+        bool                   overnight;
+    } SliceRule;
+
+    static void initSliceRule(const TradingSession& session, int resolution, int interval, SliceRule& rule);
+    // Key of the slice `ticks` falls in, keys grow with time. Returns false
+    // if it's outside of the session.
+    static bool getSliceKey(const SliceRule& rule, int64 ticks, int64& key);
+    // Walk through `source` once, returns nullptr if no bar is composed.
+    ComposedBarFeed* composeBarFeed(BarFeed* source, const SliceRule& rule, int& skipped);
+
+private:
+    Utils::Mutex m_mutex;
+    vector<ComposedBarFeed*> m_barFeeds;
+};
+
+} // namespace xBacktest
+
+#endif // BAR_PYRAMID_H
@@ -26,14 +26,14 @@ bool BaseFeed::dispatch()
     FeedValue value;
     if (getNextValue(value)) {
         updateDataSeries(value.datetime, value.data);
-        m_event.emit(value.datetime, value.data);
+        m_event.emit(value);
         return true;
     }
 
     return false;
 }
 
-Event& BaseFeed::getNewValuesEvent()
+BaseFeed::NewValuesEvent& BaseFeed::getNewValuesEvent()
 {
 	return m_event;
 }
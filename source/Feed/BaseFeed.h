@@ -33,6 +33,8 @@ typedef struct _FeedValue
 class BaseFeed : public Subject
 {
 public:
+    typedef Signal<const FeedValue&> NewValuesEvent;
+
     BaseFeed(int maxLen);
 	virtual ~BaseFeed();
 
@@ -46,12 +48,12 @@ public:
     virtual bool getNextValue(FeedValue& outValue) = 0;
 
 	// Returns the event that will be emitted when new values are available.
-    Event& getNewValuesEvent();
+    NewValuesEvent& getNewValuesEvent();
 
 	virtual bool dispatch();
 
 protected:
-    Event m_event;
+    NewValuesEvent m_event;
     int m_maxLen;
 };
 
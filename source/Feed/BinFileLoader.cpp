@@ -1,4 +1,6 @@
 #include <iostream>
+#include <fstream>
+#include <algorithm>
 #include <boost/filesystem.hpp>
 #include "Logger.h"
 #include "BinFileLoader.h"
@@ -7,18 +9,33 @@
 namespace xBacktest
 {
 
+static const char BIN_INDEX_MAGIC[8] = "XBTIDX1";
+// Version 2: periods split on rows with a negative hot flag.
+static const uint32_t BIN_INDEX_VERSION = 2;
+
+static string getIndexFileName(const string& file)
+{
+    return file + ".idx";
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 BinFileLoader::BinFileBarFeed::BinFileBarFeed(
         const string& instrument, 
         int resolution,
         BinFileItem* begin,
-        BinFileItem* end)
+        BinFileItem* end,
+        const shared_ptr<TimestampColumn>& timestamps,
+        const int64* times)
     : BarFeed(resolution)
 {
     setInstrument(instrument);
     m_readIdx = 0;
     m_begin = begin;
     m_end = end;
+    m_timestamps = timestamps;
+    m_times = times;
+    m_fileBegin = 0;
+    m_windowItems = 0;
 }
 
 bool BinFileLoader::BinFileBarFeed::reset()
@@ -27,31 +44,136 @@ bool BinFileLoader::BinFileBarFeed::reset()
     return true;
 }
 
+bool BinFileLoader::BinFileBarFeed::readItems(int begin, int num, BinFileItem* items) const
+{
+    return m_reader->Read((uint64_t)(m_fileBegin + begin) * sizeof(BinFileItem), items, num * sizeof(BinFileItem));
+}
+
+void BinFileLoader::BinFileBarFeed::prefetch(int begin)
+{
+    StreamWindow& window = *m_window;
+    if (begin >= getLength()) {
+        return;
+    }
+
+    int back = 1 - window.front;
+    int num = std::min(m_windowItems, getLength() - begin);
+    window.backBegin   = begin;
+    window.backNum     = num;
+    window.backValid   = false;
+    window.backPending = true;
+
+    // The task holds the window and the reader, the feed may be deleted
+    // before the read completes.
+    shared_ptr<StreamWindow> holder = m_window;
+    shared_ptr<Utils::FileReader> reader = m_reader;
+    uint64_t offset = (uint64_t)(m_fileBegin + begin) * sizeof(BinFileItem);
+    BinFileItem* dest = window.buffers[back].data();
+    m_ioThread->Submit([holder, reader, offset, dest, num]() {
+        bool valid = reader->Read(offset, dest, num * sizeof(BinFileItem));
+
+        Utils::Lock lock(holder->monitor.GetMutex());
+        holder->backValid = valid;
+        holder->backPending = false;
+        holder->monitor.PulseAll();
+    });
+}
+
+const BinFileLoader::BinFileItem& BinFileLoader::BinFileBarFeed::fetchItem(int idx)
+{
+    if (m_window == nullptr) {
+        m_window = make_shared<StreamWindow>();
+        m_window->buffers[0].resize(m_windowItems);
+        m_window->buffers[1].resize(m_windowItems);
+        m_window->front       = 0;
+        m_window->frontBegin  = 0;
+        m_window->frontNum    = 0;
+        m_window->backBegin   = 0;
+        m_window->backNum     = 0;
+        m_window->backPending = false;
+        m_window->backValid   = false;
+    }
+
+    StreamWindow& window = *m_window;
+    if (idx >= window.frontBegin && idx < window.frontBegin + window.frontNum) {
+        return window.buffers[window.front][idx - window.frontBegin];
+    }
+
+    {
+        Utils::Lock lock(window.monitor.GetMutex());
+        while (window.backPending) {
+            window.monitor.Wait(lock);
+        }
+    }
+
+    if (window.backValid && idx >= window.backBegin && idx < window.backBegin + window.backNum) {
+        window.front      = 1 - window.front;
+        window.frontBegin = window.backBegin;
+        window.frontNum   = window.backNum;
+    } else {
+        // First read, or the read position jumped out of the window.
+        int num = std::min(m_windowItems, getLength() - idx);
+        ASSERT(readItems(idx, num, window.buffers[window.front].data()),
+               "Failed to read " << num << " items of " << getInstrument() << ".");
+        window.frontBegin = idx;
+        window.frontNum   = num;
+    }
+
+    // The consumed buffer is reused for the next window, memory of a feed
+    // stays at two windows however long it is.
+    prefetch(window.frontBegin + window.frontNum);
+
+    return window.buffers[window.front][idx - window.frontBegin];
+}
+
 bool BinFileLoader::BinFileBarFeed::getNextBar(Bar& outBar)
 {
     if (m_readIdx < getLength()) {
-        DateTime dt = BinFileLoader::getDateTime(m_begin[m_readIdx].date, m_begin[m_readIdx].time);
+        DateTime dt(m_times[m_readIdx]);
+        const BinFileItem& item = isStreaming() ? fetchItem(m_readIdx) : m_begin[m_readIdx];
 
-        Bar bar(m_begin[m_readIdx].instrument,
+        outBar = Bar(getInstrumentId(),
             dt,
-            m_begin[m_readIdx].open,
-            m_begin[m_readIdx].high,
-            m_begin[m_readIdx].low,
-            m_begin[m_readIdx].close,
-            m_begin[m_readIdx].volume,
-            m_begin[m_readIdx].openInt,
+            item.open,
+            item.high,
+            item.low,
+            item.close,
+            item.volume,
+            item.openInt,
             getResolution());
 
         m_readIdx++;
 
-        outBar = bar;
-
         return true;
     }
 
     return false;
 }
 
+int BinFileLoader::BinFileBarFeed::findItem(const DateTime& datetime) const
+{
+    int64 ticks = datetime.ticks();
+    const int64* end = m_times + getLength();
+    const int64* pos = std::lower_bound(m_times, end, ticks);
+    if (pos == end || *pos != ticks) {
+        return -1;
+    }
+
+    return pos - m_times;
+}
+
+int BinFileLoader::BinFileBarFeed::getRange(const DateTime& from, const DateTime& to, BinFileItem*& begin, const int64*& times) const
+{
+    const int64* end = m_times + getLength();
+    const int64* first = std::lower_bound(m_times, end, from.ticks());
+    const int64* last = std::upper_bound(first, end, to.ticks());
+
+    begin = isStreaming() ? nullptr : m_begin + (first - m_times);
+    times = first;
+
+    return last - first;
+}
+
 int BinFileLoader::BinFileBarFeed::loadData(
     int   reqId,
     const DataRequest& request,
@@ -62,59 +184,70 @@ int BinFileLoader::BinFileBarFeed::loadData(
         return 0;
     }
 
-    int ret = 0;
-    
-    BinFileItem* item = m_begin;
-    for ( ;
-        item != m_end;
-        item++) {
-        DateTime dt = BinFileLoader::getDateTime(item->date, item->time);
-        if (dt == request.to) {
-            break;
-        }
-    }
-    if (item == m_end) {
-        return 0;
-    }
+    BinFileItem* begin = nullptr;
+    const int64* times = nullptr;
+    int count = 0;
 
     if (request.type == BarsBack) {
-        if (item - m_begin <= request.count - 1) {
+        int idx = findItem(request.to);
+        if (idx < 0 || idx <= request.count - 1) {
             return 0;
         }
 
-        BinFileItem* from = item - request.count;
-        while (from != item) {
-            DateTime dt = BinFileLoader::getDateTime(from->date, from->time);
-            Bar bar(item->instrument, 
-                dt,
-                item->open,
-                item->high,
-                item->low,
-                item->close,
-                item->volume,
-                item->openInt,
-                getResolution());
-
-            HistoricalDataContext ctx;
-            ctx.dataStreamId = getDataStreamId();
-            ctx.barFeedId    = getId();
-            ctx.object       = object;
-            ctx.bar          = bar;
-            callback(dt, &ctx);
-            from++;
+        if (!isStreaming()) {
+            begin = m_begin + idx - request.count;
+        }
+        times = m_times + idx - request.count;
+        count = request.count;
+    } else if (request.type == DateTimeRange) {
+        count = getRange(request.from, request.to, begin, times);
+        if (count <= 0) {
+            return 0;
         }
-        return request.count;
     } else {
-        // Not supported yet.
         return 0;
     }
 
-    return 0;
+    // Read requested items directly, the window keeps serving the dispatcher.
+    vector<BinFileItem> items;
+    if (isStreaming()) {
+        items.resize(count);
+        if (!readItems(times - m_times, count, items.data())) {
+            Logger_Err() << "Failed to read " << count << " items of " << getInstrument() << ".";
+            return 0;
+        }
+        begin = items.data();
+    }
+
+    for (int i = 0; i < count; i++) {
+        DateTime dt(times[i]);
+        Bar bar(getInstrumentId(),
+            dt,
+            begin[i].open,
+            begin[i].high,
+            begin[i].low,
+            begin[i].close,
+            begin[i].volume,
+            begin[i].openInt,
+            getResolution());
+
+        HistoricalDataContext ctx;
+        ctx.reqId        = reqId;
+        ctx.dataStreamId = getDataStreamId();
+        ctx.barFeedId    = getId();
+        ctx.object       = object;
+        ctx.bar          = bar;
+        roundPrices(ctx.bar);
+        callback(dt, &ctx);
+    }
+
+    return count;
 }
 
 BinFileLoader::BinFileBarFeed* BinFileLoader::BinFileBarFeed::clone()
 {
     BinFileBarFeed* feed = new BinFileLoader::BinFileBarFeed(*this);
+    feed->m_window = nullptr;
     feed->reset();
     feed->setId(DataStorage::getNextBarFeedId());
 
@@ -123,7 +256,7 @@ BinFileLoader::BinFileBarFeed* BinFileLoader::BinFileBarFeed::clone()
 
 const DateTime BinFileLoader::BinFileBarFeed::peekDateTime() const
 {
-    return BinFileLoader::getDateTime(m_begin[m_readIdx].date, m_begin[m_readIdx].time);
+    return DateTime(m_times[m_readIdx]);
 }
 
 bool BinFileLoader::BinFileBarFeed::eof()
@@ -135,6 +268,17 @@ bool BinFileLoader::BinFileBarFeed::eof()
 BinFileLoader::BinFileLoader()
 {
     m_dataStreamDescs.clear();
+    m_streamingWindow = 0;
+}
+
+void BinFileLoader::setStreamingWindow(int items)
+{
+    m_streamingWindow = items;
+}
+
+int BinFileLoader::getStreamingWindow() const
+{
+    return m_streamingWindow;
 }
 
 BinFileLoader::~BinFileLoader()
@@ -145,13 +289,19 @@ BinFileLoader::~BinFileLoader()
     m_barFeeds.clear();
 
     for (size_t i = 0; i < m_dataStreamDescs.size(); i++) {
-        m_dataStreamDescs[i].mappedFile->close();
+        if (m_dataStreamDescs[i].mappedFile->is_open()) {
+            m_dataStreamDescs[i].mappedFile->close();
+        }
         delete m_dataStreamDescs[i].mappedFile;
+        if (m_dataStreamDescs[i].mappedIndex != nullptr) {
+            m_dataStreamDescs[i].mappedIndex->close();
+            delete m_dataStreamDescs[i].mappedIndex;
+        }
     }
     m_dataStreamDescs.clear();
 }
 
-bool BinFileLoader::loadBinFile(const string& name, int resolution, int interval, const string& file, const Contract& contract, DataStream* stream)
+bool BinFileLoader::loadBinFile(const string& name, int resolution, int interval, const string& file, const Contract& contract, const DataRange& range, DataStream* stream)
 {
     Logger_Info() << "Loading binary file '" << file << "'...";
 
@@ -159,21 +309,25 @@ bool BinFileLoader::loadBinFile(const string& name, int resolution, int interval
         ASSERT(false, "Symbol(name) is empty.");
     }
 
-    for (size_t i = 0; i < m_dataStreamDescs.size(); i++) {
-        if (m_dataStreamDescs[i].name == name && 
-            m_dataStreamDescs[i].resolution == resolution &&
-            m_dataStreamDescs[i].interval == interval) {
-            return false;
+    {
+        Utils::Lock lock(m_mutex);
+        for (size_t i = 0; i < m_dataStreamDescs.size(); i++) {
+            if (m_dataStreamDescs[i].name == name && 
+                m_dataStreamDescs[i].resolution == resolution &&
+                m_dataStreamDescs[i].interval == interval) {
+                return false;
+            }
         }
     }
     
     BinStreamDesc desc;
-    desc.id         = DataStorage::getNextDataStreamId();
     desc.name       = name;
     desc.resolution = resolution;
     desc.interval   = interval;
     desc.file       = file;
     desc.contract   = contract;
+    desc.mappedIndex = nullptr;
+    desc.times      = nullptr;
 
     try {
         boost::iostreams::mapped_file_source* mappedFile = new boost::iostreams::mapped_file_source();
@@ -192,13 +346,23 @@ bool BinFileLoader::loadBinFile(const string& name, int resolution, int interval
         return false;
     }
 
-    m_dataStreamDescs.push_back(desc);
-
     vector<BinFileBarFeed*> barFeeds;
-    scanBarFeeds(barFeeds, desc, contract);
+    if (!loadIndex(barFeeds, desc, contract)) {
+        decodeTimestamps(desc);
+        if (scanBarFeeds(barFeeds, desc, contract) > 0) {
+            writeIndex(barFeeds, desc, contract);
+        }
+    }
+
+    if (!range.isAll()) {
+        sliceBarFeeds(barFeeds, desc, contract, range);
+    }
+
+    if (m_streamingWindow > 0 && barFeeds.size() > 0) {
+        enableStreaming(barFeeds, desc);
+    }
 
     stream->setCommonContract(contract);
-    stream->setId(desc.id);
     stream->setName(name);
     stream->setResolution(resolution);
     stream->setInterval(interval);
@@ -206,109 +370,314 @@ bool BinFileLoader::loadBinFile(const string& name, int resolution, int interval
         stream->insertBarFeed(feed);
     }
 
-    m_barFeeds.insert(m_barFeeds.end(), barFeeds.begin(), barFeeds.end());
+    {
+        Utils::Lock lock(m_mutex);
+        m_dataStreamDescs.push_back(desc);
+        m_barFeeds.insert(m_barFeeds.end(), barFeeds.begin(), barFeeds.end());
+    }
 
     return (barFeeds.size() > 0);
 }
 
-bool BinFileLoader::checkTimeline(BinFileBarFeed* feed)
+bool BinFileLoader::enableStreaming(vector<BinFileBarFeed*>& feeds, BinStreamDesc& desc)
 {
-    BinFileItem* begin = feed->m_begin;
-    BinFileItem* end = feed->m_end;
-    DateTime lastDt = BinFileLoader::getDateTime(begin->date, begin->time);
+    shared_ptr<Utils::FileReader> reader = make_shared<Utils::FileReader>(desc.file);
+    if (!reader->IsOpen()) {
+        Logger_Info() << "Can't open '" << desc.file << "' for streaming, keep it mapped.";
+        return false;
+    }
 
-    int idx = 0;
-    // Ending item is also available.
-    while (begin <= end) {
-        // check timeline
-        DateTime dt = BinFileLoader::getDateTime(begin->date, begin->time);
-        if (dt < lastDt) {
-            char str[256];
-            sprintf(str, "\r\nTimeline wrap back, please verify the correctness of your input data."
-                         "\r\nFeed:     %s"
-                         "\r\nIndex:    %d"
-                         "\r\nPrevious: %s" 
-                         "\r\nCurrent:  %s",
-                feed->getInstrument().c_str(),
-                idx,
-                lastDt.toString().c_str(),
-                dt.toString().c_str());
-            Logger_Err() << str;
-            exit(-1);
+    shared_ptr<Utils::ThreadPool> ioThread;
+    {
+        Utils::Lock lock(m_mutex);
+        if (m_ioThread == nullptr) {
+            m_ioThread = make_shared<Utils::ThreadPool>(1);
+        }
+        ioThread = m_ioThread;
+    }
+
+    for (auto& feed : feeds) {
+        feed->m_begin       = nullptr;
+        feed->m_end         = nullptr;
+        feed->m_reader      = reader;
+        feed->m_ioThread    = ioThread;
+        feed->m_windowItems = m_streamingWindow;
+    }
+
+    // Timestamps stay in the index or the decoded column, items are only
+    // read through windows from now on.
+    desc.reader = reader;
+    desc.mappedFile->close();
+    desc.begin = nullptr;
+    desc.end = nullptr;
+
+    Logger_Info() << "Stream '" << desc.file << "' through windows of " << m_streamingWindow << " items.";
+
+    return true;
+}
+
+void BinFileLoader::decodeTimestamps(BinStreamDesc& desc)
+{
+    Logger_Info() << "Decode timestamps...";
+
+    size_t itemNum = desc.end - desc.begin;
+    desc.timestamps = make_shared<TimestampColumn>(itemNum);
+    TimestampColumn& column = *desc.timestamps;
+
+    // Items of one trading day share the same date, so only convert the
+    // date part once per day.
+    uint32_t lastDate = 0;
+    int64 dayTicks = 0;
+    for (size_t i = 0; i < itemNum; i++) {
+        const BinFileItem& item = desc.begin[i];
+        if (item.date != lastDate) {
+            lastDate = item.date;
+            dayTicks = BinFileLoader::getDateTime(item.date, 0).ticks();
+        }
+        column[i] = dayTicks + getTimeOfDayTicks(item.time);
+    }
+
+    desc.times = column.data();
+}
+
+BinFileLoader::BinFileBarFeed* BinFileLoader::createBarFeed(BinStreamDesc& desc, const Contract& contract, const string& instrument, int begin, int length)
+{
+    BinFileBarFeed* barFeed = new BinFileLoader::BinFileBarFeed(
+                                        instrument,
+                                        desc.resolution,
+                                        desc.begin + begin,
+                                        desc.begin + begin + length - 1,
+                                        desc.timestamps,
+                                        desc.times + begin
+                                        );
+    barFeed->m_fileBegin = begin;
+    Contract c = contract;
+    strncpy(c.instrument, instrument.c_str(), sizeof(c.instrument));
+    barFeed->setContract(c);
+    barFeed->setName(desc.name);
+    barFeed->setLength(length);
+    barFeed->setBeginDateTime(DateTime(desc.times[begin]));
+    barFeed->setEndDateTime(DateTime(desc.times[begin + length - 1]));
+    barFeed->setResolution((Bar::Resolution)desc.resolution);
+    barFeed->setInterval(desc.interval);
+
+    return barFeed;
+}
+
+bool BinFileLoader::loadIndex(vector<BinFileBarFeed*>& feeds, BinStreamDesc& desc, const Contract& contract)
+{
+    feeds.clear();
+
+    string indexFile = getIndexFileName(desc.file);
+    boost::iostreams::mapped_file_source* mappedIndex = nullptr;
+    try {
+        if (!boost::filesystem::exists(indexFile)) {
             return false;
         }
 
-        // check price
-        if (begin->open <= 0.0 || 
-            begin->high <= 0.0 || 
-            begin->low <= 0.0 ||
-            begin->close <= 0.0 || 
-            begin->high < begin->low) {
-            char str[256];
-            sprintf(str, "\r\nAbnormal price, please verify the correctness of your input data."
-                "\r\nFeed:     %s"
-                "\r\nIndex:    %d"
-                "\r\nDateTime: %s"
-                "\r\nPrice:    %0.2f, %0.2f, %0.2f, %0.2f",
-                feed->getInstrument().c_str(),
-                idx,
-                dt.toString().c_str(),
-                begin->open, begin->high, begin->low, begin->close);
-            Logger_Err() << str;
-            exit(-1);
+        uint64_t fileSize = desc.mappedFile->size();
+        int64_t modifyTime = boost::filesystem::last_write_time(desc.file);
+
+        mappedIndex = new boost::iostreams::mapped_file_source();
+        mappedIndex->open(indexFile);
+        if (!mappedIndex->is_open() || mappedIndex->size() < sizeof(BinIndexHeader)) {
+            delete mappedIndex;
             return false;
         }
 
-        lastDt = dt;
-        begin++;
-        idx++;
+        const char* base = mappedIndex->data();
+        const BinIndexHeader* header = (const BinIndexHeader*)base;
+        uint64_t periodOffset = sizeof(BinIndexHeader) + header->segmentNum * sizeof(BinIndexSegment);
+        if (memcmp(header->magic, BIN_INDEX_MAGIC, sizeof(header->magic)) != 0 ||
+            header->version != BIN_INDEX_VERSION ||
+            header->closeTime != contract.closeTime ||
+            header->fileSize != fileSize ||
+            header->modifyTime != modifyTime ||
+            header->itemNum != fileSize / sizeof(BinFileItem) ||
+            header->segmentNum == 0 ||
+            periodOffset + header->periodNum * sizeof(BinIndexPeriod) > header->timestampOffset ||
+            header->timestampOffset + header->itemNum * sizeof(int64) > mappedIndex->size()) {
+            Logger_Info() << "Index file '" << indexFile << "' is out of date.";
+            mappedIndex->close();
+            delete mappedIndex;
+            return false;
+        }
+
+        const BinIndexSegment* segments = (const BinIndexSegment*)(base + sizeof(BinIndexHeader));
+        const BinIndexPeriod* periods = (const BinIndexPeriod*)(base + periodOffset);
+        for (uint32_t i = 0; i < header->segmentNum; i++) {
+            if (segments[i].length == 0 ||
+                segments[i].begin + segments[i].length > header->itemNum ||
+                segments[i].periodBegin + segments[i].periodNum > header->periodNum) {
+                Logger_Info() << "Index file '" << indexFile << "' is corrupted.";
+                mappedIndex->close();
+                delete mappedIndex;
+                return false;
+            }
+        }
+
+        Logger_Info() << "Load index file '" << indexFile << "'...";
+
+        desc.mappedIndex = mappedIndex;
+        desc.times = (const int64*)(base + header->timestampOffset);
+
+        int periodCount = 0;
+        for (uint32_t i = 0; i < header->segmentNum; i++) {
+            const BinIndexSegment& segment = segments[i];
+            string instrument(segment.instrument, strnlen(segment.instrument, sizeof(segment.instrument)));
+            BinFileBarFeed* barFeed = createBarFeed(desc, contract, instrument, (int)segment.begin, (int)segment.length);
+            for (uint32_t j = 0; j < segment.periodNum; j++) {
+                const BinIndexPeriod& period = periods[segment.periodBegin + j];
+                barFeed->addTradablePeriod(DateTime(period.begin), DateTime(period.end));
+            }
+            periodCount += segment.periodNum;
+            feeds.push_back(barFeed);
+        }
+
+        int size = feeds.size();
+
+        Logger_Info() << "Construct " << size << (size <= 1 ? " barfeed, " : " barfeeds, ") << periodCount << " tradable " << ( periodCount > 1 ? "periods." : "period.");
+    } catch (exception &e) {
+        Logger_Info() << "Failed to load index file '" << indexFile << "': " << e.what();
+        for (auto& feed : feeds) {
+            delete feed;
+        }
+        feeds.clear();
+        if (desc.mappedIndex == nullptr) {
+            delete mappedIndex;
+        }
+        return false;
     }
 
     return true;
 }
 
+bool BinFileLoader::writeIndex(const vector<BinFileBarFeed*>& feeds, const BinStreamDesc& desc, const Contract& contract)
+{
+    string indexFile = getIndexFileName(desc.file);
+    // Streams sharing a file may be loaded concurrently.
+    string tempFile = indexFile + "." + boost::filesystem::unique_path().string() + ".tmp";
+
+    try {
+        vector<BinIndexSegment> segments;
+        vector<BinIndexPeriod> periods;
+        for (auto& feed : feeds) {
+            BinIndexSegment segment;
+            memset(&segment, 0, sizeof(segment));
+            strncpy(segment.instrument, feed->getInstrument().c_str(), sizeof(segment.instrument) - 1);
+            segment.begin       = feed->m_begin - desc.begin;
+            segment.length      = feed->getLength();
+            segment.beginTicks  = feed->getBeginDateTime().ticks();
+            segment.endTicks    = feed->getEndDateTime().ticks();
+            segment.periodBegin = periods.size();
+            for (auto& period : feed->getTradablePeriods()) {
+                periods.push_back({ period.begin.ticks(), period.end.ticks() });
+            }
+            segment.periodNum   = periods.size() - segment.periodBegin;
+            segments.push_back(segment);
+        }
+
+        BinIndexHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, BIN_INDEX_MAGIC, sizeof(header.magic));
+        header.version         = BIN_INDEX_VERSION;
+        header.closeTime       = contract.closeTime;
+        header.fileSize        = desc.mappedFile->size();
+        header.modifyTime      = boost::filesystem::last_write_time(desc.file);
+        header.itemNum         = desc.end - desc.begin;
+        header.segmentNum      = segments.size();
+        header.periodNum       = periods.size();
+        header.timestampOffset = sizeof(BinIndexHeader) +
+                                 segments.size() * sizeof(BinIndexSegment) +
+                                 periods.size() * sizeof(BinIndexPeriod);
+
+        ofstream out(tempFile.c_str(), ios::out | ios::binary | ios::trunc);
+        if (!out.is_open()) {
+            Logger_Info() << "Can't create index file '" << indexFile << "'.";
+            return false;
+        }
+
+        out.write((const char*)&header, sizeof(header));
+        out.write((const char*)segments.data(), segments.size() * sizeof(BinIndexSegment));
+        out.write((const char*)periods.data(), periods.size() * sizeof(BinIndexPeriod));
+        out.write((const char*)desc.times, header.itemNum * sizeof(int64));
+        out.close();
+        if (out.fail()) {
+            boost::filesystem::remove(tempFile);
+            return false;
+        }
+
+        boost::filesystem::rename(tempFile, indexFile);
+    } catch (exception &e) {
+        Logger_Info() << "Failed to write index file '" << indexFile << "': " << e.what();
+        boost::system::error_code ec;
+        boost::filesystem::remove(tempFile, ec);
+        return false;
+    }
+
+    Logger_Info() << "Write index file '" << indexFile << "'.";
+
+    return true;
+}
+
+void BinFileLoader::checkTimeline(BinFileBarFeed* feed, DataDiagnostics& diagnostics)
+{
+    const BinFileItem* items = feed->m_begin;
+    const int64* times = feed->m_times;
+    const string& instrument = feed->getInstrument();
+
+    for (int idx = 0; idx < feed->getLength(); idx++) {
+        const BinFileItem& item = items[idx];
+        diagnostics.checkRow(instrument, idx, times[idx], idx > 0 ? times[idx - 1] : 0,
+                             item.open, item.high, item.low, item.close);
+    }
+}
+
 int BinFileLoader::scanTradablePeriod(BinFileBarFeed* feed)
 {
     BinFileItem* begin = feed->m_begin;
     BinFileItem* end = feed->m_end;
-    DateTime startDT = BinFileLoader::getDateTime(begin->date, begin->time);
+    const int64* times = feed->m_times;
+    DateTime startDT(times[0]);
     DateTime endDT = startDT;
     int closeTime = feed->getContract().closeTime;
     // tradable period end at contract's close time.
     if (begin->time > closeTime) {
-        endDT = BinFileLoader::getDateTime(begin->date, closeTime);
+        endDT = DateTime(replaceTimeOfDay(times[0], closeTime));
     }
     
-    int lastHotFlag = begin->hot;
+    int lastHotFlag = (int32_t)begin->hot;
     int count = 0;
+    int idx = 0;
 
     while (begin != end) {
-        if (begin->hot < 0) {
+        if ((int32_t)begin->hot < 0) {
             if (lastHotFlag >= 0) {
                 feed->addTradablePeriod(startDT, endDT);
                 count++;
             }
-            startDT = BinFileLoader::getDateTime(begin->date, begin->time);
+            startDT = DateTime(times[idx]);
         } else {
             if (lastHotFlag < 0) {
-                startDT = BinFileLoader::getDateTime(begin->date, begin->time);
+                startDT = DateTime(times[idx]);
             }
             if (begin->time > closeTime) {
-                endDT = BinFileLoader::getDateTime(begin->date, closeTime);
+                endDT = DateTime(replaceTimeOfDay(times[idx], closeTime));
             } else {
-                endDT = BinFileLoader::getDateTime(begin->date, begin->time);
+                endDT = DateTime(times[idx]);
             }
         }
 
-        lastHotFlag = begin->hot;
+        lastHotFlag = (int32_t)begin->hot;
         begin++;
+        idx++;
     }
 
-    if (begin->hot >= 0) {
+    if ((int32_t)begin->hot >= 0) {
         if (begin->time > closeTime) {
-            endDT = BinFileLoader::getDateTime(begin->date, closeTime);
+            endDT = DateTime(replaceTimeOfDay(times[idx], closeTime));
         } else {
-            endDT = BinFileLoader::getDateTime(begin->date, begin->time);
+            endDT = DateTime(times[idx]);
         }
         feed->addTradablePeriod(startDT, endDT);
         count++;
@@ -322,93 +691,51 @@ int BinFileLoader::scanBarFeeds(vector<BinFileBarFeed*>& feeds, BinStreamDesc& d
     Logger_Info() << "Scan bar feeds...";
 
     feeds.clear();
-    
-    if (m_dataStreamDescs.size() == 0) {
-        return 0;
-    }
 
     string instrument;
     
     int currPos = 0;
-    int length = 0;
-    BinFileBarFeed* barFeed = nullptr;
-    DateTime startDT;
-    DateTime endDT;
+    int lastBegin = 0;
     instrument.clear();
 
-    BinFileItem* item      = desc.begin;
-    BinFileItem* lastBegin = item;
-
-    for (; item != desc.end; item++) {
+    for (BinFileItem* item = desc.begin; item != desc.end; item++) {
         if (instrument.empty()) {
             instrument = item->instrument;
-            startDT    = BinFileLoader::getDateTime(item->date, item->time);
-            endDT      = startDT;
         }
 
         if (item->instrument != instrument) {
-            barFeed = new BinFileLoader::BinFileBarFeed(
-                                                instrument,
-                                                desc.resolution,
-                                                lastBegin,
-                                                lastBegin + length - 1
-                                                );
-            barFeed->setId(DataStorage::getNextBarFeedId());
-            Contract c = contract;
-            strncpy(c.instrument, instrument.c_str(), sizeof(c.instrument));
-            barFeed->setContract(c);
-            barFeed->setDataStreamId(desc.id);
-            barFeed->setName(desc.name);
-            barFeed->setLength(length);
-            barFeed->setBeginDateTime(startDT);
-            barFeed->setEndDateTime(endDT);
-            barFeed->setResolution((Bar::Resolution)desc.resolution);
-            barFeed->setInterval(desc.interval);
-            feeds.push_back(barFeed);
+            feeds.push_back(createBarFeed(desc, contract, instrument, lastBegin, currPos - lastBegin));
 
             instrument = item->instrument;
-            startDT = BinFileLoader::getDateTime(item->date, item->time);
-            endDT = startDT;
-            lastBegin = item;
-            length = 1;
-        } else {
-            endDT = BinFileLoader::getDateTime(item->date, item->time);
-            length++;
+            lastBegin = currPos;
         }
         currPos++;
     }
 
     // push last one
-    barFeed = new BinFileLoader::BinFileBarFeed(
-        instrument,
-        desc.resolution,
-        lastBegin,
-        lastBegin + length - 1
-        );
-    barFeed->setId(DataStorage::getNextBarFeedId());
-    Contract c = contract;
-    strncpy(c.instrument, instrument.c_str(), sizeof(c.instrument));
-    barFeed->setContract(c);
-    barFeed->setDataStreamId(desc.id);
-    barFeed->setName(desc.name);
-    barFeed->setLength(length);
-    barFeed->setBeginDateTime(startDT);
-    barFeed->setEndDateTime(endDT);
-    barFeed->setResolution((Bar::Resolution)desc.resolution);
-    barFeed->setInterval(desc.interval);
-
-    feeds.push_back(barFeed);
+    feeds.push_back(createBarFeed(desc, contract, instrument, lastBegin, currPos - lastBegin));
 
     Logger_Info() << "Check time line correctness...";
-    for (size_t i = 0; i < feeds.size(); i++) {
-        if (!checkTimeline((BinFileBarFeed*)feeds[i])) {
-            return 0;
+    vector<int> periodNums(feeds.size(), 0);
+    DataDiagnostics diagnostics = DataDiagnostics::checkInParallel(feeds.size(),
+        [this, &feeds, &periodNums](size_t i, DataDiagnostics& item) {
+            checkTimeline(feeds[i], item);
+            if (!item.hasErrors()) {
+                periodNums[i] = scanTradablePeriod(feeds[i]);
+            }
+        });
+
+    if (!diagnostics.report(desc.file)) {
+        for (auto& feed : feeds) {
+            delete feed;
         }
+        feeds.clear();
+        return 0;
     }
 
     int periods = 0;
-    for (size_t i = 0; i < feeds.size(); i++) {
-        periods += scanTradablePeriod((BinFileBarFeed*)feeds[i]);
+    for (auto num : periodNums) {
+        periods += num;
     }
 
     int size = feeds.size();
@@ -418,6 +745,42 @@ int BinFileLoader::scanBarFeeds(vector<BinFileBarFeed*>& feeds, BinStreamDesc& d
     return size;
 }
 
+int BinFileLoader::sliceBarFeeds(vector<BinFileBarFeed*>& feeds, BinStreamDesc& desc, const Contract& contract, const DataRange& range)
+{
+    vector<BinFileBarFeed*> slices;
+    int periods = 0;
+
+    for (auto& feed : feeds) {
+        int begin = 0;
+        int length = 0;
+        if (range.hasInstrument(feed->getInstrument())) {
+            length = range.slice(feed->m_times, feed->getLength(), begin);
+        }
+
+        if (length == feed->getLength()) {
+            periods += feed->getTradablePeriods().size();
+            slices.push_back(feed);
+            continue;
+        }
+
+        if (length > 0) {
+            // Tradable periods are scanned again on the slice alone.
+            BinFileBarFeed* slice = createBarFeed(desc, contract, feed->getInstrument(), feed->m_fileBegin + begin, length);
+            periods += scanTradablePeriod(slice);
+            slices.push_back(slice);
+        }
+        delete feed;
+    }
+
+    feeds.swap(slices);
+
+    int size = feeds.size();
+
+    Logger_Info() << "Keep " << size << (size <= 1 ? " barfeed, " : " barfeeds, ") << periods << " tradable " << ( periods > 1 ? "periods" : "period") << " within range.";
+
+    return size;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 } // namespace xBacktest
\ No newline at end of file
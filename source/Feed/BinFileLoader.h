@@ -4,6 +4,9 @@
 #include <boost/iostreams/device/mapped_file.hpp>
 
 #include "BarFeed.h"
+#include "DataDiagnostics.h"
+#include "ThreadPool.h"
+#include "FileReader.h"
 
 /*
 typedef struct {
@@ -58,6 +61,77 @@ public:
         return DateTime(year, month, day, hour, min, sec);
     }
 
+    // Milliseconds elapsed since midnight, time format: HHMMSS.
+    static int64 getTimeOfDayTicks(int time)
+    {
+        int hour = time / 10000;
+        int min = (time % 10000) / 100;
+        int sec = time % 100;
+
+        return (int64)(hour * 3600 + min * 60 + sec) * 1000;
+    }
+
+    // Replace the time part of `ticks` with the given time (HHMMSS).
+    static int64 replaceTimeOfDay(int64 ticks, int time)
+    {
+        const int64 msPerDay = 24 * 60 * 60 * 1000LL;
+        return ticks - ticks % msPerDay + getTimeOfDayTicks(time);
+    }
+
+    // Decoded timestamps (milliseconds since the Epoch), one for each item
+    // of the mapped file. Shared by all feeds cloned from the same stream.
+    typedef vector<int64> TimestampColumn;
+
+    // Sidecar index written next to the data file ('<file>.idx') on first
+    // load, so later loads don't have to rescan the whole file:
+    //   BinIndexHeader | BinIndexSegment[] | BinIndexPeriod[] | timestamp[]
+    // The index is rebuilt when size, modification time or close time of
+    // the data file doesn't match.
+#pragma pack(push)
+#pragma pack(8)
+    typedef struct {
+        char        magic[8];    // BIN_INDEX_MAGIC
+        uint32_t    version;
+        int32_t     closeTime;   // contract close time tradable periods based on.
+        uint64_t    fileSize;
+        int64_t     modifyTime;
+        uint64_t    itemNum;
+        uint32_t    segmentNum;
+        uint32_t    periodNum;
+        uint64_t    timestampOffset;
+    } BinIndexHeader;
+
+    typedef struct {
+        char        instrument[16];
+        uint64_t    begin;       // index of the first item in data file.
+        uint64_t    length;
+        int64_t     beginTicks;
+        int64_t     endTicks;
+        uint32_t    periodBegin; // index of the first tradable period.
+        uint32_t    periodNum;
+    } BinIndexSegment;
+
+    typedef struct {
+        int64_t     begin;
+        int64_t     end;
+    } BinIndexPeriod;
+#pragma pack(pop)
+
+    // Window of a feed in streaming mode, see setStreamingWindow(). While
+    // the front buffer is consumed, the I/O thread fills the back buffer
+    // with the items following it.
+    typedef struct {
+        vector<BinFileItem> buffers[2];
+        int                 front;       // buffer being consumed.
+        int                 frontBegin;  // feed index of buffers[front][0].
+        int                 frontNum;
+        int                 backBegin;
+        int                 backNum;
+        bool                backPending; // read into back buffer in progress.
+        bool                backValid;
+        Utils::Condition    monitor;
+    } StreamWindow;
+
     class BinFileBarFeed : public BarFeed
     {
         friend class BinFileLoader;
@@ -74,26 +148,63 @@ public:
             void(*callback)(const DateTime& datetime, void* ctx));
         BinFileBarFeed* clone();
 
+        // Index of the item at `datetime`, -1 if there isn't one. O(log n).
+        int findItem(const DateTime& datetime) const;
+        // Items in [from, to] without copying, returns the number of items.
+        // `begin` is nullptr in streaming mode, items aren't mapped.
+        int getRange(const DateTime& from, const DateTime& to, BinFileItem*& begin, const int64*& times) const;
+
     private:
         BinFileBarFeed(const string& instrument,
             int resolution,
             BinFileItem* begin,
-            BinFileItem* end);
+            BinFileItem* end,
+            const shared_ptr<TimestampColumn>& timestamps,
+            const int64* times);
 //        BinFileBarFeed(const BinFileBarFeed&);
 
+        bool isStreaming() const { return m_reader != nullptr; }
+        // Item at index `idx` through the window, moves the window if needed.
+        const BinFileItem& fetchItem(int idx);
+        // Start reading the window beginning at `begin` into the back buffer.
+        void prefetch(int begin);
+        bool readItems(int begin, int num, BinFileItem* items) const;
+
     private:
         int m_readIdx;
         BinFileItem* m_begin;
         BinFileItem* m_end; // Ending item is also available.
+        // Keep the shared column alive, m_times points to the timestamp of m_begin.
+        shared_ptr<TimestampColumn> m_timestamps;
+        const int64* m_times;
+        int m_fileBegin;  // index of the first item in data file.
+
+        // Streaming mode only, the window is created on first read.
+        shared_ptr<Utils::FileReader> m_reader;
+        shared_ptr<Utils::ThreadPool> m_ioThread;
+        shared_ptr<StreamWindow>      m_window;
+        int                           m_windowItems;
     };
 
     BinFileLoader();
     ~BinFileLoader();
-    bool loadBinFile(const string& symbol, int resolution, int interval, const string& file, const Contract& contract, DataStream* stream);
+    // Safe to call concurrently. Ids of the stream and feeds are left unset,
+    // DataStorage assigns them on registration.
+    // Feeds and rows out of `range` are dropped after the index is loaded, so
+    // only the rows kept are scanned.
+    bool loadBinFile(const string& symbol, int resolution, int interval, const string& file, const Contract& contract, const DataRange& range, DataStream* stream);
+
+    // Number of items each feed keeps in memory per buffer in streaming
+    // mode, 0 disables streaming and feeds read the mapped file directly.
+    // Only the bar payload is windowed: the decoded timestamp column (8
+    // bytes per item) stays resident, as peeking, historical requests and
+    // timelines search it, so memory still grows with the file at about a
+    // tenth of its size. Must not be changed while files are being loaded.
+    void setStreamingWindow(int items);
+    int  getStreamingWindow() const;
 
 private:
     typedef struct {
-        int         id;
         string      name;
         int         resolution;
         int         interval;
@@ -101,17 +212,37 @@ private:
         Contract    contract;
 
         boost::iostreams::mapped_file_source* mappedFile;
+        boost::iostreams::mapped_file_source* mappedIndex;
         BinFileItem*                          begin;
         BinFileItem*                          end;
+        shared_ptr<TimestampColumn>           timestamps;
+        const int64*                          times; // decoded column or mapped index.
+        shared_ptr<Utils::FileReader>         reader; // streaming mode only.
     } BinStreamDesc;
 
-    bool checkTimeline(BinFileBarFeed* feed);
+    void decodeTimestamps(BinStreamDesc& desc);
+    BinFileBarFeed* createBarFeed(BinStreamDesc& desc, const Contract& contract, const string& instrument, int begin, int length);
+    bool loadIndex(vector<BinFileBarFeed*>& feeds, BinStreamDesc& desc, const Contract& contract);
+    bool writeIndex(const vector<BinFileBarFeed*>& feeds, const BinStreamDesc& desc, const Contract& contract);
+    void checkTimeline(BinFileBarFeed* feed, DataDiagnostics& diagnostics);
     int  scanTradablePeriod(BinFileBarFeed* feed);
     int  scanBarFeeds(vector<BinFileBarFeed*>& feeds, BinStreamDesc& desc, const Contract& contract);
+    // Replace feeds by their rows within `range`, returns the number of feeds left.
+    int  sliceBarFeeds(vector<BinFileBarFeed*>& feeds, BinStreamDesc& desc, const Contract& contract, const DataRange& range);
+    // Switch feeds of a loaded file to streaming mode and unmap the file.
+    // Bars are then read through the window, the timestamp column stays
+    // resident, so memory isn't bounded by the window alone.
+    bool enableStreaming(vector<BinFileBarFeed*>& feeds, BinStreamDesc& desc);
 
 private:
+    // Guards descriptors and feeds, files may be loaded concurrently.
+    Utils::Mutex m_mutex;
     vector<BinStreamDesc> m_dataStreamDescs;
     vector<BinFileBarFeed*> m_barFeeds;
+
+    int m_streamingWindow;
+    // Shared by all streaming feeds, created with the first streaming file.
+    shared_ptr<Utils::ThreadPool> m_ioThread;
 };
 
 } // namespace xBacktest
@@ -0,0 +1,515 @@
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include "Logger.h"
+#include "ColumnarFileLoader.h"
+#include "BinFileLoader.h"
+#include "DataStorage.h"
+
+namespace xBacktest
+{
+
+static const char COLUMNAR_FILE_MAGIC[8] = "XBTCOL1";
+static const uint32_t COLUMNAR_FILE_VERSION = 1;
+
+static uint64_t alignTo8(uint64_t offset)
+{
+    return (offset + 7) & ~(uint64_t)7;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ColumnarFileLoader::ColumnarBarFeed::ColumnarBarFeed(
+        const string& instrument,
+        int resolution,
+        const char* base,
+        const ColumnarFileHeader& header,
+        const ColumnarSegment& segment)
+    : BarFeed(resolution)
+{
+    setInstrument(instrument);
+    m_readIdx    = 0;
+    m_timestamps = (const int64*)(base + header.offsets[COL_TIMESTAMP]) + segment.begin;
+    m_opens      = (const double*)(base + header.offsets[COL_OPEN]) + segment.begin;
+    m_highs      = (const double*)(base + header.offsets[COL_HIGH]) + segment.begin;
+    m_lows       = (const double*)(base + header.offsets[COL_LOW]) + segment.begin;
+    m_closes     = (const double*)(base + header.offsets[COL_CLOSE]) + segment.begin;
+    m_volumes    = (const double*)(base + header.offsets[COL_VOLUME]) + segment.begin;
+    m_openInts   = (const double*)(base + header.offsets[COL_OPENINT]) + segment.begin;
+    m_hots       = (const uint32_t*)(base + header.offsets[COL_HOT]) + segment.begin;
+}
+
+bool ColumnarFileLoader::ColumnarBarFeed::reset()
+{
+    m_readIdx = 0;
+    return true;
+}
+
+void ColumnarFileLoader::ColumnarBarFeed::getBar(int idx, Bar& outBar) const
+{
+    outBar = Bar(getInstrumentId(),
+        DateTime(m_timestamps[idx]),
+        m_opens[idx],
+        m_highs[idx],
+        m_lows[idx],
+        m_closes[idx],
+        m_volumes[idx],
+        m_openInts[idx],
+        getResolution());
+}
+
+bool ColumnarFileLoader::ColumnarBarFeed::getNextBar(Bar& outBar)
+{
+    if (m_readIdx < getLength()) {
+        getBar(m_readIdx, outBar);
+        m_readIdx++;
+        return true;
+    }
+
+    return false;
+}
+
+int ColumnarFileLoader::ColumnarBarFeed::loadData(
+    int   reqId,
+    const DataRequest& request,
+    void* object,
+    void (*callback)(const DateTime& datetime, void* ctx))
+{
+    if (request.instrument != getInstrument()) {
+        return 0;
+    }
+
+    // Timestamps are sorted, locate bars by binary search.
+    int64 to = request.to.ticks();
+    const int64* end = m_timestamps + getLength();
+
+    int first = 0;
+    int count = 0;
+    if (request.type == BarsBack) {
+        const int64* pos = std::lower_bound(m_timestamps, end, to);
+        int idx = pos - m_timestamps;
+        if (pos == end || *pos != to || idx <= request.count - 1) {
+            return 0;
+        }
+        first = idx - request.count;
+        count = request.count;
+    } else if (request.type == DateTimeRange) {
+        const int64* lower = std::lower_bound(m_timestamps, end, request.from.ticks());
+        const int64* upper = std::upper_bound(lower, end, to);
+        first = lower - m_timestamps;
+        count = upper - lower;
+        if (count <= 0) {
+            return 0;
+        }
+    } else {
+        return 0;
+    }
+
+    for (int i = first; i < first + count; i++) {
+        HistoricalDataContext ctx;
+        ctx.reqId        = reqId;
+        ctx.dataStreamId = getDataStreamId();
+        ctx.barFeedId    = getId();
+        ctx.object       = object;
+        getBar(i, ctx.bar);
+        roundPrices(ctx.bar);
+        callback(ctx.bar.getDateTime(), &ctx);
+    }
+
+    return count;
+}
+
+ColumnarFileLoader::ColumnarBarFeed* ColumnarFileLoader::ColumnarBarFeed::clone()
+{
+    ColumnarBarFeed* feed = new ColumnarFileLoader::ColumnarBarFeed(*this);
+    feed->reset();
+    feed->setId(DataStorage::getNextBarFeedId());
+
+    return feed;
+}
+
+const DateTime ColumnarFileLoader::ColumnarBarFeed::peekDateTime() const
+{
+    return DateTime(m_timestamps[m_readIdx]);
+}
+
+bool ColumnarFileLoader::ColumnarBarFeed::eof()
+{
+    return m_readIdx >= getLength();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ColumnarFileLoader::ColumnarFileLoader()
+{
+    m_dataStreamDescs.clear();
+}
+
+ColumnarFileLoader::~ColumnarFileLoader()
+{
+    for (size_t i = 0; i < m_barFeeds.size(); i++) {
+        delete m_barFeeds[i];
+    }
+    m_barFeeds.clear();
+
+    for (size_t i = 0; i < m_dataStreamDescs.size(); i++) {
+        m_dataStreamDescs[i].mappedFile->close();
+        delete m_dataStreamDescs[i].mappedFile;
+    }
+    m_dataStreamDescs.clear();
+}
+
+bool ColumnarFileLoader::loadColumnarFile(const string& name, int resolution, int interval, const string& file, const Contract& contract, const DataRange& range, DataStream* stream)
+{
+    Logger_Info() << "Loading columnar file '" << file << "'...";
+
+    if (name.empty()) {
+        ASSERT(false, "Symbol(name) is empty.");
+    }
+
+    {
+        Utils::Lock lock(m_mutex);
+        for (size_t i = 0; i < m_dataStreamDescs.size(); i++) {
+            if (m_dataStreamDescs[i].name == name &&
+                m_dataStreamDescs[i].resolution == resolution &&
+                m_dataStreamDescs[i].interval == interval) {
+                return false;
+            }
+        }
+    }
+
+    ColumnarStreamDesc desc;
+    desc.name       = name;
+    desc.resolution = resolution;
+    desc.interval   = interval;
+    desc.file       = file;
+    desc.contract   = contract;
+    desc.mappedFile = nullptr;
+
+    try {
+        boost::iostreams::mapped_file_source* mappedFile = new boost::iostreams::mapped_file_source();
+        mappedFile->open(file);
+
+        if (!mappedFile->is_open() ||
+            !checkHeader(mappedFile->data(), mappedFile->size(), file)) {
+            delete mappedFile;
+            return false;
+        }
+
+        desc.mappedFile = mappedFile;
+    } catch (exception &e) {
+        ASSERT(false, e.what());
+        return false;
+    }
+
+    vector<ColumnarBarFeed*> barFeeds;
+    scanBarFeeds(barFeeds, desc, contract, range);
+
+    stream->setCommonContract(contract);
+    stream->setName(name);
+    stream->setResolution(resolution);
+    stream->setInterval(interval);
+    for (auto& feed : barFeeds) {
+        stream->insertBarFeed(feed);
+    }
+
+    {
+        Utils::Lock lock(m_mutex);
+        m_dataStreamDescs.push_back(desc);
+        m_barFeeds.insert(m_barFeeds.end(), barFeeds.begin(), barFeeds.end());
+    }
+
+    return (barFeeds.size() > 0);
+}
+
+bool ColumnarFileLoader::checkHeader(const char* base, size_t size, const string& file)
+{
+    if (size < sizeof(ColumnarFileHeader)) {
+        Logger_Err() << "File '" << file << "' is too small to be a columnar file.";
+        return false;
+    }
+
+    const ColumnarFileHeader* header = (const ColumnarFileHeader*)base;
+    if (memcmp(header->magic, COLUMNAR_FILE_MAGIC, sizeof(header->magic)) != 0) {
+        Logger_Err() << "File '" << file << "' is not a columnar file.";
+        return false;
+    }
+
+    if (header->version != COLUMNAR_FILE_VERSION) {
+        Logger_Err() << "Unsupported columnar file version " << header->version << ".";
+        return false;
+    }
+
+    uint64_t segmentEnd = sizeof(ColumnarFileHeader) + header->segmentNum * sizeof(ColumnarSegment);
+    if (segmentEnd > size) {
+        Logger_Err() << "Columnar file '" << file << "' is truncated.";
+        return false;
+    }
+
+    for (int i = 0; i < COL_NUM; i++) {
+        uint64_t width = (i == COL_TIMESTAMP) ? sizeof(int64) : (i == COL_HOT) ? sizeof(uint32_t) : sizeof(double);
+        if (header->offsets[i] < segmentEnd ||
+            header->offsets[i] % 8 != 0 ||
+            header->offsets[i] + header->itemNum * width > size) {
+            Logger_Err() << "Columnar file '" << file << "' is corrupted.";
+            return false;
+        }
+    }
+
+    const ColumnarSegment* segments = (const ColumnarSegment*)(base + sizeof(ColumnarFileHeader));
+    for (uint32_t i = 0; i < header->segmentNum; i++) {
+        if (segments[i].length == 0 ||
+            segments[i].begin + segments[i].length > header->itemNum) {
+            Logger_Err() << "Columnar file '" << file << "' has invalid segment " << i << ".";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void ColumnarFileLoader::checkTimeline(ColumnarBarFeed* feed, DataDiagnostics& diagnostics)
+{
+    const int64* times = feed->m_timestamps;
+    const string& instrument = feed->getInstrument();
+
+    for (int idx = 0; idx < feed->getLength(); idx++) {
+        diagnostics.checkRow(instrument, idx, times[idx], idx > 0 ? times[idx - 1] : 0,
+                             feed->m_opens[idx], feed->m_highs[idx], feed->m_lows[idx], feed->m_closes[idx]);
+    }
+}
+
+int ColumnarFileLoader::scanTradablePeriod(ColumnarBarFeed* feed)
+{
+    // Same rules as BinFileLoader::scanTradablePeriod().
+    const int64* times = feed->m_timestamps;
+    const uint32_t* hots = feed->m_hots;
+    int closeTime = feed->getContract().closeTime;
+    const int64 closeTicks = BinFileLoader::getTimeOfDayTicks(closeTime);
+    const int64 msPerDay = 24 * 60 * 60 * 1000LL;
+
+    DateTime startDT(times[0]);
+    DateTime endDT = startDT;
+    // tradable period end at contract's close time.
+    if (times[0] % msPerDay > closeTicks) {
+        endDT = DateTime(BinFileLoader::replaceTimeOfDay(times[0], closeTime));
+    }
+
+    int lastHotFlag = (int32_t)hots[0];
+    int count = 0;
+    int last = feed->getLength() - 1;
+
+    for (int idx = 0; idx < last; idx++) {
+        if ((int32_t)hots[idx] < 0) {
+            if (lastHotFlag >= 0) {
+                feed->addTradablePeriod(startDT, endDT);
+                count++;
+            }
+            startDT = DateTime(times[idx]);
+        } else {
+            if (lastHotFlag < 0) {
+                startDT = DateTime(times[idx]);
+            }
+            if (times[idx] % msPerDay > closeTicks) {
+                endDT = DateTime(BinFileLoader::replaceTimeOfDay(times[idx], closeTime));
+            } else {
+                endDT = DateTime(times[idx]);
+            }
+        }
+
+        lastHotFlag = (int32_t)hots[idx];
+    }
+
+    if ((int32_t)hots[last] >= 0) {
+        if (times[last] % msPerDay > closeTicks) {
+            endDT = DateTime(BinFileLoader::replaceTimeOfDay(times[last], closeTime));
+        } else {
+            endDT = DateTime(times[last]);
+        }
+        feed->addTradablePeriod(startDT, endDT);
+        count++;
+    }
+
+    return count;
+}
+
+int ColumnarFileLoader::scanBarFeeds(vector<ColumnarBarFeed*>& feeds, ColumnarStreamDesc& desc, const Contract& contract, const DataRange& range)
+{
+    Logger_Info() << "Scan bar feeds...";
+
+    feeds.clear();
+
+    const char* base = desc.mappedFile->data();
+    const ColumnarFileHeader& header = *(const ColumnarFileHeader*)base;
+    const ColumnarSegment* segments = (const ColumnarSegment*)(base + sizeof(ColumnarFileHeader));
+    const int64* timestamps = (const int64*)(base + header.offsets[COL_TIMESTAMP]);
+
+    // The segment index gives every instrument's range directly, no need to
+    // walk through the rows.
+    for (uint32_t i = 0; i < header.segmentNum; i++) {
+        ColumnarSegment segment = segments[i];
+        string instrument(segment.instrument, strnlen(segment.instrument, sizeof(segment.instrument)));
+        if (!range.isAll()) {
+            int begin = 0;
+            int length = 0;
+            if (range.hasInstrument(instrument)) {
+                length = range.slice(timestamps + segment.begin, (int)segment.length, begin);
+            }
+            if (length == 0) {
+                continue;
+            }
+            segment.begin += begin;
+            segment.length = length;
+        }
+
+        ColumnarBarFeed* barFeed = new ColumnarFileLoader::ColumnarBarFeed(
+                                            instrument,
+                                            desc.resolution,
+                                            base,
+                                            header,
+                                            segment);
+        Contract c = contract;
+        strncpy(c.instrument, instrument.c_str(), sizeof(c.instrument) - 1);
+        c.instrument[sizeof(c.instrument) - 1] = '\0';
+        barFeed->setContract(c);
+        barFeed->setName(desc.name);
+        barFeed->setLength((int)segment.length);
+        barFeed->setBeginDateTime(DateTime(barFeed->m_timestamps[0]));
+        barFeed->setEndDateTime(DateTime(barFeed->m_timestamps[segment.length - 1]));
+        barFeed->setResolution((Bar::Resolution)desc.resolution);
+        barFeed->setInterval(desc.interval);
+        feeds.push_back(barFeed);
+    }
+
+    Logger_Info() << "Check time line correctness...";
+    vector<int> periodNums(feeds.size(), 0);
+    DataDiagnostics diagnostics = DataDiagnostics::checkInParallel(feeds.size(),
+        [this, &feeds, &periodNums](size_t i, DataDiagnostics& item) {
+            checkTimeline(feeds[i], item);
+            if (!item.hasErrors()) {
+                periodNums[i] = scanTradablePeriod(feeds[i]);
+            }
+        });
+
+    if (!diagnostics.report(desc.file)) {
+        for (auto& feed : feeds) {
+            delete feed;
+        }
+        feeds.clear();
+        return 0;
+    }
+
+    int periods = 0;
+    for (auto num : periodNums) {
+        periods += num;
+    }
+
+    int size = feeds.size();
+
+    Logger_Info() << "Construct " << size << (size <= 1 ? " barfeed, " : " barfeeds, ") << periods << " tradable " << ( periods > 1 ? "periods." : "period.");
+
+    return size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ColumnarFileLoader::convertBinFile(const string& binFile, const string& columnarFile)
+{
+    typedef BinFileLoader::BinFileItem BinFileItem;
+
+    boost::iostreams::mapped_file_source source;
+    try {
+        source.open(binFile);
+    } catch (exception &e) {
+        Logger_Err() << "Failed to open '" << binFile << "': " << e.what();
+        return false;
+    }
+
+    if (!source.is_open()) {
+        return false;
+    }
+
+    const BinFileItem* items = (const BinFileItem*)source.data();
+    uint64_t itemNum = source.size() / sizeof(BinFileItem);
+
+    // Rows of one instrument are continuous in binary files.
+    vector<ColumnarSegment> segments;
+    for (uint64_t i = 0; i < itemNum; i++) {
+        if (segments.empty() ||
+            strncmp(segments.back().instrument, items[i].instrument, sizeof(items[i].instrument)) != 0) {
+            ColumnarSegment segment;
+            memset(&segment, 0, sizeof(segment));
+            // Instruments of binary items aren't terminated when they fill the field.
+            size_t length = std::min(sizeof(segment.instrument) - 1, sizeof(items[i].instrument));
+            strncpy(segment.instrument, items[i].instrument, length);
+            segment.instrument[length] = '\0';
+            segment.begin  = i;
+            segment.length = 0;
+            segments.push_back(segment);
+        }
+        segments.back().length++;
+    }
+
+    ColumnarFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, COLUMNAR_FILE_MAGIC, sizeof(header.magic));
+    header.version    = COLUMNAR_FILE_VERSION;
+    header.segmentNum = (uint32_t)segments.size();
+    header.itemNum    = itemNum;
+
+    uint64_t offset = alignTo8(sizeof(ColumnarFileHeader) + segments.size() * sizeof(ColumnarSegment));
+    for (int i = 0; i < COL_NUM; i++) {
+        uint64_t width = (i == COL_TIMESTAMP) ? sizeof(int64) : (i == COL_HOT) ? sizeof(uint32_t) : sizeof(double);
+        header.offsets[i] = offset;
+        offset = alignTo8(offset + itemNum * width);
+    }
+
+    vector<char> buffer(offset, 0);
+    char* base = buffer.data();
+    memcpy(base, &header, sizeof(header));
+    if (!segments.empty()) {
+        memcpy(base + sizeof(header), segments.data(), segments.size() * sizeof(ColumnarSegment));
+    }
+
+    int64*    timestamps = (int64*)(base + header.offsets[COL_TIMESTAMP]);
+    double*   opens      = (double*)(base + header.offsets[COL_OPEN]);
+    double*   highs      = (double*)(base + header.offsets[COL_HIGH]);
+    double*   lows       = (double*)(base + header.offsets[COL_LOW]);
+    double*   closes     = (double*)(base + header.offsets[COL_CLOSE]);
+    double*   volumes    = (double*)(base + header.offsets[COL_VOLUME]);
+    double*   openInts   = (double*)(base + header.offsets[COL_OPENINT]);
+    uint32_t* hots       = (uint32_t*)(base + header.offsets[COL_HOT]);
+
+    uint32_t lastDate = 0;
+    int64 dayTicks = 0;
+    for (uint64_t i = 0; i < itemNum; i++) {
+        const BinFileItem& item = items[i];
+        if (item.date != lastDate) {
+            lastDate = item.date;
+            dayTicks = BinFileLoader::getDateTime(item.date, 0).ticks();
+        }
+        timestamps[i] = dayTicks + BinFileLoader::getTimeOfDayTicks(item.time);
+        opens[i]      = item.open;
+        highs[i]      = item.high;
+        lows[i]       = item.low;
+        closes[i]     = item.close;
+        volumes[i]    = item.volume;
+        openInts[i]   = item.openInt;
+        hots[i]       = item.hot;
+    }
+
+    ofstream out(columnarFile.c_str(), ios::out | ios::binary | ios::trunc);
+    if (!out.is_open()) {
+        Logger_Err() << "Failed to create '" << columnarFile << "'.";
+        return false;
+    }
+
+    out.write(base, buffer.size());
+    out.close();
+
+    Logger_Info() << "Convert " << itemNum << " items of " << segments.size() << " instruments into '" << columnarFile << "'.";
+
+    return !out.fail();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // namespace xBacktest
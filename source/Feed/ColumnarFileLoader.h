@@ -0,0 +1,147 @@
+#ifndef COLUMNAR_FILE_LOADER_H
+#define COLUMNAR_FILE_LOADER_H
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "BarFeed.h"
+#include "DataDiagnostics.h"
+#include "Lock.h"
+
+namespace xBacktest
+{
+
+class DataStream;
+
+// Columnar (struct-of-arrays) bar store.
+//
+// File layout, all sections are 8 bytes aligned:
+//   +---------------------+
+//   | ColumnarFileHeader  |
+//   +---------------------+
+//   | ColumnarSegment[]   |  one segment per instrument, index into columns
+//   +---------------------+
+//   | timestamp[]         |  int64, milliseconds since the Epoch
+//   | open[]              |  double
+//   | high[]              |  double
+//   | low[]               |  double
+//   | close[]             |  double
+//   | volume[]            |  double
+//   | openInt[]           |  double
+//   | hot[]               |  uint32, same encoding as BinFileItem::hot
+//   +---------------------+
+// Every column holds `itemNum` values, rows of one instrument are stored
+// continuously and in ascending order of time.
+class ColumnarFileLoader
+{
+public:
+    enum Column {
+        COL_TIMESTAMP,
+        COL_OPEN,
+        COL_HIGH,
+        COL_LOW,
+        COL_CLOSE,
+        COL_VOLUME,
+        COL_OPENINT,
+        COL_HOT,
+        COL_NUM
+    };
+
+#pragma pack(push)
+#pragma pack(8)
+    typedef struct {
+        char        magic[8];    // COLUMNAR_FILE_MAGIC
+        uint32_t    version;
+        uint32_t    segmentNum;
+        uint64_t    itemNum;
+        uint64_t    offsets[COL_NUM];  // column offsets from the beginning of file.
+    } ColumnarFileHeader;
+
+    typedef struct {
+        char        instrument[32];
+        uint64_t    begin;       // index of the first row in columns.
+        uint64_t    length;
+    } ColumnarSegment;
+#pragma pack(pop)
+
+    class ColumnarBarFeed : public BarFeed
+    {
+        friend class ColumnarFileLoader;
+    public:
+        bool reset();
+        bool getNextBar(Bar& outBar);
+        bool isRealTime() { return false; }
+        const DateTime peekDateTime() const;
+        bool eof();
+        int loadData(int   reqId,
+            const DataRequest& request,
+            void* object,
+            void(*callback)(const DateTime& datetime, void* ctx));
+        ColumnarBarFeed* clone();
+
+        // Direct access to the mapped columns of this feed, each array
+        // contains getLength() values. Vectorized consumers may read them
+        // without going through Bar objects.
+        const int64*  getTimestamps() const { return m_timestamps; }
+        const double* getOpens() const      { return m_opens; }
+        const double* getHighs() const      { return m_highs; }
+        const double* getLows() const       { return m_lows; }
+        const double* getCloses() const     { return m_closes; }
+        const double* getVolumes() const    { return m_volumes; }
+        const double* getOpenInts() const   { return m_openInts; }
+        const uint32_t* getHotFlags() const { return m_hots; }
+
+    private:
+        ColumnarBarFeed(const string& instrument, int resolution, const char* base, const ColumnarFileHeader& header, const ColumnarSegment& segment);
+
+        // Build the bar at index `idx` of this feed.
+        void getBar(int idx, Bar& outBar) const;
+
+    private:
+        int m_readIdx;
+        const int64*   m_timestamps;
+        const double*  m_opens;
+        const double*  m_highs;
+        const double*  m_lows;
+        const double*  m_closes;
+        const double*  m_volumes;
+        const double*  m_openInts;
+        const uint32_t* m_hots;
+    };
+
+    ColumnarFileLoader();
+    ~ColumnarFileLoader();
+    // Safe to call concurrently. Ids of the stream and feeds are left unset,
+    // DataStorage assigns them on registration.
+    bool loadColumnarFile(const string& name, int resolution, int interval, const string& file, const Contract& contract, const DataRange& range, DataStream* stream);
+
+    // Convert a file of BinFileLoader::BinFileItem into columnar format.
+    static bool convertBinFile(const string& binFile, const string& columnarFile);
+
+private:
+    typedef struct {
+        string      name;
+        int         resolution;
+        int         interval;
+        string      file;
+        Contract    contract;
+
+        boost::iostreams::mapped_file_source* mappedFile;
+    } ColumnarStreamDesc;
+
+    bool checkHeader(const char* base, size_t size, const string& file);
+    void checkTimeline(ColumnarBarFeed* feed, DataDiagnostics& diagnostics);
+    int  scanTradablePeriod(ColumnarBarFeed* feed);
+    // Only rows within `range` are scanned, found by binary search on the
+    // timestamp column of each segment.
+    int  scanBarFeeds(vector<ColumnarBarFeed*>& feeds, ColumnarStreamDesc& desc, const Contract& contract, const DataRange& range);
+
+private:
+    // Guards descriptors and feeds, files may be loaded concurrently.
+    Utils::Mutex m_mutex;
+    vector<ColumnarStreamDesc> m_dataStreamDescs;
+    vector<ColumnarBarFeed*> m_barFeeds;
+};
+
+} // namespace xBacktest
+
+#endif // COLUMNAR_FILE_LOADER_H
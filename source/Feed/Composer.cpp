@@ -1,6 +1,5 @@
 #include "Composer.h"
 #include "BarFeed.h"
-#include "Event.h"
 
 namespace xBacktest
 {
@@ -51,7 +50,7 @@ void BarComposer::compisteBarSeries(BarSeries& input, BarSeries& output)
     m_inputBarSeries  = &input;
     m_outputBarSeries = &output;
 
-    m_inputBarSeries->getNewValueEvent().subscribe(this);
+    m_inputBarSeries->getNewValueEvent().subscribe<BarComposer, &BarComposer::onNewBar>(this);
 
     return;
 }
@@ -90,16 +89,12 @@ BarSeries* BarComposer::getOutputBarSeris() const
     return m_outputBarSeries;
 }
 
-void BarComposer::onEvent(int type, const DateTime& datetime, const void* context)
+void BarComposer::onNewBar(const DateTime& datetime, const Bar& bar)
 {
-    if (type == Event::EvtDataSeriesNewValue) {
-        Event::Context& ctx = *((Event::Context *)context);
-        Bar& bar = *((Bar *)ctx.data);
-        if (m_compositeAcrossDayBar) {
-            compositeAcrossDayBar(datetime, bar);
-        } else {
-            composite(datetime, bar);
-        }
+    if (m_compositeAcrossDayBar) {
+        compositeAcrossDayBar(datetime, bar);
+    } else {
+        composite(datetime, bar);
     }
 }
 
@@ -6,7 +6,7 @@
 namespace xBacktest
 {
 
-class BarComposer : public IEventHandler
+class BarComposer
 {
 public:
     BarComposer();
@@ -22,11 +22,8 @@ public:
     BarSeries* getInputBarSeries() const;
     BarSeries* getOutputBarSeris() const;
 
-    void onEvent(int             type,
-                 const DateTime& datetime,
-                 const void *    context);
-
 private:
+    void onNewBar(const DateTime& datetime, const Bar& bar);
     void covertPeriod(int open, int close, TradablePeriod& period);
     int  getSliceIndex(int currSecond);
     void computeSessionParams();
@@ -0,0 +1,800 @@
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <boost/filesystem.hpp>
+#include "Logger.h"
+#include "CompressedFileLoader.h"
+#include "BinFileLoader.h"
+#include "DataStorage.h"
+
+namespace xBacktest
+{
+
+static const char COMPRESSED_FILE_MAGIC[8] = "XBTCMP1";
+static const uint32_t COMPRESSED_FILE_VERSION = 1;
+
+static const uint32_t MAX_PRICE_DECIMALS = 8;
+
+static const double POW10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8
+};
+
+static uint64_t alignTo8(uint64_t offset)
+{
+    return (offset + 7) & ~(uint64_t)7;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Varint coding.
+
+static inline uint64_t zigzagEncode(int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static inline int64_t zigzagDecode(uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static inline void writeVarint(vector<char>& out, uint64_t value)
+{
+    while (value >= 0x80) {
+        out.push_back((char)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((char)value);
+}
+
+static inline bool readVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        uint8_t byte = *p++;
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (byte < 0x80) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static inline bool readDelta(const uint8_t*& p, const uint8_t* end, int64_t& value)
+{
+    uint64_t raw;
+    if (!readVarint(p, end, raw)) {
+        return false;
+    }
+    value += zigzagDecode(raw);
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CompressedFileLoader::CompressedBarFeed::CompressedBarFeed(
+        const string& instrument,
+        int resolution,
+        const char* base,
+        const CompressedHeader& header,
+        const CompressedSegment& segment)
+    : BarFeed(resolution)
+{
+    setInstrument(instrument);
+    m_readIdx      = 0;
+    m_base         = base;
+    m_segment      = &segment;
+    m_blocks       = (const CompressedBlock*)(base + header.blockOffset) + segment.firstBlock;
+    m_blockRows    = header.blockRows;
+    m_firstRow     = 0;
+    m_decodedBlock = -1;
+}
+
+bool CompressedFileLoader::CompressedBarFeed::decodeBlock(int block, DecodedBlock& decoded) const
+{
+    const CompressedBlock& blk = m_blocks[block];
+    const uint8_t* p = (const uint8_t*)m_base + blk.offset;
+    const uint8_t* end = p + blk.size;
+    int rowNum = blk.rowNum;
+
+    decoded.timestamps.resize(rowNum);
+    decoded.opens.resize(rowNum);
+    decoded.highs.resize(rowNum);
+    decoded.lows.resize(rowNum);
+    decoded.closes.resize(rowNum);
+    decoded.volumes.resize(rowNum);
+    decoded.openInts.resize(rowNum);
+    decoded.hots.resize(rowNum);
+
+    double* prices[4] = {
+        decoded.opens.data(),
+        decoded.highs.data(),
+        decoded.lows.data(),
+        decoded.closes.data()
+    };
+
+    const bool raw = (m_segment->tickUnits == 0);
+    const int64_t tickUnits = m_segment->tickUnits;
+    const double scale = POW10[m_segment->decimals];
+
+    int64_t ticks = blk.firstTimestamp;
+    int64_t ticksOfPrices[4] = { 0, 0, 0, 0 };
+    int64_t volume = 0;
+    int64_t openInt = 0;
+
+    for (int r = 0; r < rowNum; r++) {
+        if (!readDelta(p, end, ticks)) {
+            return false;
+        }
+        decoded.timestamps[r] = ticks;
+
+        for (int f = 0; f < 4; f++) {
+            if (raw) {
+                if (end - p < (ptrdiff_t)sizeof(double)) {
+                    return false;
+                }
+                memcpy(&prices[f][r], p, sizeof(double));
+                p += sizeof(double);
+            } else {
+                if (!readDelta(p, end, ticksOfPrices[f])) {
+                    return false;
+                }
+                prices[f][r] = (double)(ticksOfPrices[f] * tickUnits) / scale;
+            }
+        }
+
+        uint64_t hot;
+        if (!readDelta(p, end, volume) ||
+            !readDelta(p, end, openInt) ||
+            !readVarint(p, end, hot)) {
+            return false;
+        }
+        decoded.volumes[r]  = volume;
+        decoded.openInts[r] = openInt;
+        decoded.hots[r]     = (uint32_t)(int32_t)zigzagDecode(hot);
+    }
+
+    return p == end;
+}
+
+void CompressedFileLoader::CompressedBarFeed::fetchBlock(int block, DecodedBlock& decoded, int& decodedBlock) const
+{
+    if (block != decodedBlock) {
+        ASSERT(decodeBlock(block, decoded), "Corrupted block " << block << " of " << getInstrument() << ".");
+        decodedBlock = block;
+    }
+}
+
+int CompressedFileLoader::CompressedBarFeed::lowerBound(int64 ticks, DecodedBlock& decoded, int& decodedBlock) const
+{
+    // The first block not earlier than `ticks`, rows before it may be found
+    // in the previous block only.
+    const CompressedBlock* end = m_blocks + m_segment->blockNum;
+    const CompressedBlock* pos = std::lower_bound(m_blocks, end, ticks,
+        [](const CompressedBlock& block, int64 ticks) { return block.firstTimestamp < ticks; });
+
+    int block = (int)(pos - m_blocks) - 1;
+    if (block < 0) {
+        return 0;
+    }
+
+    fetchBlock(block, decoded, decodedBlock);
+    int row = std::lower_bound(decoded.timestamps.begin(), decoded.timestamps.end(), ticks) - decoded.timestamps.begin();
+
+    return block * m_blockRows + row;
+}
+
+int CompressedFileLoader::CompressedBarFeed::findRow(int64 ticks, DecodedBlock& decoded, int& decodedBlock) const
+{
+    int row = lowerBound(ticks, decoded, decodedBlock) - m_firstRow;
+    return std::min(std::max(row, 0), getLength());
+}
+
+bool CompressedFileLoader::CompressedBarFeed::reset()
+{
+    m_readIdx = 0;
+    return true;
+}
+
+void CompressedFileLoader::CompressedBarFeed::getBar(const DecodedBlock& decoded, int row, Bar& outBar) const
+{
+    outBar = Bar(getInstrumentId(),
+        DateTime(decoded.timestamps[row]),
+        decoded.opens[row],
+        decoded.highs[row],
+        decoded.lows[row],
+        decoded.closes[row],
+        decoded.volumes[row],
+        decoded.openInts[row],
+        getResolution());
+}
+
+bool CompressedFileLoader::CompressedBarFeed::getNextBar(Bar& outBar)
+{
+    if (m_readIdx < getLength()) {
+        int row = m_firstRow + m_readIdx;
+        fetchBlock(row / m_blockRows, m_decoded, m_decodedBlock);
+        getBar(m_decoded, row % m_blockRows, outBar);
+        m_readIdx++;
+        return true;
+    }
+
+    return false;
+}
+
+int CompressedFileLoader::CompressedBarFeed::loadData(
+    int   reqId,
+    const DataRequest& request,
+    void* object,
+    void (*callback)(const DateTime& datetime, void* ctx))
+{
+    if (request.instrument != getInstrument()) {
+        return 0;
+    }
+
+    // Locate blocks through the block index, then decode only the blocks
+    // covering the requested rows. Use a private buffer, the read position
+    // of this feed is left untouched.
+    DecodedBlock decoded;
+    int decodedBlock = -1;
+    int64 to = request.to.ticks();
+
+    int first = 0;
+    int count = 0;
+    if (request.type == BarsBack) {
+        int idx = findRow(to, decoded, decodedBlock);
+        if (idx >= getLength() || idx <= request.count - 1) {
+            return 0;
+        }
+        int row = m_firstRow + idx;
+        fetchBlock(row / m_blockRows, decoded, decodedBlock);
+        if (decoded.timestamps[row % m_blockRows] != to) {
+            return 0;
+        }
+        first = idx - request.count;
+        count = request.count;
+    } else if (request.type == DateTimeRange) {
+        first = findRow(request.from.ticks(), decoded, decodedBlock);
+        count = findRow(to + 1, decoded, decodedBlock) - first;
+        if (count <= 0) {
+            return 0;
+        }
+    } else {
+        return 0;
+    }
+
+    for (int i = m_firstRow + first; i < m_firstRow + first + count; i++) {
+        fetchBlock(i / m_blockRows, decoded, decodedBlock);
+
+        HistoricalDataContext ctx;
+        ctx.reqId        = reqId;
+        ctx.dataStreamId = getDataStreamId();
+        ctx.barFeedId    = getId();
+        ctx.object       = object;
+        getBar(decoded, i % m_blockRows, ctx.bar);
+        roundPrices(ctx.bar);
+        callback(ctx.bar.getDateTime(), &ctx);
+    }
+
+    return count;
+}
+
+CompressedFileLoader::CompressedBarFeed* CompressedFileLoader::CompressedBarFeed::clone()
+{
+    CompressedBarFeed* feed = new CompressedFileLoader::CompressedBarFeed(*this);
+    feed->reset();
+    feed->setId(DataStorage::getNextBarFeedId());
+
+    return feed;
+}
+
+const DateTime CompressedFileLoader::CompressedBarFeed::peekDateTime() const
+{
+    int row = m_firstRow + m_readIdx;
+    fetchBlock(row / m_blockRows, m_decoded, m_decodedBlock);
+    return DateTime(m_decoded.timestamps[row % m_blockRows]);
+}
+
+bool CompressedFileLoader::CompressedBarFeed::eof()
+{
+    return m_readIdx >= getLength();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CompressedFileLoader::CompressedFileLoader()
+{
+    m_dataStreamDescs.clear();
+}
+
+CompressedFileLoader::~CompressedFileLoader()
+{
+    for (size_t i = 0; i < m_barFeeds.size(); i++) {
+        delete m_barFeeds[i];
+    }
+    m_barFeeds.clear();
+
+    for (size_t i = 0; i < m_dataStreamDescs.size(); i++) {
+        m_dataStreamDescs[i].mappedFile->close();
+        delete m_dataStreamDescs[i].mappedFile;
+    }
+    m_dataStreamDescs.clear();
+}
+
+bool CompressedFileLoader::loadCompressedFile(const string& name, int resolution, int interval, const string& file, const Contract& contract, const DataRange& range, DataStream* stream)
+{
+    Logger_Info() << "Loading compressed file '" << file << "'...";
+
+    if (name.empty()) {
+        ASSERT(false, "Symbol(name) is empty.");
+    }
+
+    {
+        Utils::Lock lock(m_mutex);
+        for (size_t i = 0; i < m_dataStreamDescs.size(); i++) {
+            if (m_dataStreamDescs[i].name == name &&
+                m_dataStreamDescs[i].resolution == resolution &&
+                m_dataStreamDescs[i].interval == interval) {
+                return false;
+            }
+        }
+    }
+
+    CompressedStreamDesc desc;
+    desc.name       = name;
+    desc.resolution = resolution;
+    desc.interval   = interval;
+    desc.file       = file;
+    desc.contract   = contract;
+    desc.mappedFile = nullptr;
+
+    try {
+        boost::iostreams::mapped_file_source* mappedFile = new boost::iostreams::mapped_file_source();
+        mappedFile->open(file);
+
+        if (!mappedFile->is_open() ||
+            !checkHeader(mappedFile->data(), mappedFile->size(), file)) {
+            delete mappedFile;
+            return false;
+        }
+
+        desc.mappedFile = mappedFile;
+    } catch (exception &e) {
+        ASSERT(false, e.what());
+        return false;
+    }
+
+    vector<CompressedBarFeed*> barFeeds;
+    scanBarFeeds(barFeeds, desc, contract, range);
+
+    stream->setCommonContract(contract);
+    stream->setName(name);
+    stream->setResolution(resolution);
+    stream->setInterval(interval);
+    for (auto& feed : barFeeds) {
+        stream->insertBarFeed(feed);
+    }
+
+    {
+        Utils::Lock lock(m_mutex);
+        m_dataStreamDescs.push_back(desc);
+        m_barFeeds.insert(m_barFeeds.end(), barFeeds.begin(), barFeeds.end());
+    }
+
+    return (barFeeds.size() > 0);
+}
+
+bool CompressedFileLoader::checkHeader(const char* base, size_t size, const string& file)
+{
+    if (size < sizeof(CompressedHeader)) {
+        Logger_Err() << "File '" << file << "' is too small to be a compressed file.";
+        return false;
+    }
+
+    const CompressedHeader* header = (const CompressedHeader*)base;
+    if (memcmp(header->magic, COMPRESSED_FILE_MAGIC, sizeof(header->magic)) != 0) {
+        Logger_Err() << "File '" << file << "' is not a compressed file.";
+        return false;
+    }
+
+    if (header->version != COMPRESSED_FILE_VERSION) {
+        Logger_Err() << "Unsupported compressed file version " << header->version << ".";
+        return false;
+    }
+
+    if (header->blockRows == 0 ||
+        header->segmentOffset + header->segmentNum * sizeof(CompressedSegment) > size ||
+        header->blockOffset + header->blockNum * sizeof(CompressedBlock) > size) {
+        Logger_Err() << "Compressed file '" << file << "' is truncated.";
+        return false;
+    }
+
+    const CompressedSegment* segments = (const CompressedSegment*)(base + header->segmentOffset);
+    for (uint32_t i = 0; i < header->segmentNum; i++) {
+        const CompressedSegment& segment = segments[i];
+        if (segment.length == 0 ||
+            segment.begin + segment.length > header->itemNum ||
+            segment.firstBlock + segment.blockNum > header->blockNum ||
+            segment.blockNum != (segment.length + header->blockRows - 1) / header->blockRows ||
+            segment.decimals > MAX_PRICE_DECIMALS) {
+            Logger_Err() << "Compressed file '" << file << "' has invalid segment " << i << ".";
+            return false;
+        }
+    }
+
+    const CompressedBlock* blocks = (const CompressedBlock*)(base + header->blockOffset);
+    for (uint32_t i = 0; i < header->blockNum; i++) {
+        if (blocks[i].rowNum == 0 ||
+            blocks[i].rowNum > header->blockRows ||
+            blocks[i].offset + blocks[i].size > size) {
+            Logger_Err() << "Compressed file '" << file << "' has invalid block " << i << ".";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int CompressedFileLoader::scanBarFeed(CompressedBarFeed* feed, DataDiagnostics& diagnostics)
+{
+    // Same rules as ColumnarFileLoader::checkTimeline() and
+    // ColumnarFileLoader::scanTradablePeriod(), rows are decoded block by
+    // block instead of being read from columns.
+    int closeTime = feed->getContract().closeTime;
+    const int64 closeTicks = BinFileLoader::getTimeOfDayTicks(closeTime);
+    const int64 msPerDay = 24 * 60 * 60 * 1000LL;
+
+    DateTime startDT;
+    DateTime endDT;
+    int lastHotFlag = 0;
+    int64 lastTicks = 0;
+    int count = 0;
+    int last = feed->getLength() - 1;
+    int idx = 0;
+
+    // Blocks holding rows of the feed, a sliced feed starts and ends within
+    // its first and last blocks.
+    int firstRow = feed->m_firstRow;
+    int endRow = firstRow + feed->getLength();
+    int blockRows = feed->m_blockRows;
+
+    DecodedBlock decoded;
+    for (int b = firstRow / blockRows; b <= (endRow - 1) / blockRows; b++) {
+        const CompressedBlock& block = feed->m_blocks[b];
+        int expected = std::min<int>(blockRows, (int)feed->m_segment->length - b * blockRows);
+        if (!feed->decodeBlock(b, decoded) || (int)block.rowNum != expected) {
+            Logger_Err() << "Corrupted block " << b << " of " << feed->getInstrument() << ".";
+            return -1;
+        }
+
+        int rowEnd = std::min<int>(block.rowNum, endRow - b * blockRows);
+        for (int r = std::max(firstRow - b * blockRows, 0); r < rowEnd; r++, idx++) {
+            int64 ticks = decoded.timestamps[r];
+            int32_t hot = (int32_t)decoded.hots[r];
+
+            if (idx == 0) {
+                startDT = DateTime(ticks);
+                endDT = startDT;
+                // tradable period end at contract's close time.
+                if (ticks % msPerDay > closeTicks) {
+                    endDT = DateTime(BinFileLoader::replaceTimeOfDay(ticks, closeTime));
+                }
+                lastHotFlag = hot;
+                lastTicks = ticks;
+            }
+
+            diagnostics.checkRow(feed->getInstrument(), idx, ticks, lastTicks,
+                                 decoded.opens[r], decoded.highs[r], decoded.lows[r], decoded.closes[r]);
+
+            if (idx < last) {
+                if (hot < 0) {
+                    if (lastHotFlag >= 0) {
+                        feed->addTradablePeriod(startDT, endDT);
+                        count++;
+                    }
+                    startDT = DateTime(ticks);
+                } else {
+                    if (lastHotFlag < 0) {
+                        startDT = DateTime(ticks);
+                    }
+                    if (ticks % msPerDay > closeTicks) {
+                        endDT = DateTime(BinFileLoader::replaceTimeOfDay(ticks, closeTime));
+                    } else {
+                        endDT = DateTime(ticks);
+                    }
+                }
+
+                lastHotFlag = hot;
+            } else if (hot >= 0) {
+                if (ticks % msPerDay > closeTicks) {
+                    endDT = DateTime(BinFileLoader::replaceTimeOfDay(ticks, closeTime));
+                } else {
+                    endDT = DateTime(ticks);
+                }
+                feed->addTradablePeriod(startDT, endDT);
+                count++;
+            }
+
+            lastTicks = ticks;
+        }
+    }
+
+    return count;
+}
+
+int CompressedFileLoader::scanBarFeeds(vector<CompressedBarFeed*>& feeds, CompressedStreamDesc& desc, const Contract& contract, const DataRange& range)
+{
+    Logger_Info() << "Scan bar feeds...";
+
+    feeds.clear();
+
+    const char* base = desc.mappedFile->data();
+    const CompressedHeader& header = *(const CompressedHeader*)base;
+    const CompressedSegment* segments = (const CompressedSegment*)(base + header.segmentOffset);
+
+    for (uint32_t i = 0; i < header.segmentNum; i++) {
+        const CompressedSegment& segment = segments[i];
+        string instrument(segment.instrument, strnlen(segment.instrument, sizeof(segment.instrument)));
+        if (!range.hasInstrument(instrument)) {
+            continue;
+        }
+
+        CompressedBarFeed* barFeed = new CompressedFileLoader::CompressedBarFeed(
+                                            instrument,
+                                            desc.resolution,
+                                            base,
+                                            header,
+                                            segment);
+        int length = (int)segment.length;
+        if (range.from.isValid() || range.to.isValid()) {
+            // Only the blocks at both edges of the slice are decoded here.
+            DecodedBlock decoded;
+            int decodedBlock = -1;
+            int begin = range.from.isValid() ? barFeed->lowerBound(range.fromTicks(), decoded, decodedBlock) : 0;
+            int end = range.to.isValid() ? barFeed->lowerBound(range.toTicks() + 1, decoded, decodedBlock) : length;
+            if (end <= begin) {
+                delete barFeed;
+                continue;
+            }
+            barFeed->m_firstRow = begin;
+            length = end - begin;
+        }
+
+        Contract c = contract;
+        strncpy(c.instrument, instrument.c_str(), sizeof(c.instrument) - 1);
+        c.instrument[sizeof(c.instrument) - 1] = '\0';
+        barFeed->setContract(c);
+        barFeed->setName(desc.name);
+        barFeed->setLength(length);
+        barFeed->setResolution((Bar::Resolution)desc.resolution);
+        barFeed->setInterval(desc.interval);
+        feeds.push_back(barFeed);
+    }
+
+    Logger_Info() << "Check time line correctness...";
+    vector<int> periodNums(feeds.size(), 0);
+    DataDiagnostics diagnostics = DataDiagnostics::checkInParallel(feeds.size(),
+        [this, &feeds, &periodNums](size_t i, DataDiagnostics& item) {
+            CompressedBarFeed* feed = feeds[i];
+            periodNums[i] = scanBarFeed(feed, item);
+            if (periodNums[i] < 0) {
+                return;
+            }
+
+            // Begin and end come from the first and the last rows.
+            DecodedBlock decoded;
+            int decodedBlock = -1;
+            int first = feed->m_firstRow;
+            int last = first + feed->getLength() - 1;
+            feed->fetchBlock(first / feed->m_blockRows, decoded, decodedBlock);
+            feed->setBeginDateTime(DateTime(decoded.timestamps[first % feed->m_blockRows]));
+            feed->fetchBlock(last / feed->m_blockRows, decoded, decodedBlock);
+            feed->setEndDateTime(DateTime(decoded.timestamps[last % feed->m_blockRows]));
+        });
+
+    bool corrupted = std::find_if(periodNums.begin(), periodNums.end(), [](int num) { return num < 0; }) != periodNums.end();
+    if (!diagnostics.report(desc.file) || corrupted) {
+        for (auto& feed : feeds) {
+            delete feed;
+        }
+        feeds.clear();
+        return 0;
+    }
+
+    int periods = 0;
+    for (auto num : periodNums) {
+        periods += num;
+    }
+
+    int size = feeds.size();
+
+    Logger_Info() << "Construct " << size << (size <= 1 ? " barfeed, " : " barfeeds, ") << periods << " tradable " << ( periods > 1 ? "periods." : "period.");
+
+    return size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static uint64_t gcd(uint64_t a, uint64_t b)
+{
+    while (b != 0) {
+        uint64_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+bool CompressedFileLoader::convertBinFile(const string& binFile, const string& compressedFile, int blockRows)
+{
+    typedef BinFileLoader::BinFileItem BinFileItem;
+
+    if (blockRows <= 0) {
+        return false;
+    }
+
+    boost::iostreams::mapped_file_source source;
+    try {
+        source.open(binFile);
+    } catch (exception &e) {
+        Logger_Err() << "Failed to open '" << binFile << "': " << e.what();
+        return false;
+    }
+
+    if (!source.is_open()) {
+        return false;
+    }
+
+    const BinFileItem* items = (const BinFileItem*)source.data();
+    uint64_t itemNum = source.size() / sizeof(BinFileItem);
+
+    // Rows of one instrument are continuous in binary files.
+    vector<CompressedSegment> segments;
+    uint32_t blockNum = 0;
+    for (uint64_t i = 0; i < itemNum; i++) {
+        if (segments.empty() ||
+            strncmp(segments.back().instrument, items[i].instrument, sizeof(items[i].instrument)) != 0) {
+            CompressedSegment segment;
+            memset(&segment, 0, sizeof(segment));
+            // Instruments of binary items aren't terminated when they fill the field.
+            size_t length = std::min(sizeof(segment.instrument) - 1, sizeof(items[i].instrument));
+            strncpy(segment.instrument, items[i].instrument, length);
+            segment.instrument[length] = '\0';
+            segment.begin  = i;
+            segment.length = 0;
+            segments.push_back(segment);
+        }
+        segments.back().length++;
+    }
+
+    // Find the fewest decimals representing every price of an instrument
+    // exactly, and the tick size as the common divisor of scaled prices.
+    for (auto& segment : segments) {
+        segment.firstBlock = blockNum;
+        segment.blockNum   = (uint32_t)((segment.length + blockRows - 1) / blockRows);
+        blockNum += segment.blockNum;
+
+        segment.decimals  = 0;
+        segment.tickUnits = 0;
+        for (uint32_t d = 0; d <= MAX_PRICE_DECIMALS; d++) {
+            uint64_t units = 0;
+            bool exact = true;
+            for (uint64_t i = segment.begin; i < segment.begin + segment.length && exact; i++) {
+                const double prices[4] = { items[i].open, items[i].high, items[i].low, items[i].close };
+                for (int f = 0; f < 4 && exact; f++) {
+                    double scaled = prices[f] * POW10[d];
+                    if (!(fabs(scaled) < 9007199254740992.0)) {
+                        exact = false;
+                        break;
+                    }
+                    int64_t value = llround(scaled);
+                    exact = ((double)value / POW10[d] == prices[f]);
+                    units = gcd(units, (uint64_t)(value < 0 ? -value : value));
+                }
+            }
+
+            if (exact) {
+                segment.decimals  = d;
+                segment.tickUnits = (units == 0 || units > 0xFFFFFFFFULL) ? 1 : (uint32_t)units;
+                break;
+            }
+        }
+    }
+
+    CompressedHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, COMPRESSED_FILE_MAGIC, sizeof(header.magic));
+    header.version       = COMPRESSED_FILE_VERSION;
+    header.blockRows     = blockRows;
+    header.segmentNum    = (uint32_t)segments.size();
+    header.blockNum      = blockNum;
+    header.itemNum       = itemNum;
+    header.segmentOffset = alignTo8(sizeof(CompressedHeader));
+    header.blockOffset   = alignTo8(header.segmentOffset + segments.size() * sizeof(CompressedSegment));
+    uint64_t offset      = alignTo8(header.blockOffset + blockNum * sizeof(CompressedBlock));
+
+    ofstream out(compressedFile.c_str(), ios::out | ios::binary | ios::trunc);
+    if (!out.is_open()) {
+        Logger_Err() << "Failed to create '" << compressedFile << "'.";
+        return false;
+    }
+
+    // Block index is written last, once offsets of blocks are known.
+    vector<char> prefix(offset, 0);
+    memcpy(prefix.data(), &header, sizeof(header));
+    if (!segments.empty()) {
+        memcpy(prefix.data() + header.segmentOffset, segments.data(), segments.size() * sizeof(CompressedSegment));
+    }
+    out.write(prefix.data(), prefix.size());
+
+    vector<CompressedBlock> blocks;
+    vector<char> buffer;
+    uint32_t lastDate = 0;
+    int64 dayTicks = 0;
+    for (auto& segment : segments) {
+        for (uint64_t first = segment.begin; first < segment.begin + segment.length; first += blockRows) {
+            uint64_t last = std::min<uint64_t>(first + blockRows, segment.begin + segment.length);
+
+            CompressedBlock block;
+            memset(&block, 0, sizeof(block));
+            block.offset = offset;
+            block.rowNum = (uint32_t)(last - first);
+
+            buffer.clear();
+            int64_t ticks = 0;
+            int64_t ticksOfPrices[4] = { 0, 0, 0, 0 };
+            int64_t volume = 0;
+            int64_t openInt = 0;
+            for (uint64_t i = first; i < last; i++) {
+                const BinFileItem& item = items[i];
+                if (item.date != lastDate) {
+                    lastDate = item.date;
+                    dayTicks = BinFileLoader::getDateTime(item.date, 0).ticks();
+                }
+                int64_t timestamp = dayTicks + BinFileLoader::getTimeOfDayTicks(item.time);
+                if (i == first) {
+                    block.firstTimestamp = timestamp;
+                    ticks = timestamp;
+                }
+                writeVarint(buffer, zigzagEncode(timestamp - ticks));
+                ticks = timestamp;
+
+                const double prices[4] = { item.open, item.high, item.low, item.close };
+                for (int f = 0; f < 4; f++) {
+                    if (segment.tickUnits == 0) {
+                        buffer.insert(buffer.end(), (const char*)&prices[f], (const char*)&prices[f] + sizeof(double));
+                    } else {
+                        int64_t value = llround(prices[f] * POW10[segment.decimals]) / (int64_t)segment.tickUnits;
+                        writeVarint(buffer, zigzagEncode(value - ticksOfPrices[f]));
+                        ticksOfPrices[f] = value;
+                    }
+                }
+
+                // Same truncation as building a Bar from BinFileItem.
+                writeVarint(buffer, zigzagEncode((long long)item.volume - volume));
+                volume = (long long)item.volume;
+                writeVarint(buffer, zigzagEncode((long long)item.openInt - openInt));
+                openInt = (long long)item.openInt;
+                writeVarint(buffer, zigzagEncode((int32_t)item.hot));
+            }
+
+            block.size = (uint32_t)buffer.size();
+            out.write(buffer.data(), buffer.size());
+            offset += buffer.size();
+            blocks.push_back(block);
+        }
+    }
+
+    if (!blocks.empty()) {
+        out.seekp(header.blockOffset);
+        out.write((const char*)blocks.data(), blocks.size() * sizeof(CompressedBlock));
+    }
+    out.close();
+
+    Logger_Info() << "Convert " << itemNum << " items of " << segments.size() << " instruments into "
+                  << blocks.size() << " blocks, " << offset << " bytes of '" << compressedFile << "'.";
+
+    return !out.fail();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // namespace xBacktest
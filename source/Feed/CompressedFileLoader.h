@@ -0,0 +1,166 @@
+#ifndef COMPRESSED_FILE_LOADER_H
+#define COMPRESSED_FILE_LOADER_H
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "BarFeed.h"
+#include "DataDiagnostics.h"
+#include "Lock.h"
+
+namespace xBacktest
+{
+
+class DataStream;
+
+// Compressed bar store made of fixed-size blocks.
+//
+// File layout, all sections are 8 bytes aligned:
+//   +---------------------+
+//   | CompressedHeader    |
+//   +---------------------+
+//   | CompressedSegment[] |  one segment per instrument
+//   +---------------------+
+//   | CompressedBlock[]   |  block index, first timestamp and offset of blocks
+//   +---------------------+
+//   | block data          |
+//   +---------------------+
+// Rows of one instrument are stored continuously and in ascending order of
+// time, every block holds `blockRows` rows except the last one of a segment.
+// A block never spans two segments, so it can be decoded on its own.
+//
+// Within a block every row is encoded as zigzag varints of the delta to the
+// previous row of the same block:
+//   timestamp  milliseconds, first row relative to the block's first timestamp
+//   open, high, low, close
+//              integer number of ticks, price = ticks * tickUnits / 10^decimals
+//   volume, openInt
+//              integer
+//   hot        same encoding as BinFileItem::hot
+// Segments whose prices aren't exact decimals store raw doubles instead
+// (tickUnits = 0).
+class CompressedFileLoader
+{
+public:
+#pragma pack(push)
+#pragma pack(8)
+    typedef struct {
+        char        magic[8];    // COMPRESSED_FILE_MAGIC
+        uint32_t    version;
+        uint32_t    blockRows;   // rows per block.
+        uint32_t    segmentNum;
+        uint32_t    blockNum;
+        uint64_t    itemNum;
+        uint64_t    segmentOffset;
+        uint64_t    blockOffset;
+    } CompressedHeader;
+
+    typedef struct {
+        char        instrument[32];
+        uint64_t    begin;       // index of the first row in file.
+        uint64_t    length;
+        uint32_t    firstBlock;
+        uint32_t    blockNum;
+        uint32_t    decimals;
+        uint32_t    tickUnits;   // 0 if prices are stored as raw doubles.
+    } CompressedSegment;
+
+    typedef struct {
+        int64_t     firstTimestamp;
+        uint64_t    offset;      // from the beginning of file.
+        uint32_t    size;        // encoded size in bytes.
+        uint32_t    rowNum;
+    } CompressedBlock;
+#pragma pack(pop)
+
+    // One decoded block, reused by a feed while walking through blocks.
+    typedef struct {
+        vector<int64>     timestamps;
+        vector<double>    opens;
+        vector<double>    highs;
+        vector<double>    lows;
+        vector<double>    closes;
+        vector<long long> volumes;
+        vector<long long> openInts;
+        vector<uint32_t>  hots;
+    } DecodedBlock;
+
+    class CompressedBarFeed : public BarFeed
+    {
+        friend class CompressedFileLoader;
+    public:
+        bool reset();
+        bool getNextBar(Bar& outBar);
+        bool isRealTime() { return false; }
+        const DateTime peekDateTime() const;
+        bool eof();
+        int loadData(int   reqId,
+            const DataRequest& request,
+            void* object,
+            void(*callback)(const DateTime& datetime, void* ctx));
+        CompressedBarFeed* clone();
+
+    private:
+        CompressedBarFeed(const string& instrument, int resolution, const char* base, const CompressedHeader& header, const CompressedSegment& segment);
+
+        // Decode block `block` of this feed into `decoded`.
+        bool decodeBlock(int block, DecodedBlock& decoded) const;
+        // Decode block `block` unless it's `decodedBlock` already.
+        void fetchBlock(int block, DecodedBlock& decoded, int& decodedBlock) const;
+        // Index of the first row of the segment not earlier than `ticks`,
+        // decodes at most one block into `decoded`.
+        int  lowerBound(int64 ticks, DecodedBlock& decoded, int& decodedBlock) const;
+        // Same as above, as an index into this feed.
+        int  findRow(int64 ticks, DecodedBlock& decoded, int& decodedBlock) const;
+        void getBar(const DecodedBlock& decoded, int row, Bar& outBar) const;
+
+    private:
+        int m_readIdx;
+        const char* m_base;
+        const CompressedSegment* m_segment;
+        const CompressedBlock* m_blocks;
+        int m_blockRows;
+        int m_firstRow;  // row of the segment read first, a sliced feed skips rows before it.
+
+        // Decoding cache, touched by peekDateTime() too.
+        mutable DecodedBlock m_decoded;
+        mutable int m_decodedBlock;
+    };
+
+    CompressedFileLoader();
+    ~CompressedFileLoader();
+    // Safe to call concurrently. Ids of the stream and feeds are left unset,
+    // DataStorage assigns them on registration.
+    bool loadCompressedFile(const string& name, int resolution, int interval, const string& file, const Contract& contract, const DataRange& range, DataStream* stream);
+
+    // Convert a file of BinFileLoader::BinFileItem into compressed format.
+    static bool convertBinFile(const string& binFile, const string& compressedFile, int blockRows = 1024);
+
+private:
+    typedef struct {
+        string      name;
+        int         resolution;
+        int         interval;
+        string      file;
+        Contract    contract;
+
+        boost::iostreams::mapped_file_source* mappedFile;
+    } CompressedStreamDesc;
+
+    bool checkHeader(const char* base, size_t size, const string& file);
+    // Walk through all rows once, checking timeline and prices, and collect
+    // tradable periods.
+    int  scanBarFeed(CompressedBarFeed* feed, DataDiagnostics& diagnostics);
+    // Feeds are cut to `range` through the block index first, so only blocks
+    // holding rows within it are decoded.
+    int  scanBarFeeds(vector<CompressedBarFeed*>& feeds, CompressedStreamDesc& desc, const Contract& contract, const DataRange& range);
+
+private:
+    // Guards descriptors and feeds, files may be loaded concurrently.
+    Utils::Mutex m_mutex;
+    vector<CompressedStreamDesc> m_dataStreamDescs;
+    vector<CompressedBarFeed*> m_barFeeds;
+};
+
+} // namespace xBacktest
+
+#endif // COMPRESSED_FILE_LOADER_H
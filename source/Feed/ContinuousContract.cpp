@@ -0,0 +1,254 @@
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <unordered_set>
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "Logger.h"
+#include "ContinuousContract.h"
+
+namespace xBacktest
+{
+
+string ContinuousContract::getContinuousFileName(const string& binFile, const string& instrument, int adjustment)
+{
+    boost::filesystem::path path(binFile);
+    string name = path.stem().string() + "." + instrument + (adjustment == BackAdjusted ? ".back" : ".raw") + path.extension().string();
+
+    return (path.parent_path() / name).string();
+}
+
+string ContinuousContract::getRollFileName(const string& file)
+{
+    return file + ".roll";
+}
+
+bool ContinuousContract::update(const string& binFile, const string& outFile, const string& instrument, int adjustment)
+{
+    try {
+        if (boost::filesystem::exists(outFile) &&
+            boost::filesystem::exists(getRollFileName(outFile)) &&
+            boost::filesystem::last_write_time(outFile) >= boost::filesystem::last_write_time(binFile)) {
+            return true;
+        }
+    } catch (exception &e) {
+        Logger_Err() << "Failed to check '" << outFile << "': " << e.what();
+        return false;
+    }
+
+    vector<Segment> segments;
+    return build(binFile, outFile, instrument, adjustment, segments);
+}
+
+bool ContinuousContract::build(const string& binFile, const string& outFile, const string& instrument, int adjustment, vector<Segment>& segments)
+{
+    typedef BinFileLoader::BinFileItem BinFileItem;
+
+    Logger_Info() << "Build continuous contract '" << instrument << "' from '" << binFile << "'...";
+
+    BinFileItem item;
+    if (instrument.empty() || instrument.size() >= sizeof(item.instrument)) {
+        Logger_Err() << "Continuous contract name '" << instrument << "' must have 1 to " << sizeof(item.instrument) - 1 << " characters.";
+        return false;
+    }
+
+    boost::iostreams::mapped_file_source source;
+    try {
+        source.open(binFile);
+    } catch (exception &e) {
+        Logger_Err() << "Failed to open '" << binFile << "': " << e.what();
+        return false;
+    }
+
+    if (!source.is_open()) {
+        return false;
+    }
+
+    const BinFileItem* items = (const BinFileItem*)source.data();
+    size_t itemNum = source.size() / sizeof(BinFileItem);
+
+    typedef struct {
+        string        contract;
+        size_t        begin;
+        size_t        length;
+        vector<int64> times;
+    } ContractRows;
+
+    typedef struct {
+        int64  ticks;
+        int    contract;
+        size_t idx;
+    } HotItem;
+
+    // Rows of one contract are continuous in binary files.
+    vector<ContractRows> contracts;
+    vector<HotItem> hotItems;
+    for (size_t i = 0; i < itemNum; i++) {
+        if (contracts.empty() ||
+            strncmp(contracts.back().contract.c_str(), items[i].instrument, sizeof(items[i].instrument)) != 0) {
+            ContractRows contract;
+            contract.contract = string(items[i].instrument, strnlen(items[i].instrument, sizeof(items[i].instrument)));
+            contract.begin    = i;
+            contract.length   = 0;
+            contracts.push_back(contract);
+        }
+
+        int64 ticks = BinFileLoader::getDateTime(items[i].date, items[i].time).ticks();
+        contracts.back().times.push_back(ticks);
+        contracts.back().length++;
+
+        if ((int32_t)items[i].hot >= 0) {
+            hotItems.push_back({ ticks, (int)contracts.size() - 1, i });
+        }
+    }
+
+    if (hotItems.empty()) {
+        Logger_Err() << "No main contract is flagged in '" << binFile << "'.";
+        return false;
+    }
+
+    std::stable_sort(hotItems.begin(), hotItems.end(), [](const HotItem& a, const HotItem& b) {
+        return a.ticks != b.ticks ? a.ticks < b.ticks : a.contract < b.contract;
+    });
+
+    // Pick one contract per time.
+    vector<size_t> rows;
+    vector<int> rowSegments;
+    unordered_set<int> used;
+    int current = -1;
+    segments.clear();
+
+    size_t i = 0;
+    while (i < hotItems.size()) {
+        size_t j = i;
+        while (j < hotItems.size() && hotItems[j].ticks == hotItems[i].ticks) {
+            j++;
+        }
+
+        int picked = -1;
+        for (size_t k = i; k < j; k++) {
+            if (hotItems[k].contract == current) {
+                picked = (int)k;
+                break;
+            }
+        }
+        if (picked < 0) {
+            for (size_t k = i; k < j; k++) {
+                if (used.find(hotItems[k].contract) == used.end()) {
+                    picked = (int)k;
+                    break;
+                }
+            }
+        }
+
+        // Only contracts already rolled out of are hot, never roll back.
+        if (picked < 0) {
+            i = j;
+            continue;
+        }
+
+        const HotItem& hotItem = hotItems[picked];
+        if (hotItem.contract != current) {
+            Segment segment;
+            segment.contract   = contracts[hotItem.contract].contract;
+            segment.begin      = DateTime(hotItem.ticks);
+            segment.gap        = 0;
+            segment.adjustment = 0;
+            if (current >= 0) {
+                const ContractRows& from = contracts[current];
+                size_t last = std::upper_bound(from.times.begin(), from.times.end(), hotItem.ticks) - from.times.begin();
+                if (last > 0) {
+                    segment.gap = items[hotItem.idx].close - items[from.begin + last - 1].close;
+                }
+            }
+            segments.push_back(segment);
+            used.insert(hotItem.contract);
+            current = hotItem.contract;
+        }
+
+        segments.back().end = DateTime(hotItem.ticks);
+        rows.push_back(hotItem.idx);
+        rowSegments.push_back((int)segments.size() - 1);
+
+        i = j;
+    }
+
+    if (adjustment == BackAdjusted) {
+        for (int s = (int)segments.size() - 2; s >= 0; s--) {
+            segments[s].adjustment = segments[s + 1].adjustment + segments[s + 1].gap;
+        }
+    }
+
+    string tempFile;
+    try {
+        // Same series may be built by concurrent loaders.
+        tempFile = outFile + "." + boost::filesystem::unique_path().string() + ".tmp";
+
+        ofstream out(tempFile.c_str(), ios::out | ios::binary | ios::trunc);
+        if (!out.is_open()) {
+            Logger_Err() << "Can't create '" << outFile << "'.";
+            return false;
+        }
+
+        for (size_t r = 0; r < rows.size(); r++) {
+            item = items[rows[r]];
+            double offset = segments[rowSegments[r]].adjustment;
+            memset(item.instrument, 0, sizeof(item.instrument));
+            strncpy(item.instrument, instrument.c_str(), sizeof(item.instrument) - 1);
+            item.open  += offset;
+            item.high  += offset;
+            item.low   += offset;
+            item.close += offset;
+            item.hot    = rowSegments[r];
+            out.write((const char*)&item, sizeof(item));
+        }
+
+        out.close();
+        if (out.fail()) {
+            boost::filesystem::remove(tempFile);
+            return false;
+        }
+
+        boost::filesystem::rename(tempFile, outFile);
+    } catch (exception &e) {
+        Logger_Err() << "Failed to write '" << outFile << "': " << e.what();
+        if (!tempFile.empty()) {
+            boost::system::error_code ec;
+            boost::filesystem::remove(tempFile, ec);
+        }
+        return false;
+    }
+
+    if (!writeRollFile(getRollFileName(outFile), segments)) {
+        return false;
+    }
+
+    Logger_Info() << "Write " << rows.size() << " items of " << segments.size() << " contracts into '" << outFile << "'.";
+
+    return true;
+}
+
+bool ContinuousContract::writeRollFile(const string& file, const vector<Segment>& segments)
+{
+    ofstream out(file.c_str(), ios::out | ios::trunc);
+    if (!out.is_open()) {
+        Logger_Err() << "Can't create '" << file << "'.";
+        return false;
+    }
+
+    out << "segment,contract,begin,end,gap,adjustment" << endl;
+    out.precision(10);
+    for (size_t s = 0; s < segments.size(); s++) {
+        out << s << ","
+            << segments[s].contract << ","
+            << segments[s].begin.toString() << ","
+            << segments[s].end.toString() << ","
+            << segments[s].gap << ","
+            << segments[s].adjustment << endl;
+    }
+
+    return !out.fail();
+}
+
+} // namespace xBacktest
@@ -0,0 +1,51 @@
+#ifndef CONTINUOUS_CONTRACT_H
+#define CONTINUOUS_CONTRACT_H
+
+#include "BinFileLoader.h"
+
+namespace xBacktest
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// Stitches the main contracts of a binary file into one continuous series.
+//
+// An item is on the main contract unless its hot flag is negative, the same
+// rule tradable periods follow. At every time the series stays on the
+// current contract while it's hot, otherwise it rolls to a hot contract it
+// hasn't been on yet, times with neither are skipped. The roll gap is the close of the new contract minus
+// the last close of the old one at or before the roll.
+//
+// The output is a plain binary file holding one instrument, `hot` of every
+// item is the index of the segment it's taken from, so the series is
+// tradable as a whole. Segments are described in '<file>.roll':
+//   segment,contract,begin,end,gap,adjustment
+// where `gap` is the roll gap into the segment and `adjustment` is what was
+// added to its prices.
+class ContinuousContract
+{
+public:
+    typedef struct {
+        string   contract;
+        DateTime begin;
+        DateTime end;
+        double   gap;
+        double   adjustment;
+    } Segment;
+
+    // Build continuous series `instrument` out of `binFile` into `outFile`,
+    // `adjustment` is one of ContinuousAdjustment.
+    static bool build(const string& binFile, const string& outFile, const string& instrument, int adjustment, vector<Segment>& segments);
+    // Build `outFile` unless it's newer than `binFile`.
+    static bool update(const string& binFile, const string& outFile, const string& instrument, int adjustment);
+
+    // Default output file, e.g. 'data.rb888.back.bin' next to 'data.bin'.
+    static string getContinuousFileName(const string& binFile, const string& instrument, int adjustment);
+    static string getRollFileName(const string& file);
+
+private:
+    static bool writeRollFile(const string& file, const vector<Segment>& segments);
+};
+
+} // namespace xBacktest
+
+#endif // CONTINUOUS_CONTRACT_H
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <algorithm>
 #include "Utils.h"
 #include "DataStorage.h"
 #include "CsvFileLoader.h"
@@ -17,7 +18,6 @@ CsvFileLoader::CsvBarFeed::CsvBarFeed(int dataStreamId, int resolution)
     m_instrument = "";
     // default resolution
     m_resolution = Bar::MINUTE;
-    setId(DataStorage::getNextBarFeedId());
     setDataStreamId(dataStreamId);
     m_bars = make_shared< vector<Bar> >();
     m_csvParser = nullptr;
@@ -63,6 +63,15 @@ bool CsvFileLoader::CsvBarFeed::getNextBar(Bar& outBar)
     return false;
 }
 
+const Bar* CsvFileLoader::CsvBarFeed::getNextStoredBar()
+{
+    if (m_readIdx < getLength()) {
+        return &(*m_bars)[m_readIdx++];
+    }
+
+    return nullptr;
+}
+
 const DateTime CsvFileLoader::CsvBarFeed::peekDateTime() const
 {
     return (*m_bars)[m_readIdx].getDateTime();
@@ -448,15 +457,32 @@ bool CsvFileLoader::CsvBarFeed::loadCsvTickData(const string& instrument, const
     return true;
 }
 
+int CsvFileLoader::CsvBarFeed::trimBars(const DataRange& range)
+{
+    vector<Bar>& bars = *m_bars;
+    int64 from = range.fromTicks();
+    int64 to = range.toTicks();
+    bars.erase(std::remove_if(bars.begin(), bars.end(), [from, to](const Bar& bar) {
+        int64 ticks = bar.getDateTime().ticks();
+        return ticks < from || ticks > to;
+    }), bars.end());
+
+    m_readIdx = 0;
+    setLength(bars.size());
+    if (bars.size() > 0) {
+        setBeginDateTime(bars.front().getDateTime());
+        setEndDateTime(bars.back().getDateTime());
+    }
+
+    return bars.size();
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 CsvFileLoader::CsvFileLoader()
 {
-    // Arbitrary number greater than 0.
-    m_nextDataStreamId = 1;
 }
 
-bool CsvFileLoader::loadCsvFile(const string& instrument, int resolution, string& file, const Contract& contract, DataStream* stream)
+bool CsvFileLoader::loadCsvFile(const string& instrument, int resolution, string& file, const Contract& contract, const DataRange& range, DataStream* stream)
 {
     Logger_Info() << "Loading CSV file '" << file << "'...";
 
@@ -464,15 +490,18 @@ bool CsvFileLoader::loadCsvFile(const string& instrument, int resolution, string
         ASSERT(false, "Symbol(name) is empty.");
     }
 
-    for (size_t i = 0; i < m_dataStreamDescs.size(); i++) {
-        if (m_dataStreamDescs[i].name == instrument &&
-            m_dataStreamDescs[i].resolution == resolution) {
-            return false;
+    {
+        Utils::Lock lock(m_mutex);
+        for (size_t i = 0; i < m_dataStreamDescs.size(); i++) {
+            if (m_dataStreamDescs[i].name == instrument &&
+                m_dataStreamDescs[i].resolution == resolution) {
+                return false;
+            }
         }
     }
 
     CsvStreamDesc desc;
-    desc.id = m_nextDataStreamId++;
+    desc.id = 0;
     desc.name = instrument;
     desc.resolution = resolution;
     desc.file = file;
@@ -489,11 +518,21 @@ bool CsvFileLoader::loadCsvFile(const string& instrument, int resolution, string
         feed->loadCsvTickData(instrument, file);
     }
 
-    m_dataStreamDescs.push_back(desc);
-    m_dataStreamDescs.back().barFeeds.push_back(feed);
+    // The file is parsed as a whole, it holds one instrument named after the
+    // stream.
+    if (!range.isAll() && (!range.hasInstrument(instrument) || feed->trimBars(range) == 0)) {
+        Logger_Err() << "No data of '" << instrument << "' within range in '" << file << "'.";
+        delete feed;
+        return false;
+    }
+
+    {
+        Utils::Lock lock(m_mutex);
+        m_dataStreamDescs.push_back(desc);
+        m_dataStreamDescs.back().barFeeds.push_back(feed);
+    }
 
     stream->setCommonContract(contract);
-    stream->setId(desc.id);
     stream->setName(instrument);
     stream->setResolution(resolution);
     stream->insertBarFeed(feed);
@@ -5,6 +5,7 @@
 #include "BaseFeed.h"
 #include "BarFeed.h"
 #include "csv_parser.hpp"
+#include "Lock.h"
 
 namespace xBacktest
 {
@@ -20,6 +21,8 @@ public:
     public:
         bool reset();
         bool getNextBar(Bar& outBar);
+        bool isStored() const { return true; }
+        const Bar* getNextStoredBar();
         bool isRealTime() { return false; }
         bool barsHaveAdjClose() { return true; }
         const DateTime peekDateTime() const;
@@ -31,6 +34,8 @@ public:
         CsvBarFeed(const CsvBarFeed&);
         bool loadCsvTickData(const string& instrument, const string& file);
         bool loadCsvBarData(int resolution, const string& file);
+        // Drop loaded bars out of `range`, returns the number of bars left.
+        int  trimBars(const DataRange& range);
 
     private:
         string m_instrument;
@@ -44,7 +49,7 @@ public:
 
     CsvFileLoader();
     ~CsvFileLoader();
-    bool loadCsvFile(const string& instrument, int resolution, string& file, const Contract& contract, DataStream* stream);
+    bool loadCsvFile(const string& instrument, int resolution, string& file, const Contract& contract, const DataRange& range, DataStream* stream);
 
 private:   
     typedef struct {
@@ -56,9 +61,8 @@ private:
         vector<CsvBarFeed*> barFeeds;
     } CsvStreamDesc;
 
+    Utils::Mutex m_mutex;
     vector<CsvStreamDesc> m_dataStreamDescs;
-    
-    int m_nextDataStreamId;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
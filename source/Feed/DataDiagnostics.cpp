@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <sstream>
+
+#include "Logger.h"
+#include "Utils.h"
+#include "ThreadPool.h"
+#include "DataDiagnostics.h"
+
+namespace xBacktest
+{
+
+static const char* const KIND_NAMES[DataDiagnostics::KIND_NUM][2] = {
+    { "out-of-order row",    "out-of-order rows"    },
+    { "duplicate timestamp", "duplicate timestamps" },
+    { "abnormal price",      "abnormal prices"      },
+    { "zero-range bar",      "zero-range bars"      },
+};
+
+DataDiagnostics::DataDiagnostics()
+{
+    for (int i = 0; i < KIND_NUM; i++) {
+        m_counts[i] = 0;
+    }
+}
+
+void DataDiagnostics::add(int kind, const string& feed, int idx, int64 ticks, int64 prevTicks,
+                          double open, double high, double low, double close)
+{
+    m_counts[kind]++;
+    if (m_samples[kind].size() < MAX_SAMPLES) {
+        m_samples[kind].push_back({ feed, idx, ticks, prevTicks, open, high, low, close });
+    }
+}
+
+void DataDiagnostics::merge(const DataDiagnostics& other)
+{
+    for (int i = 0; i < KIND_NUM; i++) {
+        m_counts[i] += other.m_counts[i];
+        for (size_t j = 0; j < other.m_samples[i].size() && m_samples[i].size() < MAX_SAMPLES; j++) {
+            m_samples[i].push_back(other.m_samples[i][j]);
+        }
+    }
+}
+
+long DataDiagnostics::getCount(int kind) const
+{
+    return m_counts[kind];
+}
+
+bool DataDiagnostics::hasErrors() const
+{
+    return m_counts[OutOfOrder] > 0 || m_counts[AbnormalPrice] > 0;
+}
+
+bool DataDiagnostics::report(const string& file) const
+{
+    bool found = false;
+    std::ostringstream summary;
+    summary << "Data check of '" << file << "' found ";
+    for (int i = 0; i < KIND_NUM; i++) {
+        if (m_counts[i] > 0) {
+            summary << (found ? ", " : "") << m_counts[i] << " " << KIND_NAMES[i][m_counts[i] > 1 ? 1 : 0];
+            found = true;
+        }
+    }
+
+    if (!found) {
+        return true;
+    }
+    summary << ".";
+
+    if (!hasErrors()) {
+        Logger_Info() << summary.str();
+        return true;
+    }
+
+    Logger_Err() << summary.str() << " Please verify the correctness of your input data.";
+    for (int i = 0; i < KIND_NUM; i++) {
+        if (i != OutOfOrder && i != AbnormalPrice) {
+            continue;
+        }
+
+        for (auto& sample : m_samples[i]) {
+            char str[256] = { 0 };
+            if (i == OutOfOrder) {
+                _snprintf(str, sizeof(str)-1, "Timeline wrap back. Feed: %s, Index: %d, Previous: %s, Current: %s",
+                    sample.feed.c_str(),
+                    sample.index,
+                    DateTime(sample.prevTicks).toString().c_str(),
+                    DateTime(sample.ticks).toString().c_str());
+            } else {
+                _snprintf(str, sizeof(str)-1, "Abnormal price. Feed: %s, Index: %d, DateTime: %s, Price: %0.2f, %0.2f, %0.2f, %0.2f",
+                    sample.feed.c_str(),
+                    sample.index,
+                    DateTime(sample.ticks).toString().c_str(),
+                    sample.open, sample.high, sample.low, sample.close);
+            }
+            Logger_Err() << str;
+        }
+    }
+
+    return false;
+}
+
+DataDiagnostics DataDiagnostics::checkInParallel(size_t num, const std::function<void(size_t idx, DataDiagnostics& diagnostics)>& check)
+{
+    vector<DataDiagnostics> diagnostics(num);
+    if (num == 1) {
+        check(0, diagnostics[0]);
+    } else if (num > 1) {
+        Utils::ThreadPool pool(std::min<int>(Utils::getMachineCPUNum(), (int)num));
+        for (size_t i = 0; i < num; i++) {
+            DataDiagnostics* item = &diagnostics[i];
+            pool.Submit([&check, i, item]() {
+                check(i, *item);
+            });
+        }
+        // Leaving the scope waits for all the items.
+    }
+
+    DataDiagnostics merged;
+    for (auto& item : diagnostics) {
+        merged.merge(item);
+    }
+
+    return merged;
+}
+
+} // namespace xBacktest
@@ -0,0 +1,83 @@
+#ifndef DATA_DIAGNOSTICS_H
+#define DATA_DIAGNOSTICS_H
+
+#include <functional>
+#include "Defines.h"
+
+namespace xBacktest
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// Problems found in the rows of a data file while it's loaded. Feeds are
+// checked in parallel, each into diagnostics of its own, which are merged
+// into one report of the file.
+//
+// Out-of-order rows and abnormal prices fail the load, duplicate timestamps
+// and zero-range bars are only reported.
+class DataDiagnostics
+{
+public:
+    enum Kind {
+        OutOfOrder,       // time before the previous row's.
+        DuplicateTime,    // time same as the previous row's.
+        AbnormalPrice,    // non-positive price, or high below low.
+        ZeroRange,        // high equals low.
+        KIND_NUM
+    };
+
+    enum {
+        MAX_SAMPLES = 5   // rows reported in detail per kind.
+    };
+
+    DataDiagnostics();
+
+    // Check row `idx` of `feed`, `prevTicks` is the time of the row before
+    // and ignored for the first row.
+    void checkRow(const string& feed, int idx, int64 ticks, int64 prevTicks,
+                  double open, double high, double low, double close)
+    {
+        if (idx > 0 && ticks <= prevTicks) {
+            add(ticks < prevTicks ? OutOfOrder : DuplicateTime, feed, idx, ticks, prevTicks, open, high, low, close);
+        }
+
+        if (open <= 0.0 || high <= 0.0 || low <= 0.0 || close <= 0.0 || high < low) {
+            add(AbnormalPrice, feed, idx, ticks, prevTicks, open, high, low, close);
+        } else if (high == low) {
+            add(ZeroRange, feed, idx, ticks, prevTicks, open, high, low, close);
+        }
+    }
+
+    void merge(const DataDiagnostics& other);
+
+    long getCount(int kind) const;
+    bool hasErrors() const;
+
+    // Log the report of `file`, returns false if it has errors.
+    bool report(const string& file) const;
+
+    // Run `check` for items [0, num) on a pool of threads, every item with
+    // diagnostics of its own, and merge them in item order.
+    static DataDiagnostics checkInParallel(size_t num, const std::function<void(size_t idx, DataDiagnostics& diagnostics)>& check);
+
+private:
+    typedef struct {
+        string feed;
+        int    index;
+        int64  ticks;
+        int64  prevTicks;
+        double open;
+        double high;
+        double low;
+        double close;
+    } Sample;
+
+    void add(int kind, const string& feed, int idx, int64 ticks, int64 prevTicks,
+             double open, double high, double low, double close);
+
+    long           m_counts[KIND_NUM];
+    vector<Sample> m_samples[KIND_NUM];
+};
+
+} // namespace xBacktest
+
+#endif // DATA_DIAGNOSTICS_H
@@ -1,14 +1,18 @@
+#include <algorithm>
+#include "Logger.h"
 #include "DataStorage.h"
 
 namespace xBacktest
 {
 
 ////////////////////////////////////////////////////////////////////////////////
-unsigned long DataStream::m_nextId = 0;
+std::atomic<unsigned long> DataStream::m_nextId(0);
 
 DataStream::DataStream()
 {
-    m_id = m_nextId++;
+    m_id         = m_nextId++;
+    m_resolution = 0;
+    m_interval   = 0;
 }
 
 DataStream::~DataStream()
@@ -40,11 +44,21 @@ void DataStream::setResolution(int resolution)
     m_resolution = resolution;
 }
 
+int DataStream::getResolution() const
+{
+    return m_resolution;
+}
+
 void DataStream::setInterval(int interval)
 {
     m_interval = interval;
 }
 
+int DataStream::getInterval() const
+{
+    return m_interval;
+}
+
 void DataStream::setCommonContract(const Contract& contract)
 {
     m_commContract = contract;
@@ -65,6 +79,26 @@ vector<BarFeed*>& DataStream::getBarFeeds()
     return m_barFeeds;
 }
 
+void DataStream::setTimeline(const shared_ptr<StreamTimeline>& timeline)
+{
+    m_timeline = timeline;
+}
+
+const shared_ptr<StreamTimeline>& DataStream::getTimeline() const
+{
+    return m_timeline;
+}
+
+const string& DataStream::getSourceName() const
+{
+    return m_sourceName;
+}
+
+const TradingSession& DataStream::getSession() const
+{
+    return m_session;
+}
+
 int DataStream::cloneSharedBarFeed(vector<BarFeed*>& feeds)
 {
     feeds.clear();
@@ -91,12 +125,12 @@ BarFeed* DataStream::cloneSharedBarFeed(const string& instrument)
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-unsigned long DataStorage::m_nextBarFeedId = 0;
-unsigned long DataStorage::m_nextDataStreamId = 0;
+std::atomic<unsigned long> DataStorage::m_nextBarFeedId(0);
+std::atomic<unsigned long> DataStorage::m_nextDataStreamId(0);
 
 DataStorage::DataStorage()
 {
-
+    m_timelineEnabled = false;
 }
 
 DataStorage::~DataStorage()
@@ -118,57 +152,164 @@ unsigned long DataStorage::getNextDataStreamId()
     return ++m_nextDataStreamId;
 }
 
-bool DataStorage::loadCsvFile(const string& name, const string& filename, int resolution, int interval, const Contract& contract)
+void DataStorage::setCacheDirectory(const string& dir)
 {
-    return false;
+    m_mappedCsvFileLoader.setCacheDirectory(dir);
 }
 
-bool DataStorage::loadTsFile(const string& name, const string& filename, int resolution, int interval, const Contract& contract)
+const string& DataStorage::getCacheDirectory() const
 {
-#if 0
-    DataStream* stream = new DataStream();
-    bool ret = m_tsFileLoader.loadTsFile(name, resolution, filename, contract, stream);
-    if (!ret) {
-        delete stream;
-        return false;
+    return m_mappedCsvFileLoader.getCacheDirectory();
+}
+
+void DataStorage::setStreamingWindow(int items)
+{
+    m_binFileLoader.setStreamingWindow(items);
+}
+
+int DataStorage::getStreamingWindow() const
+{
+    return m_binFileLoader.getStreamingWindow();
+}
+
+void DataStorage::enableTimeline(bool enable)
+{
+    m_timelineEnabled = enable;
+}
+
+bool DataStorage::isTimelineEnabled() const
+{
+    return m_timelineEnabled;
+}
+
+bool DataStorage::loadTimeline(DataStream* stream, const string& filename, bool cached)
+{
+    const vector<BarFeed*>& feeds = stream->getBarFeeds();
+    string file = StreamTimeline::getTimelineFileName(filename);
+
+    shared_ptr<StreamTimeline> timeline;
+    if (cached) {
+        timeline = StreamTimeline::load(file, filename, feeds);
+    }
+    if (timeline == nullptr) {
+        timeline = StreamTimeline::build(feeds);
+        if (cached) {
+            timeline->write(file, filename, feeds);
+        }
     }
-    
-    m_dataStreams.insert(std::make_pair(name, stream));
+
+    stream->setTimeline(timeline);
 
     return true;
+}
+
+bool DataStorage::loadCsvFile(const string& name, const string& filename, int resolution, int interval, const Contract& contract, const DataRange& range, DataStream* stream)
+{
+    if (resolution == Bar::TICK) {
+        // Ticks carry quotes besides OHLC, only the generic parser handles them.
+        string file = filename;
+        return m_csvFileLoader.loadCsvFile(name, resolution, file, contract, range, stream);
+    }
+
+    return m_mappedCsvFileLoader.loadCsvFile(name, resolution, interval, filename, contract, range, stream);
+}
+
+bool DataStorage::loadTsFile(const string& name, const string& filename, int resolution, int interval, const Contract& contract, const DataRange& range, DataStream* stream)
+{
+#if 0
+    return m_tsFileLoader.loadTsFile(name, resolution, filename, contract, stream);
 #endif
 	return false;
 }
 
-bool DataStorage::loadBinFile(const string& name, const string& filename, int resolution, int interval, const Contract& contract)
+bool DataStorage::loadBinFile(const string& name, const string& filename, int resolution, int interval, const Contract& contract, const DataRange& range, DataStream* stream)
+{
+    return m_binFileLoader.loadBinFile(name, resolution, interval, filename, contract, range, stream);
+}
+
+bool DataStorage::loadColumnarFile(const string& name, const string& filename, int resolution, int interval, const Contract& contract, const DataRange& range, DataStream* stream)
+{
+    return m_columnarFileLoader.loadColumnarFile(name, resolution, interval, filename, contract, range, stream);
+}
+
+bool DataStorage::loadCompressedFile(const string& name, const string& filename, int resolution, int interval, const Contract& contract, const DataRange& range, DataStream* stream)
+{
+    return m_compressedFileLoader.loadCompressedFile(name, resolution, interval, filename, contract, range, stream);
+}
+
+DataStream* DataStorage::prepareDataStream(const string& name, const string& filename, int format, int resolution, int interval, const Contract& contract, const DataRange& range)
 {
     DataStream* stream = new DataStream();
-    bool ret = m_binFileLoader.loadBinFile(name, resolution, interval, filename, contract, stream);
+    bool ret = false;
+
+    if (format == DATA_FILE_FORMAT_BIN) {
+        ret = loadBinFile(name, filename, resolution, interval, contract, range, stream);
+    } else if (format == DATA_FILE_FORMAT_CSV) {
+        ret = loadCsvFile(name, filename, resolution, interval, contract, range, stream);
+    } else if (format == DATA_FILE_FORMAT_TS) {
+        ret = loadTsFile(name, filename, resolution, interval, contract, range, stream);
+    } else if (format == DATA_FILE_FORMAT_COL) {
+        ret = loadColumnarFile(name, filename, resolution, interval, contract, range, stream);
+    } else if (format == DATA_FILE_FORMAT_CMP) {
+        ret = loadCompressedFile(name, filename, resolution, interval, contract, range, stream);
+    }
+
     if (!ret) {
+        delete stream;
+        return nullptr;
+    }
+
+    if (m_timelineEnabled) {
+        loadTimeline(stream, filename, range.isAll());
+    }
+
+    return stream;
+}
+
+DataStream* DataStorage::prepareContinuousDataStream(const string& name, const string& filename, const string& instrument, int adjustment, int resolution, int interval, const Contract& contract, const DataRange& range)
+{
+    string file = ContinuousContract::getContinuousFileName(filename, instrument, adjustment);
+    if (!ContinuousContract::update(filename, file, instrument, adjustment)) {
+        return nullptr;
+    }
+
+    return prepareDataStream(name, file, DATA_FILE_FORMAT_BIN, resolution, interval, contract, range);
+}
+
+bool DataStorage::registerDataStream(DataStream* stream)
+{
+    Utils::Lock lock(m_mutex);
+
+    if (m_dataStreams.find(stream->getName()) != m_dataStreams.end()) {
         delete stream;
         return false;
     }
 
-    m_dataStreams.insert(std::make_pair(name, stream));
+    stream->setId(getNextDataStreamId());
+    for (auto& feed : stream->getBarFeeds()) {
+        feed->setId(getNextBarFeedId());
+        feed->setDataStreamId(stream->getId());
+    }
+
+    m_dataStreams.insert(std::make_pair(stream->getName(), stream));
 
     return true;
 }
 
-bool DataStorage::loadDataStreamFile(const string& name, const string& filename, int format, int resolution, int interval, const Contract& contract)
+bool DataStorage::loadDataStreamFile(const string& name, const string& filename, int format, int resolution, int interval, const Contract& contract, const DataRange& range)
 {
-    if (format == DATA_FILE_FORMAT_BIN) {
-        return loadBinFile(name,filename, resolution, interval, contract);
-    } else if (format == DATA_FILE_FORMAT_CSV) {
-        return loadCsvFile(name,filename, resolution, interval, contract);
-    } else if (format == DATA_FILE_FORMAT_TS) {
-        return loadTsFile(name,filename, resolution, interval, contract);
+    DataStream* stream = prepareDataStream(name, filename, format, resolution, interval, contract, range);
+    if (stream == nullptr) {
+        return false;
     }
 
-    return false;
+    return registerDataStream(stream);
 }
 
 DataStream* DataStorage::getDataStream(const string& name)
 {
+    Utils::Lock lock(m_mutex);
+
     const auto& itor = m_dataStreams.find(name);
     if (itor != m_dataStreams.end()) {
         return itor->second;
@@ -179,6 +320,8 @@ DataStream* DataStorage::getDataStream(const string& name)
 
 DataStream* DataStorage::getDataStream(int id)
 {
+    Utils::Lock lock(m_mutex);
+
     for (auto& stream : m_dataStreams) {
         if (stream.second->getId() == id) {
             return stream.second;
@@ -190,6 +333,8 @@ DataStream* DataStorage::getDataStream(int id)
 
 int DataStorage::getDataStreamId(const string& name)
 {
+    Utils::Lock lock(m_mutex);
+
     const auto& itor = m_dataStreams.find(name);
     if (itor != m_dataStreams.end()) {
         return itor->second->getId();
@@ -200,16 +345,26 @@ int DataStorage::getDataStreamId(const string& name)
 
 int DataStorage::getAllDataStream(vector<DataStream*>& streams)
 {
+    Utils::Lock lock(m_mutex);
+
     streams.clear();
     for (auto& stream : m_dataStreams) {
         streams.push_back(stream.second);
     }
 
+    // In order of registration, so streams composed of others come after
+    // their sources and are dispatched after them at the same time.
+    std::sort(streams.begin(), streams.end(), [](const DataStream* s1, const DataStream* s2) {
+        return s1->getId() < s2->getId();
+    });
+
     return streams.size();
 }
 
 BarFeed* DataStorage::createSharedBarFeed(const string& instrument, int resolution, int interval)
 {
+    Utils::Lock lock(m_mutex);
+
     for (auto& stream : m_dataStreams) {
         for (auto& feed : stream.second->getBarFeeds()) {
             if (feed->getInstrument() == instrument &&
@@ -223,4 +378,84 @@ BarFeed* DataStorage::createSharedBarFeed(const string& instrument, int resoluti
     return nullptr;
 }
 
+static bool isSameSession(const TradingSession& s1, const TradingSession& s2)
+{
+    if (s1.size() != s2.size()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < s1.size(); i++) {
+        if (s1[i].begin != s2[i].begin || s1[i].end != s2[i].end) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool DataStorage::composeDataStream(const string& name, const string& source, const TradingSession& session, int resolution, int interval)
+{
+    DataStream* base = getDataStream(source);
+    if (base == nullptr) {
+        Logger_Err() << "Data stream '" << source << "' isn't loaded.";
+        return false;
+    }
+
+    string sourceName = base->getSourceName().empty() ? base->getName() : base->getSourceName();
+
+    {
+        Utils::Lock lock(m_mutex);
+
+        // Pick the coarsest level composed so far, periods of composable
+        // levels divide each other. Equal periods are taken by name so the
+        // choice doesn't depend on the order of the map.
+        long basePeriod = 0;
+        for (auto& item : m_dataStreams) {
+            DataStream* level = item.second;
+            if (level->getSourceName() != sourceName ||
+                !isSameSession(level->getSession(), session) ||
+                !BarPyramid::isComposable(level->getResolution(), level->getInterval(), resolution, interval) ||
+                !BarPyramid::isComposable(base->getResolution(), base->getInterval(), level->getResolution(), level->getInterval())) {
+                continue;
+            }
+
+            long period = (long)level->getResolution() * level->getInterval();
+            if (period > basePeriod ||
+                (period == basePeriod && level->getName() < base->getName())) {
+                base = level;
+                basePeriod = period;
+            }
+        }
+    }
+
+    DataStream* stream = new DataStream();
+    if (!m_barPyramid.composeDataStream(name, base, session, resolution, interval, stream)) {
+        delete stream;
+        return false;
+    }
+
+    stream->m_sourceName = sourceName;
+    stream->m_session    = session;
+
+    if (m_timelineEnabled) {
+        stream->setTimeline(StreamTimeline::build(stream->getBarFeeds()));
+    }
+
+    return registerDataStream(stream);
+}
+
+string DataStorage::getComposedStreamName(const string& source, int resolution, int interval)
+{
+    const char* unit = "s";
+    if (resolution == Bar::DAY) {
+        unit = "d";
+    } else if (resolution == Bar::HOUR) {
+        unit = "h";
+    } else if (resolution == Bar::MINUTE) {
+        unit = "m";
+    }
+
+    return source + "@" + std::to_string(interval) + unit;
+}
+
 } // namespace xBacktest
\ No newline at end of file
@@ -1,8 +1,17 @@
 #ifndef DATA_STORAGE_H
 #define DATA_STORAGE_H
 
+#include <atomic>
+#include <cassert>
+#include "Lock.h"
 #include "CsvFileLoader.h"
 #include "BinFileLoader.h"
+#include "ColumnarFileLoader.h"
+#include "CompressedFileLoader.h"
+#include "MappedCsvFileLoader.h"
+#include "MergedBarFeed.h"
+#include "BarPyramid.h"
+#include "ContinuousContract.h"
 //#include "TsFileLoader.h"
 
 namespace xBacktest
@@ -21,7 +30,9 @@ public:
     void              setName(const string& name);
     const string&     getName() const;
     void              setResolution(int resolution);
+    int               getResolution() const;
     void              setInterval(int interval);
+    int               getInterval() const;
     void              setCommonContract(const Contract& contract);
     const Contract&   getCommonContract() const;
     void              insertBarFeed(BarFeed* feed);
@@ -33,6 +44,16 @@ public:
     BarFeed*          cloneSharedBarFeed(const string& instrument);
     int               cloneSharedBarFeed(vector<BarFeed*>& feeds);
 
+    // Merged timeline of all feeds, nullptr unless timelines are enabled
+    // in data storage.
+    void              setTimeline(const shared_ptr<StreamTimeline>& timeline);
+    const shared_ptr<StreamTimeline>& getTimeline() const;
+
+    // Name of the stream loaded from file which this stream is composed of,
+    // empty if it's loaded from file itself.
+    const string&     getSourceName() const;
+    const TradingSession& getSession() const;
+
 private:
     DataStream();
     ~DataStream();
@@ -46,8 +67,11 @@ private:
     int              m_interval;
     vector<BarFeed*> m_barFeeds;
     Contract         m_commContract;
+    shared_ptr<StreamTimeline> m_timeline;
+    string           m_sourceName;
+    TradingSession   m_session;
 
-    static unsigned long m_nextId;
+    static std::atomic<unsigned long> m_nextId;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -58,7 +82,22 @@ public:
     DataStorage();
     ~DataStorage();
 
-    bool loadDataStreamFile(const string& name, const string& filename, int format, int resolution, int interval, const Contract& contract);
+    // Load and register a data stream, equals to prepareDataStream() followed
+    // by registerDataStream().
+    bool loadDataStreamFile(const string& name, const string& filename, int format, int resolution, int interval, const Contract& contract, const DataRange& range = DataRange());
+
+    // Map and scan a data stream file without assigning any id. Safe to call
+    // concurrently, returns nullptr on failure. Only feeds and rows within
+    // `range` are scanned and kept, segment boundaries are found by binary
+    // search so the rest of the file is left untouched where the format
+    // allows it.
+    DataStream* prepareDataStream(const string& name, const string& filename, int format, int resolution, int interval, const Contract& contract, const DataRange& range = DataRange());
+    // Same as prepareDataStream() on the continuous contract `instrument` of
+    // binary file `filename`, which is built next to it unless it's up to date.
+    DataStream* prepareContinuousDataStream(const string& name, const string& filename, const string& instrument, int adjustment, int resolution, int interval, const Contract& contract, const DataRange& range = DataRange());
+    // Assign ids of the stream and its feeds, then make it visible. Streams
+    // registered in the same order always get the same ids.
+    bool registerDataStream(DataStream* stream);
 
     DataStream* getDataStream(const string& name);
     DataStream* getDataStream(int id);
@@ -66,20 +105,60 @@ public:
     int getAllDataStream(vector<DataStream*>& streams);
     BarFeed* createSharedBarFeed(const string& instrument, int resolution, int interval = 0);
 
+    // Compose bars of `resolution` and `interval` out of the registered
+    // stream `source` once, and register them as stream `name`. Bars are
+    // built from the coarsest stream already composed out of the same file
+    // and session that they are made of, so levels should be composed from
+    // the finest one.
+    bool composeDataStream(const string& name, const string& source, const TradingSession& session, int resolution, int interval = 1);
+    // Default name of a composed stream, e.g. 'rb@5m'.
+    static string getComposedStreamName(const string& source, int resolution, int interval);
+
+    // Parsed CSV files are cached under this directory, empty disables the
+    // cache. Defaults to a directory under the system temporary directory.
+    void setCacheDirectory(const string& dir);
+    const string& getCacheDirectory() const;
+
+    // Binary files are streamed through per feed windows of this many items
+    // instead of being mapped as a whole, 0 (default) disables streaming.
+    // Timestamps of all items stay in memory, see BinFileLoader.
+    void setStreamingWindow(int items);
+    int  getStreamingWindow() const;
+
+    // Merge feeds of every loaded stream into a timeline, so executors
+    // replay a stream as one subject. Timelines are saved next to data
+    // files and reused by later loads.
+    void enableTimeline(bool enable);
+    bool isTimelineEnabled() const;
+
     static unsigned long getNextDataStreamId();
     static unsigned long getNextBarFeedId();
 
 private:
-    bool loadCsvFile(const string& name, const string& filename, int resolution, int interval, const Contract& contract);
-    bool loadTsFile(const string& name, const string& filename, int resolution, int interval, const Contract& contract);
-    bool loadBinFile(const string& name, const string& filename, int resolution, int interval, const Contract& contract);
+    bool loadCsvFile(const string& name, const string& filename, int resolution, int interval, const Contract& contract, const DataRange& range, DataStream* stream);
+    bool loadTsFile(const string& name, const string& filename, int resolution, int interval, const Contract& contract, const DataRange& range, DataStream* stream);
+    bool loadBinFile(const string& name, const string& filename, int resolution, int interval, const Contract& contract, const DataRange& range, DataStream* stream);
+    // `cached` reuses and saves the timeline file, which always covers the
+    // whole data file.
+    bool loadTimeline(DataStream* stream, const string& filename, bool cached);
+    bool loadColumnarFile(const string& name, const string& filename, int resolution, int interval, const Contract& contract, const DataRange& range, DataStream* stream);
+    bool loadCompressedFile(const string& name, const string& filename, int resolution, int interval, const Contract& contract, const DataRange& range, DataStream* stream);
 
 private:
-    static unsigned long m_nextBarFeedId;
-    static unsigned long m_nextDataStreamId;
+    // Feeds are also cloned by executors running in parallel.
+    static std::atomic<unsigned long> m_nextBarFeedId;
+    static std::atomic<unsigned long> m_nextDataStreamId;
+
+    Utils::Mutex m_mutex;
+
+    bool m_timelineEnabled;
 
     CsvFileLoader m_csvFileLoader;
+    MappedCsvFileLoader m_mappedCsvFileLoader;
     BinFileLoader m_binFileLoader;
+    ColumnarFileLoader m_columnarFileLoader;
+    CompressedFileLoader m_compressedFileLoader;
+    BarPyramid m_barPyramid;
 //    TsFileLoader  m_tsFileLoader;
 
     unordered_map<string, DataStream*> m_dataStreams;
@@ -0,0 +1,1150 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <unordered_map>
+#include <cstdlib>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CSV_SCAN_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#include <boost/filesystem.hpp>
+
+#include "Logger.h"
+#include "Utils.h"
+#include "ThreadPool.h"
+#include "MappedCsvFileLoader.h"
+#include "DataStorage.h"
+
+namespace xBacktest
+{
+
+// Files smaller than this are parsed by a single thread.
+static const size_t CSV_MIN_CHUNK_SIZE = 4 * 1024 * 1024;
+
+static const int CSV_MAX_FIELDS = 64;
+
+static const char CSV_CACHE_MAGIC[8] = "XBTCSV1";
+// Bump whenever parsing rules or cache layout change.
+static const uint32_t CSV_CACHE_VERSION = 1;
+
+////////////////////////////////////////////////////////////////////////////////
+// Scanning and fixed-format parsers.
+
+typedef struct {
+    const char* begin;
+    const char* end;
+} CsvField;
+
+#ifdef CSV_SCAN_SSE2
+static inline int lowestBit(unsigned int mask)
+{
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward(&idx, mask);
+    return (int)idx;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+// Returns the first ',', '\n' or '"' in [p, end), or end if there isn't one.
+static inline const char* findStructuralChar(const char* p, const char* end)
+{
+#ifdef CSV_SCAN_SSE2
+    const __m128i comma   = _mm_set1_epi8(',');
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i quote   = _mm_set1_epi8('"');
+
+    while (end - p >= 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)p);
+        __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, comma),
+                                                 _mm_cmpeq_epi8(block, newline)),
+                                    _mm_cmpeq_epi8(block, quote));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(hits);
+        if (mask != 0) {
+            return p + lowestBit(mask);
+        }
+        p += 16;
+    }
+#endif
+
+    while (p < end && *p != ',' && *p != '\n' && *p != '"') {
+        p++;
+    }
+
+    return p;
+}
+
+// Returns the end of the current line (pointing to '\n' or end).
+static inline const char* findLineEnd(const char* p, const char* end)
+{
+    const char* pos = (const char*)memchr(p, '\n', end - p);
+    return pos != nullptr ? pos : end;
+}
+
+// Split one line into fields, `p` must point to the beginning of the line.
+// Returns the number of fields and sets `next` to the beginning of next line.
+static int splitLine(const char* p, const char* end, CsvField* fields, const char*& next)
+{
+    int num = 0;
+
+    while (true) {
+        CsvField field;
+        field.begin = p;
+
+        const char* pos = findStructuralChar(p, end);
+        if (pos < end && *pos == '"') {
+            // Enclosed field, take the content between quotes.
+            const char* lineEnd = findLineEnd(pos + 1, end);
+            const char* close = (const char*)memchr(pos + 1, '"', lineEnd - pos - 1);
+            while (close != nullptr && close + 1 < lineEnd && close[1] == '"') {
+                close = (const char*)memchr(close + 2, '"', lineEnd - close - 2);
+            }
+            if (close == nullptr) {
+                close = lineEnd;
+            }
+            field.begin = pos + 1;
+            field.end = close;
+            pos = close < lineEnd ? findStructuralChar(close + 1, end) : lineEnd;
+            // Ignore anything else between closing quote and delimiter.
+            while (pos < end && *pos == '"') {
+                pos = findStructuralChar(pos + 1, end);
+            }
+        } else {
+            field.end = pos;
+        }
+
+        if (num < CSV_MAX_FIELDS) {
+            fields[num++] = field;
+        }
+
+        if (pos >= end || *pos == '\n') {
+            // Strip '\r' of the last field.
+            if (num > 0 && fields[num - 1].end > fields[num - 1].begin && fields[num - 1].end[-1] == '\r') {
+                fields[num - 1].end--;
+            }
+            next = pos < end ? pos + 1 : end;
+            break;
+        }
+
+        p = pos + 1;
+    }
+
+    return num;
+}
+
+static inline void trimField(CsvField& field)
+{
+    while (field.begin < field.end && (*field.begin == ' ' || *field.begin == '\t')) {
+        field.begin++;
+    }
+    while (field.end > field.begin && (field.end[-1] == ' ' || field.end[-1] == '\t' || field.end[-1] == '\r')) {
+        field.end--;
+    }
+}
+
+static inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// Parse up to `maxDigits` digits, returns the number of digits parsed.
+static inline int parseDigits(const char*& p, const char* end, int maxDigits, int& value)
+{
+    int num = 0;
+    value = 0;
+    while (p < end && num < maxDigits && isDigit(*p)) {
+        value = value * 10 + (*p - '0');
+        p++;
+        num++;
+    }
+    return num;
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date.
+static inline int64 daysFromCivil(int year, int month, int day)
+{
+    year -= month <= 2;
+    const int64 era = (year >= 0 ? year : year - 399) / 400;
+    const int64 yoe = year - era * 400;
+    const int64 doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int64 doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+// HH:MM[:SS[.mmm]] or HHMMSS, returns milliseconds since midnight or -1.
+static int64 parseTimeOfDay(const char* p, const char* end)
+{
+    if (p >= end) {
+        return 0;
+    }
+
+    const char* start = p;
+    int hour = 0, minute = 0, second = 0, ms = 0;
+    int value = 0;
+    int digits = parseDigits(p, end, 6, value);
+    if (digits == 0) {
+        return -1;
+    }
+
+    if (p < end && *p == ':') {
+        hour = value;
+        p++;
+        if (parseDigits(p, end, 2, minute) == 0) {
+            return -1;
+        }
+        if (p < end && *p == ':') {
+            p++;
+            if (parseDigits(p, end, 2, second) == 0) {
+                return -1;
+            }
+        }
+    } else if (p - start == digits && (p == end || *p == '.')) {
+        // Compact HHMMSS (leading zero may be dropped, e.g. 93000) or HHMM.
+        if (digits <= 4) {
+            hour = value / 100;
+            minute = value % 100;
+        } else {
+            hour = value / 10000;
+            minute = (value % 10000) / 100;
+            second = value % 100;
+        }
+    } else {
+        return -1;
+    }
+
+    if (p < end && *p == '.') {
+        p++;
+        int msDigits = parseDigits(p, end, 3, ms);
+        for (; msDigits > 0 && msDigits < 3; msDigits++) {
+            ms *= 10;
+        }
+        while (p < end && isDigit(*p)) {
+            p++;
+        }
+    }
+
+    if (p != end || hour > 23 || minute > 59 || second > 60) {
+        return -1;
+    }
+
+    return (int64)(hour * 3600 + minute * 60 + second) * 1000 + ms;
+}
+
+// YYYYMMDD, YYYY-MM-DD or YYYY/MM/DD, optionally followed by ' ' or 'T' and
+// a time. Returns milliseconds since the Epoch, false if malformed.
+static bool parseDateTime(const char* p, const char* end, int64& ticks)
+{
+    int year = 0, month = 0, day = 0;
+    if (parseDigits(p, end, 4, year) != 4) {
+        return false;
+    }
+
+    if (p < end && isDigit(*p)) {
+        if (parseDigits(p, end, 2, month) != 2 || parseDigits(p, end, 2, day) != 2) {
+            return false;
+        }
+    } else if (p < end && (*p == '-' || *p == '/' || *p == '.')) {
+        char sep = *p++;
+        if (parseDigits(p, end, 2, month) == 0 || p >= end || *p != sep) {
+            return false;
+        }
+        p++;
+        if (parseDigits(p, end, 2, day) == 0) {
+            return false;
+        }
+    } else {
+        return false;
+    }
+
+    if (month < 1 || month > 12 || day < 1 || day > 31) {
+        return false;
+    }
+
+    int64 timeOfDay = 0;
+    if (p < end) {
+        if (*p != ' ' && *p != 'T') {
+            return false;
+        }
+        while (p < end && (*p == ' ' || *p == 'T')) {
+            p++;
+        }
+        timeOfDay = parseTimeOfDay(p, end);
+        if (timeOfDay < 0) {
+            return false;
+        }
+    }
+
+    ticks = daysFromCivil(year, month, day) * 86400000LL + timeOfDay;
+
+    return true;
+}
+
+static const double POW10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Same result as atof(), plain decimals are converted without strtod: a
+// mantissa below 2^53 divided by an exact power of ten is correctly rounded.
+static double parseDouble(const char* p, const char* end)
+{
+    const char* start = p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        p++;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int fraction = 0;
+    while (p < end && isDigit(*p)) {
+        mantissa = mantissa * 10 + (*p - '0');
+        digits++;
+        p++;
+    }
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && isDigit(*p)) {
+            mantissa = mantissa * 10 + (*p - '0');
+            digits++;
+            fraction++;
+            p++;
+        }
+    }
+
+    if (p == end && digits <= 18 && mantissa < (1ULL << 53) && fraction <= 22) {
+        double value = (double)mantissa / POW10[fraction];
+        return negative ? -value : value;
+    }
+
+    if (p == start) {
+        return 0.0;
+    }
+
+    // Exponents, very long numbers or trailing garbage.
+    char buf[64];
+    size_t len = std::min<size_t>(end - start, sizeof(buf) - 1);
+    memcpy(buf, start, len);
+    buf[len] = '\0';
+    return atof(buf);
+}
+
+static bool matchName(const CsvField& field, const char* name)
+{
+    size_t len = strlen(name);
+    if ((size_t)(field.end - field.begin) != len) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (tolower((unsigned char)field.begin[i]) != name[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Chunk parsing.
+
+typedef struct {
+    vector<string>                    instruments; // in order of first appearance.
+    unordered_map<string, uint32_t>   instrumentIdxs;
+    vector<uint32_t>                  rowInstruments;
+    vector<int64>                     timestamps;
+    vector<double>                    columns[MappedCsvFileLoader::COL_NUM];
+    size_t                            errorLine;    // first malformed line in chunk, 0 if none.
+    size_t                            lineNum;
+} CsvChunk;
+
+static void parseChunk(const char* begin, const char* end, const int* columnIdxs, const string& defaultInstrument, CsvChunk& chunk)
+{
+    CsvField fields[CSV_MAX_FIELDS];
+
+    chunk.errorLine = 0;
+    chunk.lineNum = 0;
+
+    // Rough guess, 48 bytes per line.
+    size_t reserved = (end - begin) / 48 + 1;
+    chunk.rowInstruments.reserve(reserved);
+    chunk.timestamps.reserve(reserved);
+    for (int c = MappedCsvFileLoader::COL_OPEN; c < MappedCsvFileLoader::COL_NUM; c++) {
+        if (columnIdxs[c] >= 0) {
+            chunk.columns[c].reserve(reserved);
+        }
+    }
+
+    int instrumentIdx = columnIdxs[MappedCsvFileLoader::COL_INSTRUMENT];
+    int dateIdx       = columnIdxs[MappedCsvFileLoader::COL_DATE];
+    int timeIdx       = columnIdxs[MappedCsvFileLoader::COL_TIME];
+    int maxIdx = 0;
+    for (int c = 0; c < MappedCsvFileLoader::COL_NUM; c++) {
+        maxIdx = std::max(maxIdx, columnIdxs[c]);
+    }
+
+    // Instrument of the last row, rows of one instrument are usually adjacent.
+    string lastInstrument;
+    uint32_t lastIdx = 0;
+    bool hasLast = false;
+
+    const char* p = begin;
+    while (p < end) {
+        const char* next = nullptr;
+        int num = splitLine(p, end, fields, next);
+        p = next;
+        chunk.lineNum++;
+
+        // Blank line.
+        if (num == 1 && fields[0].begin == fields[0].end) {
+            continue;
+        }
+
+        if (num <= maxIdx) {
+            if (chunk.errorLine == 0) {
+                chunk.errorLine = chunk.lineNum;
+            }
+            continue;
+        }
+
+        int64 ticks = 0;
+        CsvField dateField = fields[dateIdx];
+        trimField(dateField);
+        if (!parseDateTime(dateField.begin, dateField.end, ticks)) {
+            if (chunk.errorLine == 0) {
+                chunk.errorLine = chunk.lineNum;
+            }
+            continue;
+        }
+        if (timeIdx >= 0) {
+            CsvField timeField = fields[timeIdx];
+            trimField(timeField);
+            int64 timeOfDay = parseTimeOfDay(timeField.begin, timeField.end);
+            if (timeOfDay < 0) {
+                if (chunk.errorLine == 0) {
+                    chunk.errorLine = chunk.lineNum;
+                }
+                continue;
+            }
+            ticks += timeOfDay;
+        }
+
+        uint32_t idx = 0;
+        if (instrumentIdx >= 0) {
+            CsvField field = fields[instrumentIdx];
+            trimField(field);
+            size_t len = field.end - field.begin;
+            if (!hasLast || lastInstrument.size() != len || memcmp(lastInstrument.data(), field.begin, len) != 0) {
+                lastInstrument.assign(field.begin, len);
+                auto itor = chunk.instrumentIdxs.find(lastInstrument);
+                if (itor == chunk.instrumentIdxs.end()) {
+                    lastIdx = (uint32_t)chunk.instruments.size();
+                    chunk.instruments.push_back(lastInstrument);
+                    chunk.instrumentIdxs.insert(std::make_pair(lastInstrument, lastIdx));
+                } else {
+                    lastIdx = itor->second;
+                }
+                hasLast = true;
+            }
+            idx = lastIdx;
+        } else {
+            if (chunk.instruments.empty()) {
+                chunk.instruments.push_back(defaultInstrument);
+            }
+            idx = 0;
+        }
+
+        chunk.rowInstruments.push_back(idx);
+        chunk.timestamps.push_back(ticks);
+        for (int c = MappedCsvFileLoader::COL_OPEN; c < MappedCsvFileLoader::COL_NUM; c++) {
+            if (columnIdxs[c] >= 0) {
+                CsvField field = fields[columnIdxs[c]];
+                trimField(field);
+                chunk.columns[c].push_back(parseDouble(field.begin, field.end));
+            }
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+MappedCsvFileLoader::MappedCsvBarFeed::MappedCsvBarFeed(
+    const string& instrument,
+    int resolution,
+    const shared_ptr<void>& holder,
+    const int64* timestamps,
+    const double* const* columns,
+    size_t begin)
+    : BarFeed(resolution)
+{
+    setInstrument(instrument);
+    m_readIdx    = 0;
+    m_holder     = holder;
+    m_timestamps = timestamps + begin;
+    m_opens      = columns[COL_OPEN] + begin;
+    m_highs      = columns[COL_HIGH] + begin;
+    m_lows       = columns[COL_LOW] + begin;
+    m_closes     = columns[COL_CLOSE] + begin;
+    m_volumes    = columns[COL_VOLUME] + begin;
+    m_openInts   = columns[COL_OPENINT] + begin;
+    m_amounts    = columns[COL_AMOUNT] + begin;
+}
+
+bool MappedCsvFileLoader::MappedCsvBarFeed::reset()
+{
+    m_readIdx = 0;
+    return true;
+}
+
+void MappedCsvFileLoader::MappedCsvBarFeed::getBar(int idx, Bar& outBar) const
+{
+    outBar = Bar(getInstrumentId(),
+        DateTime(m_timestamps[idx]),
+        m_opens[idx],
+        m_highs[idx],
+        m_lows[idx],
+        m_closes[idx],
+        (long long)m_volumes[idx],
+        (long long)m_openInts[idx],
+        getResolution());
+    outBar.setAmount(m_amounts[idx]);
+}
+
+bool MappedCsvFileLoader::MappedCsvBarFeed::getNextBar(Bar& outBar)
+{
+    if (m_readIdx < getLength()) {
+        getBar(m_readIdx, outBar);
+        m_readIdx++;
+        return true;
+    }
+
+    return false;
+}
+
+int MappedCsvFileLoader::MappedCsvBarFeed::loadData(
+    int   reqId,
+    const DataRequest& request,
+    void* object,
+    void (*callback)(const DateTime& datetime, void* ctx))
+{
+    if (request.instrument != getInstrument()) {
+        return 0;
+    }
+
+    int64 to = request.to.ticks();
+    const int64* end = m_timestamps + getLength();
+
+    int first = 0;
+    int count = 0;
+    if (request.type == BarsBack) {
+        const int64* pos = std::lower_bound(m_timestamps, end, to);
+        int idx = pos - m_timestamps;
+        if (pos == end || *pos != to || idx <= request.count - 1) {
+            return 0;
+        }
+        first = idx - request.count;
+        count = request.count;
+    } else if (request.type == DateTimeRange) {
+        const int64* lower = std::lower_bound(m_timestamps, end, request.from.ticks());
+        const int64* upper = std::upper_bound(lower, end, to);
+        first = lower - m_timestamps;
+        count = upper - lower;
+        if (count <= 0) {
+            return 0;
+        }
+    } else {
+        return 0;
+    }
+
+    for (int i = first; i < first + count; i++) {
+        HistoricalDataContext ctx;
+        ctx.reqId        = reqId;
+        ctx.dataStreamId = getDataStreamId();
+        ctx.barFeedId    = getId();
+        ctx.object       = object;
+        getBar(i, ctx.bar);
+        roundPrices(ctx.bar);
+        callback(ctx.bar.getDateTime(), &ctx);
+    }
+
+    return count;
+}
+
+MappedCsvFileLoader::MappedCsvBarFeed* MappedCsvFileLoader::MappedCsvBarFeed::clone()
+{
+    MappedCsvBarFeed* feed = new MappedCsvFileLoader::MappedCsvBarFeed(*this);
+    feed->reset();
+    feed->setId(DataStorage::getNextBarFeedId());
+
+    return feed;
+}
+
+const DateTime MappedCsvFileLoader::MappedCsvBarFeed::peekDateTime() const
+{
+    return DateTime(m_timestamps[m_readIdx]);
+}
+
+bool MappedCsvFileLoader::MappedCsvBarFeed::eof()
+{
+    return m_readIdx >= getLength();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+MappedCsvFileLoader::MappedCsvFileLoader()
+{
+    m_cacheDir = getDefaultCacheDirectory();
+    m_dataStreamDescs.clear();
+}
+
+MappedCsvFileLoader::~MappedCsvFileLoader()
+{
+    for (size_t i = 0; i < m_barFeeds.size(); i++) {
+        delete m_barFeeds[i];
+    }
+    m_barFeeds.clear();
+    m_dataStreamDescs.clear();
+}
+
+bool MappedCsvFileLoader::parseFile(const string& file, const string& defaultInstrument, int threadNum, CsvTable& table)
+{
+    boost::iostreams::mapped_file_source mappedFile;
+    try {
+        mappedFile.open(file);
+    } catch (exception &e) {
+        Logger_Err() << "Failed to open '" << file << "': " << e.what();
+        return false;
+    }
+
+    if (!mappedFile.is_open() || mappedFile.size() == 0) {
+        return false;
+    }
+
+    const char* begin = mappedFile.data();
+    const char* end = begin + mappedFile.size();
+
+    // Skip UTF-8 BOM.
+    if (end - begin >= 3 && memcmp(begin, "\xEF\xBB\xBF", 3) == 0) {
+        begin += 3;
+    }
+
+    // Title.
+    CsvField fields[CSV_MAX_FIELDS];
+    const char* body = nullptr;
+    int num = splitLine(begin, end, fields, body);
+
+    int columnIdxs[COL_NUM];
+    for (int c = 0; c < COL_NUM; c++) {
+        columnIdxs[c] = -1;
+    }
+
+    static const struct {
+        int         column;
+        const char* name;
+    } titles[] = {
+        { COL_INSTRUMENT, "instrument" },
+        { COL_INSTRUMENT, "symbol" },
+        { COL_INSTRUMENT, "code" },
+        { COL_DATE,       "date" },
+        { COL_DATE,       "datetime" },
+        { COL_TIME,       "time" },
+        { COL_OPEN,       "open" },
+        { COL_HIGH,       "high" },
+        { COL_LOW,        "low" },
+        { COL_CLOSE,      "close" },
+        { COL_VOLUME,     "volume" },
+        { COL_OPENINT,    "openint" },
+        { COL_OPENINT,    "open_interest" },
+        { COL_AMOUNT,     "amount" },
+        { COL_AMOUNT,     "turnover" },
+    };
+
+    for (int i = 0; i < num; i++) {
+        CsvField field = fields[i];
+        trimField(field);
+        for (size_t j = 0; j < sizeof(titles) / sizeof(titles[0]); j++) {
+            if (columnIdxs[titles[j].column] < 0 && matchName(field, titles[j].name)) {
+                columnIdxs[titles[j].column] = i;
+            }
+        }
+    }
+
+    if (columnIdxs[COL_DATE] < 0 || columnIdxs[COL_CLOSE] < 0) {
+        // Positional layout: instrument, datetime, open, high, low, close, volume, amount
+        static const int defaultIdxs[COL_NUM] = { 0, 1, -1, 2, 3, 4, 5, 6, -1, 7 };
+        memcpy(columnIdxs, defaultIdxs, sizeof(columnIdxs));
+    }
+
+    // Split into chunks at line boundaries.
+    vector<const char*> bounds;
+    bounds.push_back(body);
+    size_t bodySize = end - body;
+    int chunkNum = std::max<int>(1, std::min<int>(threadNum, (int)(bodySize / CSV_MIN_CHUNK_SIZE)));
+    for (int i = 1; i < chunkNum; i++) {
+        const char* pos = body + bodySize / chunkNum * i;
+        if (pos <= bounds.back()) {
+            continue;
+        }
+        pos = findLineEnd(pos, end);
+        if (pos < end) {
+            pos++;
+        }
+        if (pos > bounds.back() && pos < end) {
+            bounds.push_back(pos);
+        }
+    }
+    bounds.push_back(end);
+
+    chunkNum = bounds.size() - 1;
+    vector<CsvChunk> chunks(chunkNum);
+    if (chunkNum == 1) {
+        parseChunk(bounds[0], bounds[1], columnIdxs, defaultInstrument, chunks[0]);
+    } else {
+        Utils::ThreadPool pool(chunkNum);
+        for (int i = 0; i < chunkNum; i++) {
+            const char* chunkBegin = bounds[i];
+            const char* chunkEnd = bounds[i + 1];
+            CsvChunk* chunk = &chunks[i];
+            const int* idxs = columnIdxs;
+            const string* instrument = &defaultInstrument;
+            pool.Submit([chunkBegin, chunkEnd, idxs, instrument, chunk]() {
+                parseChunk(chunkBegin, chunkEnd, idxs, *instrument, *chunk);
+            });
+        }
+    }
+
+    // Report the first malformed line, 1 is the title.
+    size_t lineBase = 1;
+    for (int i = 0; i < chunkNum; i++) {
+        if (chunks[i].errorLine != 0) {
+            Logger_Info() << "Skip malformed line " << lineBase + chunks[i].errorLine << " of '" << file << "'.";
+            break;
+        }
+        lineBase += chunks[i].lineNum;
+    }
+
+    // Map instruments of chunks to global indices, in order of appearance.
+    vector<string> instruments;
+    unordered_map<string, uint32_t> instrumentIdxs;
+    vector< vector<uint32_t> > remaps(chunkNum);
+    for (int i = 0; i < chunkNum; i++) {
+        for (auto& name : chunks[i].instruments) {
+            auto itor = instrumentIdxs.find(name);
+            if (itor == instrumentIdxs.end()) {
+                remaps[i].push_back(instruments.size());
+                instrumentIdxs.insert(std::make_pair(name, (uint32_t)instruments.size()));
+                instruments.push_back(name);
+            } else {
+                remaps[i].push_back(itor->second);
+            }
+        }
+    }
+
+    // Group rows by instrument (stable), then scatter columns.
+    vector<size_t> offsets(instruments.size() + 1, 0);
+    for (int i = 0; i < chunkNum; i++) {
+        for (auto idx : chunks[i].rowInstruments) {
+            offsets[remaps[i][idx] + 1]++;
+        }
+    }
+    for (size_t i = 1; i < offsets.size(); i++) {
+        offsets[i] += offsets[i - 1];
+    }
+
+    size_t rowNum = offsets.back();
+    table.segments.clear();
+    table.timestamps.assign(rowNum, 0);
+    vector<double>* columns[COL_NUM] = { nullptr };
+    columns[COL_OPEN]    = &table.opens;
+    columns[COL_HIGH]    = &table.highs;
+    columns[COL_LOW]     = &table.lows;
+    columns[COL_CLOSE]   = &table.closes;
+    columns[COL_VOLUME]  = &table.volumes;
+    columns[COL_OPENINT] = &table.openInts;
+    columns[COL_AMOUNT]  = &table.amounts;
+    for (int c = COL_OPEN; c < COL_NUM; c++) {
+        columns[c]->assign(rowNum, 0.0);
+    }
+
+    vector<size_t> cursors(offsets.begin(), offsets.end() - 1);
+    for (int i = 0; i < chunkNum; i++) {
+        const CsvChunk& chunk = chunks[i];
+        for (size_t r = 0; r < chunk.rowInstruments.size(); r++) {
+            size_t dst = cursors[remaps[i][chunk.rowInstruments[r]]]++;
+            table.timestamps[dst] = chunk.timestamps[r];
+            for (int c = COL_OPEN; c < COL_NUM; c++) {
+                if (columnIdxs[c] >= 0) {
+                    (*columns[c])[dst] = chunk.columns[c][r];
+                }
+            }
+        }
+    }
+
+    for (size_t i = 0; i < instruments.size(); i++) {
+        CsvSegment segment;
+        segment.instrument = instruments[i];
+        segment.begin      = offsets[i];
+        segment.length     = offsets[i + 1] - offsets[i];
+
+        // Files exported newest first are reversed.
+        size_t first = segment.begin;
+        size_t last = segment.begin + segment.length - 1;
+        if (segment.length > 1 && table.timestamps[first] > table.timestamps[last]) {
+            std::reverse(table.timestamps.begin() + first, table.timestamps.begin() + last + 1);
+            for (int c = COL_OPEN; c < COL_NUM; c++) {
+                std::reverse(columns[c]->begin() + first, columns[c]->begin() + last + 1);
+            }
+        }
+
+        for (size_t r = first + 1; r <= last; r++) {
+            if (table.timestamps[r] < table.timestamps[r - 1]) {
+                Logger_Err() << "Timeline wrap back, please verify the correctness of your input data."
+                             << " Feed: " << segment.instrument
+                             << " Previous: " << DateTime(table.timestamps[r - 1]).toString()
+                             << " Current: " << DateTime(table.timestamps[r]).toString();
+                return false;
+            }
+        }
+
+        table.segments.push_back(segment);
+    }
+
+    return rowNum > 0;
+}
+
+void MappedCsvFileLoader::setCacheDirectory(const string& dir)
+{
+    m_cacheDir = dir;
+}
+
+const string& MappedCsvFileLoader::getCacheDirectory() const
+{
+    return m_cacheDir;
+}
+
+string MappedCsvFileLoader::getDefaultCacheDirectory()
+{
+    try {
+        return (boost::filesystem::temp_directory_path() / "xBacktest").string();
+    } catch (exception&) {
+        return string();
+    }
+}
+
+string MappedCsvFileLoader::getCacheKey(const string& file, const string& defaultInstrument)
+{
+    // Anything affecting the parsed result goes into the key.
+    try {
+        boost::filesystem::path path = boost::filesystem::canonical(file);
+        ostringstream key;
+        key << "path=" << path.string()
+            << "|size=" << boost::filesystem::file_size(path)
+            << "|mtime=" << (int64)boost::filesystem::last_write_time(path)
+            << "|instrument=" << defaultInstrument
+            << "|version=" << CSV_CACHE_VERSION;
+        return key.str();
+    } catch (exception&) {
+        return string();
+    }
+}
+
+string MappedCsvFileLoader::getCacheFileName(const string& file, const string& key)
+{
+    // FNV-1a, stable across platforms and runs.
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < key.size(); i++) {
+        hash ^= (unsigned char)key[i];
+        hash *= 1099511628211ULL;
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx", (unsigned long long)hash);
+
+    boost::filesystem::path path(m_cacheDir);
+    path /= boost::filesystem::path(file).filename().string() + "." + name + ".cache";
+
+    return path.string();
+}
+
+static inline uint64_t alignTo8(uint64_t offset)
+{
+    return (offset + 7) & ~(uint64_t)7;
+}
+
+bool MappedCsvFileLoader::loadCache(const string& cacheFile, const string& key, CsvColumns& columns)
+{
+    shared_ptr<boost::iostreams::mapped_file_source> mappedFile;
+    try {
+        if (!boost::filesystem::exists(cacheFile)) {
+            return false;
+        }
+
+        mappedFile = make_shared<boost::iostreams::mapped_file_source>();
+        mappedFile->open(cacheFile);
+    } catch (exception &e) {
+        Logger_Info() << "Failed to open cache file '" << cacheFile << "': " << e.what();
+        return false;
+    }
+
+    if (!mappedFile->is_open() || mappedFile->size() < sizeof(CsvCacheHeader)) {
+        return false;
+    }
+
+    const char* base = mappedFile->data();
+    uint64_t size = mappedFile->size();
+    const CsvCacheHeader* header = (const CsvCacheHeader*)base;
+    if (memcmp(header->magic, CSV_CACHE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != CSV_CACHE_VERSION ||
+        header->keyLength != key.size() ||
+        sizeof(CsvCacheHeader) + header->keyLength > size ||
+        memcmp(base + sizeof(CsvCacheHeader), key.data(), key.size()) != 0) {
+        Logger_Info() << "Cache file '" << cacheFile << "' is out of date.";
+        return false;
+    }
+
+    bool valid = header->segmentNum > 0 && header->rowNum > 0 &&
+                 header->segmentOffset + header->segmentNum * sizeof(CsvCacheSegment) <= size &&
+                 header->timestampOffset + header->rowNum * sizeof(int64) <= size;
+    for (int c = COL_OPEN; c < COL_NUM && valid; c++) {
+        valid = header->columnOffsets[c] % 8 == 0 &&
+                header->columnOffsets[c] + header->rowNum * sizeof(double) <= size;
+    }
+
+    const CsvCacheSegment* segments = (const CsvCacheSegment*)(base + header->segmentOffset);
+    for (uint32_t i = 0; i < header->segmentNum && valid; i++) {
+        valid = segments[i].length > 0 && segments[i].begin + segments[i].length <= header->rowNum;
+    }
+
+    if (!valid) {
+        Logger_Info() << "Cache file '" << cacheFile << "' is corrupted.";
+        return false;
+    }
+
+    Logger_Info() << "Load cache file '" << cacheFile << "'...";
+
+    columns.segments.clear();
+    for (uint32_t i = 0; i < header->segmentNum; i++) {
+        CsvSegment segment;
+        segment.instrument = string(segments[i].instrument, strnlen(segments[i].instrument, sizeof(segments[i].instrument)));
+        segment.begin      = segments[i].begin;
+        segment.length     = segments[i].length;
+        columns.segments.push_back(segment);
+    }
+
+    columns.timestamps = (const int64*)(base + header->timestampOffset);
+    for (int c = 0; c < COL_NUM; c++) {
+        columns.columns[c] = c >= COL_OPEN ? (const double*)(base + header->columnOffsets[c]) : nullptr;
+    }
+    columns.holder = mappedFile;
+
+    return true;
+}
+
+bool MappedCsvFileLoader::writeCache(const string& cacheFile, const string& key, const CsvTable& table)
+{
+    const vector<double>* values[COL_NUM] = { nullptr };
+    values[COL_OPEN]    = &table.opens;
+    values[COL_HIGH]    = &table.highs;
+    values[COL_LOW]     = &table.lows;
+    values[COL_CLOSE]   = &table.closes;
+    values[COL_VOLUME]  = &table.volumes;
+    values[COL_OPENINT] = &table.openInts;
+    values[COL_AMOUNT]  = &table.amounts;
+
+    vector<CsvCacheSegment> segments;
+    for (auto& seg : table.segments) {
+        CsvCacheSegment segment;
+        memset(&segment, 0, sizeof(segment));
+        if (seg.instrument.size() >= sizeof(segment.instrument)) {
+            Logger_Info() << "Instrument '" << seg.instrument << "' is too long to be cached.";
+            return false;
+        }
+        strncpy(segment.instrument, seg.instrument.c_str(), sizeof(segment.instrument) - 1);
+        segment.begin  = seg.begin;
+        segment.length = seg.length;
+        segments.push_back(segment);
+    }
+
+    uint64_t rowNum = table.timestamps.size();
+
+    CsvCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CSV_CACHE_MAGIC, sizeof(header.magic));
+    header.version         = CSV_CACHE_VERSION;
+    header.keyLength       = key.size();
+    header.segmentNum      = segments.size();
+    header.rowNum          = rowNum;
+    header.segmentOffset   = alignTo8(sizeof(CsvCacheHeader) + key.size());
+    header.timestampOffset = alignTo8(header.segmentOffset + segments.size() * sizeof(CsvCacheSegment));
+    uint64_t offset = header.timestampOffset + rowNum * sizeof(int64);
+    for (int c = COL_OPEN; c < COL_NUM; c++) {
+        header.columnOffsets[c] = offset;
+        offset += rowNum * sizeof(double);
+    }
+
+    string tempFile;
+    try {
+        boost::filesystem::create_directories(m_cacheDir);
+        // Same file may be cached by concurrent loaders.
+        tempFile = cacheFile + "." + boost::filesystem::unique_path().string() + ".tmp";
+
+        ofstream out(tempFile.c_str(), ios::out | ios::binary | ios::trunc);
+        if (!out.is_open()) {
+            Logger_Info() << "Can't create cache file '" << cacheFile << "'.";
+            return false;
+        }
+
+        static const char padding[8] = { 0 };
+        out.write((const char*)&header, sizeof(header));
+        out.write(key.data(), key.size());
+        out.write(padding, header.segmentOffset - sizeof(header) - key.size());
+        out.write((const char*)segments.data(), segments.size() * sizeof(CsvCacheSegment));
+        out.write(padding, header.timestampOffset - header.segmentOffset - segments.size() * sizeof(CsvCacheSegment));
+        out.write((const char*)table.timestamps.data(), rowNum * sizeof(int64));
+        for (int c = COL_OPEN; c < COL_NUM; c++) {
+            out.write((const char*)values[c]->data(), rowNum * sizeof(double));
+        }
+        out.close();
+        if (out.fail()) {
+            boost::filesystem::remove(tempFile);
+            return false;
+        }
+
+        boost::filesystem::rename(tempFile, cacheFile);
+    } catch (exception &e) {
+        Logger_Info() << "Failed to write cache file '" << cacheFile << "': " << e.what();
+        if (!tempFile.empty()) {
+            boost::system::error_code ec;
+            boost::filesystem::remove(tempFile, ec);
+        }
+        return false;
+    }
+
+    Logger_Info() << "Write cache file '" << cacheFile << "'.";
+
+    return true;
+}
+
+bool MappedCsvFileLoader::loadCsvFile(const string& name, int resolution, int interval, const string& file, const Contract& contract, const DataRange& range, DataStream* stream)
+{
+    Logger_Info() << "Loading CSV file '" << file << "'...";
+
+    if (name.empty()) {
+        ASSERT(false, "Symbol(name) is empty.");
+    }
+
+    {
+        Utils::Lock lock(m_mutex);
+        for (size_t i = 0; i < m_dataStreamDescs.size(); i++) {
+            if (m_dataStreamDescs[i].name == name &&
+                m_dataStreamDescs[i].resolution == resolution &&
+                m_dataStreamDescs[i].interval == interval) {
+                return false;
+            }
+        }
+    }
+
+    CsvStreamDesc desc;
+    desc.name       = name;
+    desc.resolution = resolution;
+    desc.interval   = interval;
+    desc.file       = file;
+
+    CsvColumns columns;
+    string key;
+    string cacheFile;
+    if (!m_cacheDir.empty()) {
+        key = getCacheKey(file, name);
+        if (!key.empty()) {
+            cacheFile = getCacheFileName(file, key);
+        }
+    }
+
+    if (cacheFile.empty() || !loadCache(cacheFile, key, columns)) {
+        shared_ptr<CsvTable> table = make_shared<CsvTable>();
+        if (!parseFile(file, name, Utils::getMachineCPUNum(), *table)) {
+            Logger_Err() << "Failed to parse CSV file '" << file << "'.";
+            return false;
+        }
+
+        if (!cacheFile.empty()) {
+            // The cache only saves parsing next time, failing to write is harmless.
+            writeCache(cacheFile, key, *table);
+        }
+
+        columns.segments   = table->segments;
+        columns.timestamps = table->timestamps.data();
+        columns.holder     = table;
+        for (int c = 0; c < COL_NUM; c++) {
+            columns.columns[c] = nullptr;
+        }
+        columns.columns[COL_OPEN]    = table->opens.data();
+        columns.columns[COL_HIGH]    = table->highs.data();
+        columns.columns[COL_LOW]     = table->lows.data();
+        columns.columns[COL_CLOSE]   = table->closes.data();
+        columns.columns[COL_VOLUME]  = table->volumes.data();
+        columns.columns[COL_OPENINT] = table->openInts.data();
+        columns.columns[COL_AMOUNT]  = table->amounts.data();
+    }
+
+    vector<MappedCsvBarFeed*> barFeeds;
+    int periods = 0;
+    for (auto& segment : columns.segments) {
+        int begin = 0;
+        int length = (int)segment.length;
+        if (!range.isAll()) {
+            length = 0;
+            if (range.hasInstrument(segment.instrument)) {
+                length = range.slice(columns.timestamps + segment.begin, (int)segment.length, begin);
+            }
+            if (length == 0) {
+                continue;
+            }
+        }
+
+        MappedCsvBarFeed* barFeed = new MappedCsvFileLoader::MappedCsvBarFeed(
+            segment.instrument, resolution, columns.holder, columns.timestamps, columns.columns, segment.begin + begin);
+        Contract c = contract;
+        strncpy(c.instrument, segment.instrument.c_str(), sizeof(c.instrument) - 1);
+        c.instrument[sizeof(c.instrument) - 1] = '\0';
+        barFeed->setContract(c);
+        barFeed->setName(name);
+        barFeed->setLength(length);
+        barFeed->setBeginDateTime(DateTime(barFeed->m_timestamps[0]));
+        barFeed->setEndDateTime(DateTime(barFeed->m_timestamps[length - 1]));
+        barFeed->setResolution((Bar::Resolution)resolution);
+        barFeed->setInterval(interval);
+        // CSV has no main contract flag, the whole feed is tradable.
+        barFeed->addTradablePeriod(barFeed->getBeginDateTime(), barFeed->getEndDateTime());
+        periods++;
+        barFeeds.push_back(barFeed);
+    }
+
+    int size = barFeeds.size();
+    Logger_Info() << "Construct " << size << (size <= 1 ? " barfeed, " : " barfeeds, ") << periods << " tradable " << ( periods > 1 ? "periods." : "period.");
+
+    stream->setCommonContract(contract);
+    stream->setName(name);
+    stream->setResolution(resolution);
+    stream->setInterval(interval);
+    for (auto& feed : barFeeds) {
+        stream->insertBarFeed(feed);
+    }
+
+    {
+        Utils::Lock lock(m_mutex);
+        m_dataStreamDescs.push_back(desc);
+        m_barFeeds.insert(m_barFeeds.end(), barFeeds.begin(), barFeeds.end());
+    }
+
+    return (barFeeds.size() > 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // namespace xBacktest
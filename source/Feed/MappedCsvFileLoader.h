@@ -0,0 +1,181 @@
+#ifndef MAPPED_CSV_FILE_LOADER_H
+#define MAPPED_CSV_FILE_LOADER_H
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "BarFeed.h"
+#include "Lock.h"
+
+namespace xBacktest
+{
+
+class DataStream;
+
+////////////////////////////////////////////////////////////////////////////////
+// Bar loader for large CSV files. The file is memory mapped and split into
+// chunks at line boundaries, chunks are parsed on several threads straight
+// into columns, no intermediate strings or Bar objects are created.
+//
+// The first line is a title, recognized columns (case insensitive):
+//   instrument|symbol|code, date|datetime, time, open, high, low, close,
+//   volume, openint|open_interest, amount|turnover
+// Date accepts YYYYMMDD, YYYY-MM-DD or YYYY/MM/DD optionally followed by a
+// time, time accepts HH:MM[:SS[.mmm]] or HHMMSS. If the title isn't
+// recognized, columns are taken as
+//   instrument, datetime, open, high, low, close, volume, amount
+// Fields may be enclosed by '"' but must not contain line breaks. Rows of one
+// instrument may be in ascending or descending order of time.
+//
+// Parsed files are cached in a binary file under the cache directory, later
+// loads of an unchanged file map the cache instead of parsing it again:
+//   +---------------------+
+//   | CsvCacheHeader      |
+//   +---------------------+
+//   | key                 |  source path, size, modify time and options
+//   +---------------------+
+//   | CsvCacheSegment[]   |  one segment per instrument, index into columns
+//   +---------------------+
+//   | timestamp[]         |  int64, milliseconds since the Epoch
+//   | open[] ... amount[] |  double, one column per value column
+//   +---------------------+
+// Sections and columns are 8 bytes aligned.
+class MappedCsvFileLoader
+{
+public:
+    enum Column {
+        COL_INSTRUMENT,
+        COL_DATE,
+        COL_TIME,
+        COL_OPEN,
+        COL_HIGH,
+        COL_LOW,
+        COL_CLOSE,
+        COL_VOLUME,
+        COL_OPENINT,
+        COL_AMOUNT,
+        COL_NUM
+    };
+
+    typedef struct {
+        string  instrument;
+        size_t  begin;
+        size_t  length;
+    } CsvSegment;
+
+    // Parsed file, rows of one instrument are continuous and ascending.
+    typedef struct {
+        vector<CsvSegment> segments;
+        vector<int64>      timestamps;
+        vector<double>     opens;
+        vector<double>     highs;
+        vector<double>     lows;
+        vector<double>     closes;
+        vector<double>     volumes;
+        vector<double>     openInts;
+        vector<double>     amounts;
+    } CsvTable;
+
+#pragma pack(push)
+#pragma pack(8)
+    typedef struct {
+        char        magic[8];       // CSV_CACHE_MAGIC
+        uint32_t    version;
+        uint32_t    keyLength;      // key follows the header.
+        uint32_t    segmentNum;
+        uint32_t    reserved;
+        uint64_t    rowNum;
+        uint64_t    segmentOffset;
+        uint64_t    timestampOffset;
+        uint64_t    columnOffsets[COL_NUM];  // only value columns are used.
+    } CsvCacheHeader;
+
+    typedef struct {
+        char        instrument[32];
+        uint64_t    begin;
+        uint64_t    length;
+    } CsvCacheSegment;
+#pragma pack(pop)
+
+    class MappedCsvBarFeed : public BarFeed
+    {
+        friend class MappedCsvFileLoader;
+    public:
+        bool reset();
+        bool getNextBar(Bar& outBar);
+        bool isRealTime() { return false; }
+        const DateTime peekDateTime() const;
+        bool eof();
+        int loadData(int   reqId,
+            const DataRequest& request,
+            void* object,
+            void(*callback)(const DateTime& datetime, void* ctx));
+        MappedCsvBarFeed* clone();
+
+    private:
+        // `columns` is indexed by Column, `holder` owns the memory of columns.
+        MappedCsvBarFeed(const string& instrument, int resolution, const shared_ptr<void>& holder,
+                         const int64* timestamps, const double* const* columns, size_t begin);
+        void getBar(int idx, Bar& outBar) const;
+
+    private:
+        int m_readIdx;
+        // Keep the parsed table or the mapped cache alive.
+        shared_ptr<void> m_holder;
+        const int64*  m_timestamps;
+        const double* m_opens;
+        const double* m_highs;
+        const double* m_lows;
+        const double* m_closes;
+        const double* m_volumes;
+        const double* m_openInts;
+        const double* m_amounts;
+    };
+
+    MappedCsvFileLoader();
+    ~MappedCsvFileLoader();
+    // Safe to call concurrently. Ids of the stream and feeds are left unset,
+    // DataStorage assigns them on registration.
+    // The whole file is parsed or mapped from the cache, feeds only cover
+    // rows within `range`.
+    bool loadCsvFile(const string& name, int resolution, int interval, const string& file, const Contract& contract, const DataRange& range, DataStream* stream);
+
+    // Parse a CSV file into columns using up to `threadNum` threads.
+    // Rows without an instrument column are assigned to `defaultInstrument`.
+    static bool parseFile(const string& file, const string& defaultInstrument, int threadNum, CsvTable& table);
+
+    // Directory of cache files, empty disables caching. Must not be changed
+    // while files are being loaded.
+    void setCacheDirectory(const string& dir);
+    const string& getCacheDirectory() const;
+    static string getDefaultCacheDirectory();
+
+private:
+    typedef struct {
+        string      name;
+        int         resolution;
+        int         interval;
+        string      file;
+    } CsvStreamDesc;
+
+    typedef struct {
+        vector<CsvSegment>  segments;
+        const int64*        timestamps;
+        const double*       columns[COL_NUM];
+        shared_ptr<void>    holder;
+    } CsvColumns;
+
+    string getCacheKey(const string& file, const string& defaultInstrument);
+    string getCacheFileName(const string& file, const string& key);
+    bool loadCache(const string& cacheFile, const string& key, CsvColumns& columns);
+    bool writeCache(const string& cacheFile, const string& key, const CsvTable& table);
+
+private:
+    string m_cacheDir;
+    Utils::Mutex m_mutex;
+    vector<CsvStreamDesc> m_dataStreamDescs;
+    vector<MappedCsvBarFeed*> m_barFeeds;
+};
+
+} // namespace xBacktest
+
+#endif // MAPPED_CSV_FILE_LOADER_H
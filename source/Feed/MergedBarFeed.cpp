@@ -0,0 +1,254 @@
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include "Logger.h"
+#include "MergedBarFeed.h"
+
+namespace xBacktest
+{
+
+static const char TIMELINE_FILE_MAGIC[8] = "XBTTML1";
+static const uint32_t TIMELINE_FILE_VERSION = 1;
+
+////////////////////////////////////////////////////////////////////////////////
+StreamTimeline::StreamTimeline()
+{
+    m_size       = 0;
+    m_timestamps = nullptr;
+    m_feedIdxs   = nullptr;
+}
+
+string StreamTimeline::getTimelineFileName(const string& source)
+{
+    return source + ".tl";
+}
+
+shared_ptr<StreamTimeline> StreamTimeline::build(const vector<BarFeed*>& feeds)
+{
+    Logger_Info() << "Merge timeline of " << feeds.size() << (feeds.size() <= 1 ? " barfeed..." : " barfeeds...");
+
+    typedef struct {
+        int64    ticks;
+        uint32_t idx;
+    } QueueItem;
+
+    // Min-heap on time then feed index.
+    auto laterThan = [](const QueueItem& a, const QueueItem& b) {
+        return a.ticks != b.ticks ? a.ticks > b.ticks : a.idx > b.idx;
+    };
+
+    shared_ptr<StreamTimeline> timeline(new StreamTimeline());
+    size_t total = 0;
+    vector<QueueItem> queue;
+    for (size_t i = 0; i < feeds.size(); i++) {
+        feeds[i]->reset();
+        total += feeds[i]->getLength();
+        if (!feeds[i]->eof()) {
+            queue.push_back({ feeds[i]->peekDateTime().ticks(), (uint32_t)i });
+        }
+    }
+    std::make_heap(queue.begin(), queue.end(), laterThan);
+
+    timeline->m_timestampColumn.reserve(total);
+    timeline->m_feedIdxColumn.reserve(total);
+
+    Bar bar;
+    while (!queue.empty()) {
+        std::pop_heap(queue.begin(), queue.end(), laterThan);
+        QueueItem item = queue.back();
+        queue.pop_back();
+
+        BarFeed* feed = feeds[item.idx];
+        feed->getNextBar(bar);
+        timeline->m_timestampColumn.push_back(item.ticks);
+        timeline->m_feedIdxColumn.push_back(item.idx);
+
+        if (!feed->eof()) {
+            queue.push_back({ feed->peekDateTime().ticks(), item.idx });
+            std::push_heap(queue.begin(), queue.end(), laterThan);
+        }
+    }
+
+    for (auto& feed : feeds) {
+        feed->reset();
+    }
+
+    timeline->m_size       = timeline->m_timestampColumn.size();
+    timeline->m_timestamps = timeline->m_timestampColumn.data();
+    timeline->m_feedIdxs   = timeline->m_feedIdxColumn.data();
+
+    return timeline;
+}
+
+shared_ptr<StreamTimeline> StreamTimeline::load(const string& file, const string& source, const vector<BarFeed*>& feeds)
+{
+    shared_ptr<StreamTimeline> timeline(new StreamTimeline());
+    try {
+        if (!boost::filesystem::exists(file)) {
+            return nullptr;
+        }
+
+        timeline->m_mappedFile = make_shared<boost::iostreams::mapped_file_source>();
+        timeline->m_mappedFile->open(file);
+        if (!timeline->m_mappedFile->is_open() || timeline->m_mappedFile->size() < sizeof(TimelineHeader)) {
+            return nullptr;
+        }
+
+        const char* base = timeline->m_mappedFile->data();
+        uint64_t size = timeline->m_mappedFile->size();
+        const TimelineHeader* header = (const TimelineHeader*)base;
+        uint64_t timestampOffset = sizeof(TimelineHeader) + header->feedNum * sizeof(TimelineFeed);
+        uint64_t feedIdxOffset = timestampOffset + header->entryNum * sizeof(int64);
+        if (memcmp(header->magic, TIMELINE_FILE_MAGIC, sizeof(header->magic)) != 0 ||
+            header->version != TIMELINE_FILE_VERSION ||
+            header->sourceSize != boost::filesystem::file_size(source) ||
+            header->sourceModifyTime != (int64_t)boost::filesystem::last_write_time(source) ||
+            header->feedNum != feeds.size() ||
+            feedIdxOffset + header->entryNum * sizeof(uint32_t) > size) {
+            Logger_Info() << "Timeline file '" << file << "' is out of date.";
+            return nullptr;
+        }
+
+        const TimelineFeed* timelineFeeds = (const TimelineFeed*)(base + sizeof(TimelineHeader));
+        uint64_t total = 0;
+        for (size_t i = 0; i < feeds.size(); i++) {
+            string instrument(timelineFeeds[i].instrument, strnlen(timelineFeeds[i].instrument, sizeof(timelineFeeds[i].instrument)));
+            if (instrument != feeds[i]->getInstrument() ||
+                timelineFeeds[i].length != (uint64_t)feeds[i]->getLength()) {
+                Logger_Info() << "Timeline file '" << file << "' doesn't match feeds of the stream.";
+                return nullptr;
+            }
+            total += timelineFeeds[i].length;
+        }
+
+        if (total != header->entryNum) {
+            Logger_Info() << "Timeline file '" << file << "' is corrupted.";
+            return nullptr;
+        }
+
+        timeline->m_size       = header->entryNum;
+        timeline->m_timestamps = (const int64*)(base + timestampOffset);
+        timeline->m_feedIdxs   = (const uint32_t*)(base + feedIdxOffset);
+    } catch (exception &e) {
+        Logger_Info() << "Failed to load timeline file '" << file << "': " << e.what();
+        return nullptr;
+    }
+
+    Logger_Info() << "Load timeline file '" << file << "'...";
+
+    return timeline;
+}
+
+bool StreamTimeline::write(const string& file, const string& source, const vector<BarFeed*>& feeds) const
+{
+    string tempFile;
+    try {
+        vector<TimelineFeed> timelineFeeds;
+        for (auto& feed : feeds) {
+            TimelineFeed timelineFeed;
+            memset(&timelineFeed, 0, sizeof(timelineFeed));
+            if (feed->getInstrument().size() >= sizeof(timelineFeed.instrument)) {
+                Logger_Info() << "Instrument '" << feed->getInstrument() << "' is too long to be saved in timeline.";
+                return false;
+            }
+            strncpy(timelineFeed.instrument, feed->getInstrument().c_str(), sizeof(timelineFeed.instrument) - 1);
+            timelineFeed.length = feed->getLength();
+            timelineFeeds.push_back(timelineFeed);
+        }
+
+        TimelineHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, TIMELINE_FILE_MAGIC, sizeof(header.magic));
+        header.version          = TIMELINE_FILE_VERSION;
+        header.feedNum          = timelineFeeds.size();
+        header.entryNum         = m_size;
+        header.sourceSize       = boost::filesystem::file_size(source);
+        header.sourceModifyTime = boost::filesystem::last_write_time(source);
+
+        // Streams sharing a source may be prepared concurrently.
+        tempFile = file + "." + boost::filesystem::unique_path().string() + ".tmp";
+
+        ofstream out(tempFile.c_str(), ios::out | ios::binary | ios::trunc);
+        if (!out.is_open()) {
+            Logger_Info() << "Can't create timeline file '" << file << "'.";
+            return false;
+        }
+
+        out.write((const char*)&header, sizeof(header));
+        out.write((const char*)timelineFeeds.data(), timelineFeeds.size() * sizeof(TimelineFeed));
+        out.write((const char*)m_timestamps, m_size * sizeof(int64));
+        out.write((const char*)m_feedIdxs, m_size * sizeof(uint32_t));
+        out.close();
+        if (out.fail()) {
+            boost::filesystem::remove(tempFile);
+            return false;
+        }
+
+        boost::filesystem::rename(tempFile, file);
+    } catch (exception &e) {
+        Logger_Info() << "Failed to write timeline file '" << file << "': " << e.what();
+        if (!tempFile.empty()) {
+            boost::system::error_code ec;
+            boost::filesystem::remove(tempFile, ec);
+        }
+        return false;
+    }
+
+    Logger_Info() << "Write timeline file '" << file << "'.";
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+MergedBarFeed::MergedBarFeed(const shared_ptr<StreamTimeline>& timeline, const vector<BarFeed*>& feeds)
+{
+    m_timeline = timeline;
+    m_feeds    = feeds;
+    m_pos      = 0;
+}
+
+const vector<BarFeed*>& MergedBarFeed::getBarFeeds() const
+{
+    return m_feeds;
+}
+
+bool MergedBarFeed::eof()
+{
+    return m_pos >= m_timeline->size();
+}
+
+bool MergedBarFeed::dispatch()
+{
+    const int64* timestamps = m_timeline->getTimestamps();
+    const uint32_t* feedIdxs = m_timeline->getFeedIdxs();
+    size_t size = m_timeline->size();
+    if (m_pos >= size) {
+        return false;
+    }
+
+    // All bars of this round, in order of feeds.
+    bool eventsDispatched = false;
+    int64 ticks = timestamps[m_pos];
+    while (m_pos < size && timestamps[m_pos] == ticks) {
+        if (m_feeds[feedIdxs[m_pos]]->dispatch()) {
+            eventsDispatched = true;
+        }
+        m_pos++;
+    }
+
+    return eventsDispatched;
+}
+
+const DateTime MergedBarFeed::peekDateTime() const
+{
+    if (m_pos >= m_timeline->size()) {
+        DateTime dt;
+        dt.markInvalid();
+        return dt;
+    }
+
+    return DateTime(m_timeline->getTimestamps()[m_pos]);
+}
+
+} // namespace xBacktest
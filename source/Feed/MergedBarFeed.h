@@ -0,0 +1,98 @@
+#ifndef MERGED_BAR_FEED_H
+#define MERGED_BAR_FEED_H
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "BarFeed.h"
+
+namespace xBacktest
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// Time ordered sequence of all bars of a data stream, built once by k-way
+// merging the feeds of the stream. Bars of the same time keep the order of
+// feeds in the stream, which is how the dispatcher orders them as well.
+//
+// A timeline may be saved next to the data file ('<file>.tl'):
+//   +---------------------+
+//   | TimelineHeader      |
+//   +---------------------+
+//   | TimelineFeed[]      |  instrument and length of feeds, in stream order
+//   +---------------------+
+//   | timestamp[]         |  int64, milliseconds since the Epoch
+//   | feedIdx[]           |  uint32, index of the feed in stream
+//   +---------------------+
+// It's rebuilt when size or modification time of the data file, or feeds
+// of the stream don't match.
+class StreamTimeline
+{
+public:
+#pragma pack(push)
+#pragma pack(8)
+    typedef struct {
+        char        magic[8];    // TIMELINE_FILE_MAGIC
+        uint32_t    version;
+        uint32_t    feedNum;
+        uint64_t    entryNum;
+        uint64_t    sourceSize;
+        int64_t     sourceModifyTime;
+    } TimelineHeader;
+
+    typedef struct {
+        char        instrument[32];
+        uint64_t    length;
+    } TimelineFeed;
+#pragma pack(pop)
+
+    // Walk through `feeds` and merge them, feeds are reset afterwards.
+    static shared_ptr<StreamTimeline> build(const vector<BarFeed*>& feeds);
+    // Map a saved timeline, returns nullptr if it's missing or out of date.
+    static shared_ptr<StreamTimeline> load(const string& file, const string& source, const vector<BarFeed*>& feeds);
+    bool write(const string& file, const string& source, const vector<BarFeed*>& feeds) const;
+
+    static string getTimelineFileName(const string& source);
+
+    size_t        size() const          { return m_size; }
+    const int64*  getTimestamps() const { return m_timestamps; }
+    const uint32_t* getFeedIdxs() const { return m_feedIdxs; }
+
+private:
+    StreamTimeline();
+
+private:
+    // Either built in memory or mapped from a file.
+    vector<int64>    m_timestampColumn;
+    vector<uint32_t> m_feedIdxColumn;
+    shared_ptr<boost::iostreams::mapped_file_source> m_mappedFile;
+
+    size_t           m_size;
+    const int64*     m_timestamps;
+    const uint32_t*  m_feedIdxs;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Replays all feeds of a data stream as one subject following the timeline,
+// the dispatcher merges one subject per stream instead of one per feed.
+// Feeds still emit their own bar events.
+class MergedBarFeed : public Subject
+{
+public:
+    // `feeds` must be cloned from the stream the timeline is built for, in
+    // the same order.
+    MergedBarFeed(const shared_ptr<StreamTimeline>& timeline, const vector<BarFeed*>& feeds);
+
+    const vector<BarFeed*>& getBarFeeds() const;
+
+    bool eof();
+    bool dispatch();
+    const DateTime peekDateTime() const;
+
+private:
+    shared_ptr<StreamTimeline> m_timeline;
+    vector<BarFeed*> m_feeds;
+    size_t m_pos;
+};
+
+} // namespace xBacktest
+
+#endif // MERGED_BAR_FEED_H
@@ -63,7 +63,7 @@ bool TsFileLoader::TsFileBarFeed::getNextBar(Bar& outBar)
     if (m_readIdx < getLength()) {
         DateTime dt(m_begin[m_readIdx].datetime);
 
-        Bar bar(m_begin[m_readIdx].name,
+        outBar = Bar(getInstrumentId(),
             dt,
             m_begin[m_readIdx].open,
             m_begin[m_readIdx].high,
@@ -75,8 +75,6 @@ bool TsFileLoader::TsFileBarFeed::getNextBar(Bar& outBar)
 
         m_readIdx++;
 
-        outBar = bar;
-
         return true;
     }
 
@@ -116,7 +114,7 @@ int TsFileLoader::TsFileBarFeed::loadData(
         TsFileItem* from = item - request.count;
         while (from != item) {
             DateTime dt(from->datetime);
-            Bar bar(item->name, 
+            Bar bar(getInstrumentId(),
                 dt,
                 item->open,
                 item->high,
@@ -131,6 +129,7 @@ int TsFileLoader::TsFileBarFeed::loadData(
             ctx.barFeedId    = getId();
             ctx.object       = object;
             ctx.bar          = bar;
+            roundPrices(ctx.bar);
             callback(dt, &ctx);
             from++;
         }
@@ -14,7 +14,18 @@ Backtester::Backtester(
     , m_reportConfig(reportConfig)
     , m_strategies(strategies)
 {
+    m_shardNum = 0;
+    m_pipelineEnabled = false;
+}
 
+void Backtester::setShardNum(int num)
+{
+    m_shardNum = num;
+}
+
+void Backtester::enablePipeline(bool enable)
+{
+    m_pipelineEnabled = enable;
 }
 
 void Backtester::init()
@@ -31,6 +42,8 @@ Executor* Backtester::createNewExecutor(Utils::DefaultSemaphoreType& sema, const
     Executor* executor = new Executor();
     executor->setId(++m_nextExecutorId);
     executor->setBrokerConfig(m_brokerConfig);
+    executor->setShardNum(m_shardNum);
+    executor->enablePipeline(m_pipelineEnabled);
 
     // Let executor calculate daily metrics.
     if (m_reportConfig.isReportEnable(ReportConfig::REPORT_DAILY_METRICS)) {
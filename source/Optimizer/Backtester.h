@@ -17,6 +17,10 @@ public:
                vector<StrategyConfig>& strategies);
 
     void registerStrategy(const StrategyConfig& config);
+    // Threads running the runtimes of the executor, see Executor::setShardNum().
+    void setShardNum(int num);
+    // See Executor::enablePipeline().
+    void enablePipeline(bool enable);
     void init();
     void run();
 
@@ -34,6 +38,8 @@ private:
     vector<StrategyConfig>  m_strategies;
 
     volatile unsigned long m_nextExecutorId;
+    int m_shardNum;
+    bool m_pipelineEnabled;
 };
 
 } // namespace xBacktest
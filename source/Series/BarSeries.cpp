@@ -58,28 +58,25 @@ void BarSeries::appendWithDateTime(const DateTime& datetime, const void* value)
     long long volume  = bar.getVolume();
     long long openInt = bar.getOpenInt();
 
-    Event::Context ctx;
-    ctx.datetime = datetime;
-
-    ctx.data = (void*)(&open);    m_openDSAccessor.getNewValueEvent().emit(datetime, &ctx);
-    ctx.data = (void*)(&high);    m_highDSAccessor.getNewValueEvent().emit(datetime, &ctx);
-    ctx.data = (void*)(&low);     m_lowDSAccessor.getNewValueEvent().emit(datetime, &ctx);
-    ctx.data = (void*)(&close);   m_closeDSAccessor.getNewValueEvent().emit(datetime, &ctx);
-    ctx.data = (void*)(&volume);  m_volumeDSAccessor.getNewValueEvent().emit(datetime, &ctx);
-    ctx.data = (void*)(&openInt); m_openIntDSAccessor.getNewValueEvent().emit(datetime, &ctx);
+    m_openDSAccessor.getNewValueEvent().emit(datetime, open);
+    m_highDSAccessor.getNewValueEvent().emit(datetime, high);
+    m_lowDSAccessor.getNewValueEvent().emit(datetime, low);
+    m_closeDSAccessor.getNewValueEvent().emit(datetime, close);
+    m_volumeDSAccessor.getNewValueEvent().emit(datetime, volume);
+    m_openIntDSAccessor.getNewValueEvent().emit(datetime, openInt);
 
     if (bar.getResolution() == Bar::TICK) {
         double lastPrice  = bar.getLastPrice();
         double askPrice1  = bar.getAskPrice1();
-        double askVolume1 = bar.getAskVolume1();
+        long long askVolume1 = bar.getAskVolume1();
         double bidPrice1  = bar.getBidPrice1();
-        double bidVolume1 = bar.getBidVolume1();
+        long long bidVolume1 = bar.getBidVolume1();
 
-        ctx.data = (void*)(&lastPrice);  m_lastPriceDSAccessor.getNewValueEvent().emit(datetime, &ctx);
-        ctx.data = (void*)(&askPrice1);  m_askPrice1DSAccessor.getNewValueEvent().emit(datetime, &ctx);
-        ctx.data = (void*)(&askVolume1); m_askVolume1DSAccessor.getNewValueEvent().emit(datetime, &ctx);
-        ctx.data = (void*)(&bidPrice1);  m_bidPrice1DSAccessor.getNewValueEvent().emit(datetime, &ctx);
-        ctx.data = (void*)(&bidVolume1); m_bidVolume1DSAccessor.getNewValueEvent().emit(datetime, &ctx);
+        m_lastPriceDSAccessor.getNewValueEvent().emit(datetime, lastPrice);
+        m_askPrice1DSAccessor.getNewValueEvent().emit(datetime, askPrice1);
+        m_askVolume1DSAccessor.getNewValueEvent().emit(datetime, askVolume1);
+        m_bidPrice1DSAccessor.getNewValueEvent().emit(datetime, bidPrice1);
+        m_bidVolume1DSAccessor.getNewValueEvent().emit(datetime, bidVolume1);
     }
 }
 
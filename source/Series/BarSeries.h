@@ -35,17 +35,11 @@ public:
         Accessor(int type, BarSeries& barSeries) 
             : m_type(type)
             , m_barSeries(barSeries)
-            , m_newValueEvt(Event::EvtDataSeriesNewValue)
         {
         }
 
         ~Accessor() { }
 
-        Event& getNewValueEvent()
-        {
-            return m_newValueEvt;
-        }
-
         int length() const
         {
             return m_barSeries.length();
@@ -85,7 +79,6 @@ public:
 
     private:
         int        m_type;
-        Event      m_newValueEvt;
         BarSeries& m_barSeries;
     };
 
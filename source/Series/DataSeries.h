@@ -6,7 +6,7 @@
 #include "Export.h"
 #include "circular.h"
 #include "Bar.h"
-#include "Event.h"
+#include "Signal.h"
 
 namespace xBacktest
 {
@@ -37,8 +37,6 @@ public:
     // or TypeError if the key type is invalid.
     virtual void*  getItem(int pos) = 0;
 
-    virtual Event& getNewValueEvent() = 0;
-
 	virtual void   appendWithDateTime(const DateTime& dateTime, const void* value) = 0;
 
     virtual ~DataSeries();
@@ -52,10 +50,11 @@ template<typename T = double>
 class DllExport SequenceDataSeries : public DataSeries
 {
 public:
+    typedef Signal<const DateTime&, const T&> NewValueEvent;
+
     // @param: maxLen: The maximum number of values to hold.
     // Once a bounded length is full, when new items are added, a corresponding number of items are discarded from the opposite end.
     SequenceDataSeries(int maxLen = DataSeries::DEFAULT_MAX_LEN)
-        : m_newValueEvt(Event::EvtDataSeriesNewValue)
     {
         if (typeid(T) == typeid(int)) {
             setType(DataSeries::DSTypeInt);
@@ -139,10 +138,9 @@ public:
     }
 
     // Event handler receives:
-    // 1: Data Series generating the event
-    // 2: The datetime for the new value
-    // 3: The new value
-    virtual Event& getNewValueEvent()
+    // 1: The datetime for the new value
+    // 2: The new value
+    NewValueEvent& getNewValueEvent()
     {
         return m_newValueEvt;
     }
@@ -168,10 +166,7 @@ public:
         m_dateTimes.push_back(dateTime);
         m_values.push_back(data);
 
-        Event::Context ctx;
-        ctx.datetime = dateTime;
-        ctx.data     = (void*)value;
-        m_newValueEvt.emit(dateTime, (void *)&ctx);
+        m_newValueEvt.emit(dateTime, data);
     }
 
     void clear()
@@ -181,7 +176,7 @@ public:
     }
 
 private:
-    Event m_newValueEvt;
+    NewValueEvent m_newValueEvt;
 
 	int m_maxLen;
     circular_buffer<DateTime> m_dateTimes;
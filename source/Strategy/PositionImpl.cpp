@@ -18,6 +18,7 @@ PositionImpl::PositionImpl()
 {
     m_abstraction  = nullptr;
     m_runtime = nullptr;
+    m_instrumentId = 0;
     m_id = m_nextPositionId++;
 }
 
@@ -32,11 +33,12 @@ void PositionImpl::init(Position* abstraction, Runtime* runtime, const Order& en
     m_abstraction = abstraction;
     m_runtime = runtime;
     m_instrument = entryOrder.getInstrument();
+    m_instrumentId = entryOrder.getInstrumentId();
     assert(!m_instrument.empty());
     m_entryShares = 0;
     m_exitShares = 0;
     m_allOrNone  = false;
-    m_multiplier = runtime->getContract().multiplier;
+    m_multiplier = runtime->getContract(m_instrument.c_str()).multiplier;
 
     m_entryOrdId = entryOrder.getId();
 
@@ -406,40 +408,33 @@ void PositionImpl::onBarEvent(const Bar& bar)
     m_lastBar = bar;
 }
 
+// Smallest price on the tick grid not below `price`. Fixed-price contracts
+// round exactly in ticks, others allow a tiny error of the floating price.
 double PositionImpl::roundUp(double price)
 {
-    // price precision is (1/1000000)
-    int magnification = 1000000;
-    const Contract& contract = m_runtime->getContract();
-    long long unit = (long long)(contract.tickSize * magnification);
-    if (unit == 0) {
-        return price;
-    }
-
-    long long result = (long long)(price * magnification);
-
-    if (result % unit) {
-        result = (result / unit) * unit + unit;
+    const Contract& contract = m_runtime->getContract(m_instrument.c_str());
+    if (contract.fixedPrice) {
+        Utils::TickScale scale(contract.tickSize);
+        if (scale.isValid()) {
+            return scale.toPrice(scale.ceilTicks(price));
+        }
     }
 
-    return (result / (double)magnification);
+    return Utils::roundCeilMultiple<double>(price - 0.0000001, contract.tickSize);
 }
 
+// Largest price on the tick grid not above `price`.
 double PositionImpl::roundDown(double price)
 {
-    // price precision is (1/1000000)
-    int magnification = 1000000;
-    const Contract& contract = m_runtime->getContract();
-    long long unit = (long long)(contract.tickSize * magnification);
-    if (unit == 0) {
-        return price;
+    const Contract& contract = m_runtime->getContract(m_instrument.c_str());
+    if (contract.fixedPrice) {
+        Utils::TickScale scale(contract.tickSize);
+        if (scale.isValid()) {
+            return scale.toPrice(scale.floorTicks(price));
+        }
     }
 
-    long long result = (long long)(price * magnification);
-
-    result = (result / unit) * unit;
-
-    return (result / (double)magnification);
+    return Utils::roundFloorMultiple<double>(price + 0.0000001, contract.tickSize);
 }
 
 bool PositionImpl::checkStopLoss(const Bar& bar, StopCondition& condition)
@@ -475,9 +470,7 @@ bool PositionImpl::checkStopLoss(const Bar& bar, StopCondition& condition)
     if (condition.shares > 0) {
         if (low < stopLossPrice || fabs(low - stopLossPrice) < 0.0000001) {
             if (condition.stopImmediately) {
-                double stopPrice = Utils::roundFloorMultiple<double>(
-                    stopLossPrice + 0.0000001, 
-                    m_runtime->getContract().tickSize);
+                double stopPrice = roundDown(stopLossPrice);
                 // Guarantee the stop price can be triggered.
                 if (stopPrice < low) {
                     stopPrice = low;
@@ -492,9 +485,7 @@ bool PositionImpl::checkStopLoss(const Bar& bar, StopCondition& condition)
     } else if (condition.shares < 0) {
         if (high > stopLossPrice || fabs(high - stopLossPrice) < 0.0000001) {
             if (condition.stopImmediately) {
-                double stopPrice = Utils::roundCeilMultiple<double>(
-                    stopLossPrice - 0.0000001, 
-                    m_runtime->getContract().tickSize);
+                double stopPrice = roundUp(stopLossPrice);
                 // Guarantee the stop price can be triggered.
                 if (stopPrice > high) {
                     stopPrice = high;
@@ -537,9 +528,7 @@ bool PositionImpl::checkProfitTarget(const Bar& bar, StopCondition& condition)
             if (condition.stopImmediately) {
                 double limitPrice = condition.avgFillPrice * (1 + condition.profitLevels[0].returns);
 
-                limitPrice = Utils::roundFloorMultiple<double>(
-                    limitPrice + 0.0000001,
-                    m_runtime->getContract().tickSize);
+                limitPrice = roundDown(limitPrice);
 
                 exitImmediately(SignalType::TakeProfit, condition.shares, 0, limitPrice, condition.posId);
 
@@ -551,9 +540,7 @@ bool PositionImpl::checkProfitTarget(const Bar& bar, StopCondition& condition)
         } else if (condition.shares < 0) {
             if (condition.stopImmediately) {
                 double limitPrice = condition.avgFillPrice * (1 - condition.profitLevels[0].returns);
-                limitPrice = Utils::roundCeilMultiple<double>(
-                    limitPrice - 0.0000001,
-                    m_runtime->getContract().tickSize);
+                limitPrice = roundUp(limitPrice);
 
                 exitImmediately(SignalType::TakeProfit, condition.shares, 0, limitPrice, condition.posId);
 
@@ -659,9 +646,7 @@ bool PositionImpl::checkProfitDynamicDrawDown(const Bar& bar, StopCondition& con
                         stopPrice = condition.highestPrice - condition.profitLevels[i].drawdown;
                     }
 
-                    stopPrice = Utils::roundFloorMultiple<double>(
-                        stopPrice + 0.0000001, 
-                        m_runtime->getContract().tickSize);
+                    stopPrice = roundDown(stopPrice);
                     // Guarantee the stop price can be triggered.
                     if (stopPrice < currLow) {
                         stopPrice = currLow;
@@ -681,9 +666,7 @@ bool PositionImpl::checkProfitDynamicDrawDown(const Bar& bar, StopCondition& con
                         stopPrice = condition.lowestPrice + condition.profitLevels[i].drawdown;
                     }
 
-                    stopPrice = Utils::roundCeilMultiple<double>(
-                        stopPrice - 0.0000001, 
-                        m_runtime->getContract().tickSize);
+                    stopPrice = roundUp(stopPrice);
                     // Guarantee the stop price can be triggered.
                     if (stopPrice > currHigh) {
                         stopPrice = currHigh;
@@ -717,7 +700,7 @@ void PositionImpl::checkStopCondition(const Bar& bar, StopCondition& condition)
     }
 
     if (!bar.isValid() || 
-        m_instrument != bar.getInstrument()) {
+        m_instrumentId != bar.getInstrumentId()) {
         return;
     }
 
@@ -256,6 +256,7 @@ private:
 
 private:
     string m_instrument;
+    InstrumentId m_instrumentId;
     double m_multiplier;
     bool   m_allOrNone;
 
@@ -441,4 +441,9 @@ void Strategy::onTimeElapsed(const DateTime& prevDateTime, const DateTime& nextD
     /* empty */
 }
 
+void Strategy::onSlice(const Bar* const* bars, int num)
+{
+    /* empty */
+}
+
 } // namespace xBacktest
\ No newline at end of file
@@ -104,6 +104,13 @@ public:
     // The default implementation is empty.
     virtual void onTimeElapsed(const DateTime& prevDateTime, const DateTime& currDateTime);
 
+    // Override (optional) to get notified of all bars of the current time at once.
+    // Called after onBar() of each of them, bars are in dispatching order.
+    // The default implementation is empty.
+    // @param bars: Bars of the subscribed data streams, valid during the call only.
+    // @param num: Number of bars.
+    virtual void onSlice(const Bar* const* bars, int num);
+
 protected:
     // Create a market order.
     Order createMarketOrder(
@@ -223,8 +230,10 @@ protected:
     void            unsetEnv(const char* name);
     void            monitorEnv(const char* name);
     
-    // load historical data, currently only supports synchronized mode.
-    // `onHistoricalData` will be called back immediately.
+    // load historical data. In synchronized mode `onHistoricalData` will be
+    // called back immediately and the number of bars is returned. In
+    // asynchronous mode the request id is returned and the bars are
+    // delivered before the next bar, in the order of requests.
     int             loadHistoricalData(const DataRequest& request);
 
     bool            aggregateBarSeries(const TradingSession& session,
@@ -30,7 +30,7 @@ void KDJ::init(BarSeries& barSeries, int period, int slowLen, int smoothLen, int
     m_smoothLen = smoothLen;
 
     m_barSeries.setMaxLen(period);
-    barSeries.getNewValueEvent().subscribe(this);
+    barSeries.getNewValueEvent().subscribe<KDJ, &KDJ::onNewValue>(this);
 }
 
 DataSeries& KDJ::getK()
@@ -48,7 +48,7 @@ DataSeries& KDJ::getJ()
     return m_j;
 }
 
-void KDJ::onNewValue(const DateTime& datetime, Bar& value)
+void KDJ::onNewValue(const DateTime& datetime, const Bar& value)
 {
     m_barSeries.appendWithDateTime(datetime, &value);
     int len = m_barSeries.length();
@@ -85,12 +85,4 @@ void KDJ::onNewValue(const DateTime& datetime, Bar& value)
     }
 }
 
-void KDJ::onEvent(int type, const DateTime& datetime, const void *context)
-{
-    if (type == Event::EvtDataSeriesNewValue) {
-        Event::Context& ctx = *((Event::Context *)context);
-        onNewValue(ctx.datetime, *((Bar *)ctx.data));
-    }
-}
-
 } // namespace xBacktest
\ No newline at end of file
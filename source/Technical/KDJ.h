@@ -19,7 +19,7 @@ namespace xBacktest
  *  D:SMA(K,M2,1);
  *  J:3*K-2*D;
  */
-class DllExport KDJ : public SequenceDataSeries<Bar>, public IEventHandler
+class DllExport KDJ : public SequenceDataSeries<Bar>
 {
 public:
     void init(BarSeries& barSeries, int period = 9, int slowLen = 3, int smoothLen = 3, int maxLen = DataSeries::DEFAULT_MAX_LEN);
@@ -28,8 +28,7 @@ public:
     DataSeries& getJ();
 
 private:
-    void onEvent(int type, const DateTime& datetime, const void *context);
-    void onNewValue(const DateTime& datetime, Bar& value);
+    void onNewValue(const DateTime& datetime, const Bar& value);
 
 private:
     int m_period;
@@ -14,7 +14,8 @@ void MACD::init(DataSeries& dataSeries, int fastEMA, int slowEMA, int signalEMA,
     m_slowEMAWindow.init(slowEMA);
     m_signalEMAWindow.init(signalEMA);
 
-    dataSeries.getNewValueEvent().subscribe(this);
+    bool connected = m_input.connect(&dataSeries, this);
+    REQUIRE(connected, "Type of the data series doesn't match the filter.");
 }
 
 DataSeries& MACD::getSignal()
@@ -27,7 +28,7 @@ DataSeries& MACD::getHistogram()
     return m_histogram;
 }
 
-void MACD::onNewValue(const DateTime& datetime, double value)
+void MACD::onNewValue(const DateTime& datetime, const double& value)
 {
     double diff           = std::numeric_limits<double>::quiet_NaN();
     double macdValue      = std::numeric_limits<double>::quiet_NaN();
@@ -61,12 +62,4 @@ void MACD::onNewValue(const DateTime& datetime, double value)
     m_histogram.appendWithDateTime(datetime, &histogramValue);
 }
 
-void MACD::onEvent(int type, const void* context)
-{
-    if (type == Event::EvtDataSeriesNewValue) {
-        Event::Context& ctx = *((Event::Context *)context);
-        onNewValue(ctx.datetime, *((double *)ctx.data));
-    }
-}
-
 } // namespace xBacktest
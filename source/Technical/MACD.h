@@ -10,7 +10,7 @@ namespace xBacktest
 
 // Moving Average Convergence-Divergence indicator as described in 
 // http://stockcharts.com/school/doku.php?id=chart_school:technical_indicators:moving_average_conve.
-class DllExport MACD : public SequenceDataSeries<double>, public IEventHandler
+class DllExport MACD : public SequenceDataSeries<double>
 {
 public:
     void init(DataSeries& dataSeries, int fastEMA = 12, int slowEMA = 26, int signalEMA = 9, int maxLen = DataSeries::DEFAULT_MAX_LEN);
@@ -20,8 +20,7 @@ public:
     DataSeries& getHistogram();
 
 private:
-    void onEvent(int type, const void* context);
-    void onNewValue(const DateTime& datetime, double value);
+    void onNewValue(const DateTime& datetime, const double& value);
 
 private:
     int m_fastEMASkip;
@@ -30,6 +29,7 @@ private:
     EMAEventWindow m_signalEMAWindow;
     SequenceDataSeries<double> m_signal;
     SequenceDataSeries<double> m_histogram;
+    ConvertingSlot<double, MACD, &MACD::onNewValue> m_input;
 };
 
 } // namespace xBacktest
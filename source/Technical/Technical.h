@@ -2,6 +2,7 @@
 #define TECHNICAL_H
 
 #include <limits>
+#include <type_traits>
 #include <math.h>
 #include "DateTime.h"
 #include "DataSeries.h"
@@ -188,12 +189,75 @@ private:
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
 
+// A ConvertingSlot feeds the new values of a data series to `Method` of its
+// target. Values of a numeric series of another type are converted to T, so
+// a filter over doubles can take e.g. the volume series.
+// @param: T: Target accept this type of data.
+template<typename T, typename Target, void (Target::*Method)(const DateTime&, const T&)>
+class ConvertingSlot
+{
+public:
+    ConvertingSlot() : m_target(nullptr) {}
+
+    // Returns false if values of the data series can't be converted to T.
+    bool connect(DataSeries* dataSeries, Target* target)
+    {
+        m_target = target;
+
+        // Same type, the target gets the values directly.
+        SequenceDataSeries<T>* input = dynamic_cast<SequenceDataSeries<T>*>(dataSeries);
+        if (input != nullptr) {
+            input->getNewValueEvent().template subscribe<Target, Method>(target);
+            return true;
+        }
+
+        return connectConverted(dataSeries, std::is_arithmetic<T>());
+    }
+
+private:
+    bool connectConverted(DataSeries* dataSeries, std::false_type)
+    {
+        return false;
+    }
+
+    bool connectConverted(DataSeries* dataSeries, std::true_type)
+    {
+        return connectAs<double>(dataSeries) ||
+               connectAs<long long>(dataSeries) ||
+               connectAs<int>(dataSeries);
+    }
+
+    template<typename SourceType>
+    bool connectAs(DataSeries* dataSeries)
+    {
+        SequenceDataSeries<SourceType>* input = dynamic_cast<SequenceDataSeries<SourceType>*>(dataSeries);
+        if (input == nullptr) {
+            return false;
+        }
+
+        input->getNewValueEvent().template subscribe<ConvertingSlot, &ConvertingSlot::template onNewValue<SourceType>>(this);
+        return true;
+    }
+
+    template<typename SourceType>
+    void onNewValue(const DateTime& datetime, const SourceType& value)
+    {
+        T converted = (T)value;
+        (m_target->*Method)(datetime, converted);
+    }
+
+    Target* m_target;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
 // An EventBasedFilter class is responsible for capturing new values in a DataSeries
 // and using an EventWindow to calculate new values.
 // @param: FilterType: Filter capturing this type of data stream.
 // @param: ValueType: Filter output this type of data item.
 template<typename FilterType = double, typename ValueType = double>
-class EventBasedFilter : public SequenceDataSeries<ValueType>, public IEventHandler
+class EventBasedFilter : public SequenceDataSeries<ValueType>
 {
 public:
     EventBasedFilter() {}
@@ -206,7 +270,9 @@ public:
         SequenceDataSeries<ValueType>::setMaxLen(maxLen);
         m_dataSeries  = dataSeries;
         m_eventWindow = eventWindow;
-        m_dataSeries->getNewValueEvent().subscribe(this);
+
+        bool connected = m_input.connect(dataSeries, this);
+        REQUIRE(connected, "Type of the data series doesn't match the filter.");
     }
 
 	DataSeries* getDataSeries() const;
@@ -220,22 +286,20 @@ public:
     }
 
 private:
-    void onEvent(int type, const DateTime& datetime, const void* context)
-    {
-        if (type == Event::EvtDataSeriesNewValue) {
-            Event::Context& ctx = *((Event::Context *)context);
-            // Let the event window perform calculations.
-            m_eventWindow->onNewValue(ctx.datetime, *(FilterType *)ctx.data);
-            // Get the resulting value.
-            // If event window is not full yet, resulting value is None.
-            ValueType newValue = m_eventWindow->getValue();
-            // Add the new value.
-            SequenceDataSeries<ValueType>::appendWithDateTime(ctx.datetime, &newValue);
-        }
+    void onNewValue(const DateTime& datetime, const FilterType& value)
+    {
+        // Let the event window perform calculations.
+        m_eventWindow->onNewValue(datetime, value);
+        // Get the resulting value.
+        // If event window is not full yet, resulting value is None.
+        ValueType newValue = m_eventWindow->getValue();
+        // Add the new value.
+        SequenceDataSeries<ValueType>::appendWithDateTime(datetime, &newValue);
     }
 
 	DataSeries* m_dataSeries;
 	EventWindow<FilterType, ValueType>* m_eventWindow;
+    ConvertingSlot<FilterType, EventBasedFilter, &EventBasedFilter::onNewValue> m_input;
 };
 
 } // namespace xBacktest
@@ -256,10 +256,6 @@ DateTime::DateTime(long long ticks)
    t_.tv_usec = (ticks % 1000) * 1000;
 }
 
-DateTime::DateTime(const DateTime& date) : t_(date.t_) 
-{
-}
-
 DateTime::DateTime(int year, int month, int day, int hour, int minute, int second, int ms)
 {
     struct tm utc;
@@ -359,10 +355,6 @@ DateTime::DateTime(const string& d)
 }
 #endif
 
-DateTime::~DateTime() 
-{
-}
-
 void DateTime::markInvalid() {
 	t_ = kInvalidTimeval_;
 }
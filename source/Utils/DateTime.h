@@ -30,8 +30,7 @@ public:
 	explicit DateTime(const string& date);
     // ticks: elapsed milliseconds since the Epoch
     explicit DateTime(long long ticks);
-	DateTime(const DateTime& date);
-	~DateTime();
+	// Copies are the implicit ones, a DateTime is trivially copyable.
 	string toString() const;
 
 	bool isValid() const { return t_.tv_sec != kInvalidEpoch_; }
@@ -75,11 +74,6 @@ public:
         return toString();
     }
 
-	DateTime& operator=(const DateTime& date) {
-		t_ = date.t_;
-		return *this;
-	}
-
     DateTime operator -(const DateTime& date) const {
         DateTime dt;
         dt.t_.tv_sec  = t_.tv_sec - date.t_.tv_sec;
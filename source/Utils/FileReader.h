@@ -0,0 +1,124 @@
+#ifndef UTILS_FILEREADER_H
+#define UTILS_FILEREADER_H
+
+#include <string>
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+namespace Utils
+{
+
+/**
+Read-only file supporting positioned reads, which don't move a shared file pointer
+and may therefore be issued concurrently by several threads.
+*/
+class FileReader
+{
+public:
+
+    /**
+    Constructor. Opens the given file for reading.
+    \param sequential Hints the OS that the file will be read sequentially.
+    */
+    explicit FileReader(const std::string &filename, bool sequential = true)
+    {
+#ifdef _MSC_VER
+        mHandle = CreateFileA(filename.c_str(),
+                              GENERIC_READ,
+                              FILE_SHARE_READ,
+                              NULL,
+                              OPEN_EXISTING,
+                              sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL,
+                              NULL);
+#else
+        mHandle = open(filename.c_str(), O_RDONLY);
+#if defined(POSIX_FADV_SEQUENTIAL)
+        if (mHandle >= 0 && sequential) {
+            posix_fadvise(mHandle, 0, 0, POSIX_FADV_SEQUENTIAL);
+        }
+#endif
+#endif
+    }
+
+    /**
+    Destructor. Closes the file.
+    */
+    ~FileReader()
+    {
+        if (IsOpen()) {
+#ifdef _MSC_VER
+            CloseHandle(mHandle);
+#else
+            close(mHandle);
+#endif
+        }
+    }
+
+    /**
+    Returns true if the file was opened successfully.
+    */
+    bool IsOpen() const
+    {
+#ifdef _MSC_VER
+        return mHandle != INVALID_HANDLE_VALUE;
+#else
+        return mHandle >= 0;
+#endif
+    }
+
+    /**
+    Reads exactly \p size bytes at \p offset into \p buffer.
+    \return False on errors or if the file ends before \p size bytes were read.
+    */
+    bool Read(uint64_t offset, void *buffer, size_t size) const
+    {
+        char *dest = static_cast<char *>(buffer);
+        while (size > 0) {
+#ifdef _MSC_VER
+            OVERLAPPED overlapped = { 0 };
+            overlapped.Offset = (DWORD)(offset & 0xFFFFFFFF);
+            overlapped.OffsetHigh = (DWORD)(offset >> 32);
+            DWORD chunk = size > 0x40000000 ? 0x40000000 : (DWORD)size;
+            DWORD bytes = 0;
+            if (!ReadFile(mHandle, dest, chunk, &bytes, &overlapped) || bytes == 0) {
+                return false;
+            }
+#else
+            ssize_t bytes = pread(mHandle, dest, size, (off_t)offset);
+            if (bytes < 0 && errno == EINTR) {
+                continue;
+            }
+            if (bytes <= 0) {
+                return false;
+            }
+#endif
+            dest += bytes;
+            offset += bytes;
+            size -= bytes;
+        }
+
+        return true;
+    }
+
+private:
+
+    FileReader(const FileReader &other);
+    FileReader &operator=(const FileReader &other);
+
+#ifdef _MSC_VER
+    HANDLE mHandle;     ///< Handle of the opened file.
+#else
+    int mHandle;        ///< Descriptor of the opened file.
+#endif
+};
+
+} // namespace Utils
+
+#endif // UTILS_FILEREADER_H
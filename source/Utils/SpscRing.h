@@ -0,0 +1,133 @@
+#ifndef UTILS_SPSCRING_H
+#define UTILS_SPSCRING_H
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace Utils
+{
+
+/**
+A bounded lock-free ring for exactly one producer thread and one consumer thread.
+Slots are reused in place, so items holding buffers keep their capacity:
+the producer fills the slot returned by \ref Acquire and makes it visible
+with \ref Publish, the consumer reads the slot returned by \ref Peek and
+hands it back with \ref Release.
+*/
+template<typename T>
+class SpscRing
+{
+public:
+
+    /**
+    Constructor.
+    \param capacity Number of slots, rounded up to a power of two.
+    */
+    explicit SpscRing(size_t capacity) : mHead(0), mTail(0)
+    {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+
+        mSlots.resize(size);
+        mMask = size - 1;
+    }
+
+    /**
+    Returns the next free slot, or null if the ring is full. Producer only.
+    */
+    T* TryAcquire()
+    {
+        size_t head = mHead.load(std::memory_order_relaxed);
+        if (head - mTail.load(std::memory_order_acquire) == mSlots.size()) {
+            return nullptr;
+        }
+
+        return &mSlots[head & mMask];
+    }
+
+    /**
+    Waits for the next free slot. Producer only.
+    */
+    T* Acquire()
+    {
+        T* slot = nullptr;
+        for (int spins = 0; (slot = TryAcquire()) == nullptr; spins++) {
+            Backoff(spins);
+        }
+
+        return slot;
+    }
+
+    /**
+    Makes the acquired slot visible to the consumer. Producer only.
+    */
+    void Publish()
+    {
+        mHead.store(mHead.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+    Returns the oldest published slot, or null if the ring is empty. Consumer only.
+    */
+    T* TryPeek()
+    {
+        size_t tail = mTail.load(std::memory_order_relaxed);
+        if (mHead.load(std::memory_order_acquire) == tail) {
+            return nullptr;
+        }
+
+        return &mSlots[tail & mMask];
+    }
+
+    /**
+    Waits for a published slot. Consumer only.
+    */
+    T* Peek()
+    {
+        T* slot = nullptr;
+        for (int spins = 0; (slot = TryPeek()) == nullptr; spins++) {
+            Backoff(spins);
+        }
+
+        return slot;
+    }
+
+    /**
+    Hands the peeked slot back to the producer. Consumer only.
+    */
+    void Release()
+    {
+        mTail.store(mTail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+private:
+
+    // Yield first, a waiting side that keeps losing sleeps so it doesn't
+    // hold a core while the other side catches up.
+    static void Backoff(int spins)
+    {
+        if (spins < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+    SpscRing(const SpscRing &other);
+    SpscRing &operator=(const SpscRing &other);
+
+    std::vector<T> mSlots;                  ///< Slots, a power of two of them.
+    size_t mMask;                           ///< Maps a position to its slot.
+    char mPadding0[64];                     ///< Keeps the counters on their own cache lines.
+    std::atomic<size_t> mHead;              ///< Next position to publish, written by the producer.
+    char mPadding1[64];
+    std::atomic<size_t> mTail;              ///< Next position to release, written by the consumer.
+};
+
+} // namespace Utils
+
+#endif // UTILS_SPSCRING_H
@@ -0,0 +1,118 @@
+#ifndef UTILS_THREADPOOL_H
+#define UTILS_THREADPOOL_H
+
+#include <cassert>
+#include <deque>
+#include <vector>
+#include <functional>
+
+#include "Thread.h"
+#include "Condition.h"
+
+namespace Utils
+{
+
+/**
+A fixed-size pool of worker threads executing queued tasks in FIFO order.
+*/
+class ThreadPool
+{
+public:
+
+    /**
+    Defines a unit of work executed by one of the workers.
+    */
+    typedef std::function<void()> Task;
+
+    /**
+    Constructor. Starts the given number of worker threads.
+    \param threadNum Number of worker threads, at least one thread is created.
+    */
+    explicit ThreadPool(int threadNum) : mStop(false)
+    {
+        if (threadNum < 1) {
+            threadNum = 1;
+        }
+
+        for (int i = 0; i < threadNum; i++) {
+            Thread* thread = new Thread();
+            thread->Start(ThreadProc, this);
+            mThreads.push_back(thread);
+        }
+    }
+
+    /**
+    Destructor. Runs all the queued tasks, then stops and joins the workers.
+    */
+    ~ThreadPool()
+    {
+        {
+            Lock lock(mMonitor.GetMutex());
+            mStop = true;
+            mMonitor.PulseAll();
+        }
+
+        for (size_t i = 0; i < mThreads.size(); i++) {
+            mThreads[i]->Join();
+            delete mThreads[i];
+        }
+        mThreads.clear();
+    }
+
+    /**
+    Queues a task, which will be executed by the first idle worker.
+    */
+    void Submit(const Task& task)
+    {
+        Lock lock(mMonitor.GetMutex());
+        assert(!mStop);
+        mTasks.push_back(task);
+        mMonitor.Pulse();
+    }
+
+    /**
+    Returns the number of worker threads.
+    */
+    int GetThreadNum() const
+    {
+        return (int)mThreads.size();
+    }
+
+private:
+
+    inline static void ThreadProc(void *const context)
+    {
+        ThreadPool* pool = reinterpret_cast<ThreadPool*>(context);
+
+        while (true) {
+            Task task;
+            {
+                Lock lock(pool->mMonitor.GetMutex());
+                while (pool->mTasks.empty() && !pool->mStop) {
+                    pool->mMonitor.Wait(lock);
+                }
+
+                if (pool->mTasks.empty()) {
+                    return;
+                }
+
+                task = pool->mTasks.front();
+                pool->mTasks.pop_front();
+            }
+
+            task();
+        }
+    }
+
+    ThreadPool(const ThreadPool &other);
+    ThreadPool &operator=(const ThreadPool &other);
+
+    std::vector<Thread*> mThreads;  ///< Worker threads.
+    std::deque<Task> mTasks;        ///< Tasks waiting for an idle worker.
+    Condition mMonitor;             ///< Guards the queue and wakes workers.
+    bool mStop;                     ///< Set on destruction, workers exit once the queue drains.
+};
+
+} // namespace Utils
+
+#endif // UTILS_THREADPOOL_H
@@ -39,6 +39,75 @@ T roundFloorMultiple(T value, T multiple)
     return static_cast<T>(std::floor(static_cast<double>(value) / static_cast<double>(multiple))*static_cast<double>(multiple));
 }
 
+// Fixed-point prices as integer counts of a tick size. A tick size is kept as
+// `unit` / 10^decimals, so prices decoded from ticks are the doubles nearest
+// to their decimal values and compare equal to prices parsed from text.
+class TickScale
+{
+public:
+    TickScale(double tickSize = 0)
+    {
+        m_unit  = 0;
+        m_scale = 1;
+        if (tickSize <= 0) {
+            return;
+        }
+
+        for (int decimals = 0; decimals <= 9; decimals++) {
+            double units = tickSize * m_scale;
+            if (std::fabs(units - std::llround(units)) < 0.000001) {
+                m_unit = std::llround(units);
+                return;
+            }
+            m_scale *= 10;
+        }
+        m_scale /= 10;
+        m_unit = std::llround(tickSize * m_scale);
+    }
+
+    bool isValid() const
+    {
+        return m_unit > 0;
+    }
+
+    // Nearest number of ticks.
+    long long toTicks(double price) const
+    {
+        return std::llround(price * m_scale / m_unit);
+    }
+
+    // Number of ticks not above/below `price`, a price on the tick grid maps
+    // to its own ticks.
+    long long floorTicks(double price) const
+    {
+        double ticks = price * m_scale / m_unit;
+        long long nearest = std::llround(ticks);
+        return std::fabs(ticks - nearest) < 0.000001 ? nearest : (long long)std::floor(ticks);
+    }
+
+    long long ceilTicks(double price) const
+    {
+        double ticks = price * m_scale / m_unit;
+        long long nearest = std::llround(ticks);
+        return std::fabs(ticks - nearest) < 0.000001 ? nearest : (long long)std::ceil(ticks);
+    }
+
+    double toPrice(long long ticks) const
+    {
+        return (double)(ticks * m_unit) / m_scale;
+    }
+
+    // Snap `price` to the nearest price on the tick grid.
+    double round(double price) const
+    {
+        return toPrice(toTicks(price));
+    }
+
+private:
+    long long m_unit;
+    double    m_scale;
+};
+
 } // namespace Utils
 
 #endif // UTILS_H
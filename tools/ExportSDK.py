@@ -12,7 +12,7 @@ incl_files = [
     'Broker/Order.h',
     'Strategy/Position.h',
     'Strategy/Strategy.h',
-    'Core/Event.h',
+    'Core/Signal.h',
     'Core/Bar.h',
     'Core/Defines.h',
     'Core/Simulator.h',
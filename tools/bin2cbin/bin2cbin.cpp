@@ -0,0 +1,22 @@
+#include <iostream>
+#include <cstdlib>
+
+#include "../../Source/Feed/CompressedFileLoader.h"
+
+using namespace xBacktest;
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3 && argc != 4) {
+        std::cout << "Usage: " << argv[0] << " <input bin file> <output cbin file> [rows per block]." << std::endl;
+        return -1;
+    }
+
+    int blockRows = (argc == 4) ? atoi(argv[3]) : 1024;
+    if (!CompressedFileLoader::convertBinFile(argv[1], argv[2], blockRows)) {
+        std::cout << "Failed to convert '" << argv[1] << "'." << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
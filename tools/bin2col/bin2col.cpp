@@ -0,0 +1,20 @@
+#include <iostream>
+
+#include "../../Source/Feed/ColumnarFileLoader.h"
+
+using namespace xBacktest;
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3) {
+        std::cout << "Usage: " << argv[0] << " <input bin file> <output col file>." << std::endl;
+        return -1;
+    }
+
+    if (!ColumnarFileLoader::convertBinFile(argv[1], argv[2])) {
+        std::cout << "Failed to convert '" << argv[1] << "'." << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,39 @@
+#include <iostream>
+#include <cstring>
+
+#include "../../Source/Feed/ContinuousContract.h"
+
+using namespace xBacktest;
+
+int main(int argc, char* argv[])
+{
+    if (argc != 4 && argc != 5) {
+        std::cout << "Usage: " << argv[0] << " <input bin file> <output bin file> <instrument> [back|none]." << std::endl;
+        return -1;
+    }
+
+    int adjustment = BackAdjusted;
+    if (argc == 5) {
+        if (strcmp(argv[4], "none") == 0) {
+            adjustment = NoAdjustment;
+        } else if (strcmp(argv[4], "back") != 0) {
+            std::cout << "Unknown adjustment '" << argv[4] << "'." << std::endl;
+            return -1;
+        }
+    }
+
+    vector<ContinuousContract::Segment> segments;
+    if (!ContinuousContract::build(argv[1], argv[2], argv[3], adjustment, segments)) {
+        std::cout << "Failed to build continuous contract from '" << argv[1] << "'." << std::endl;
+        return -1;
+    }
+
+    for (size_t i = 0; i < segments.size(); i++) {
+        std::cout << segments[i].contract << "  "
+                  << segments[i].begin.toString() << " - " << segments[i].end.toString()
+                  << "  gap " << segments[i].gap
+                  << "  adjustment " << segments[i].adjustment << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,41 @@
+#include <iostream>
+#include <cstring>
+
+#include "../../Source/Utils/Utils.h"
+#include "../../Source/Feed/DataStorage.h"
+
+using namespace xBacktest;
+
+// Merge feeds of a data file into '<file>.tl' ahead of backtesting.
+int main(int argc, char* argv[])
+{
+    if (argc != 3) {
+        std::cout << "Usage: " << argv[0] << " <data file> <format: bin|col|cbin|csv>." << std::endl;
+        return -1;
+    }
+
+    int format = DATA_FILE_FORMAT_UNKNOWN;
+    if (!_stricmp(argv[2], "bin")) {
+        format = DATA_FILE_FORMAT_BIN;
+    } else if (!_stricmp(argv[2], "col")) {
+        format = DATA_FILE_FORMAT_COL;
+    } else if (!_stricmp(argv[2], "cbin")) {
+        format = DATA_FILE_FORMAT_CMP;
+    } else if (!_stricmp(argv[2], "csv")) {
+        format = DATA_FILE_FORMAT_CSV;
+    } else {
+        std::cout << "Unknown format '" << argv[2] << "'." << std::endl;
+        return -1;
+    }
+
+    DataStorage storage;
+    storage.enableTimeline(true);
+
+    Contract contract;
+    if (!storage.loadDataStreamFile("timeline", argv[1], format, Bar::MINUTE, 1, contract)) {
+        std::cout << "Failed to load '" << argv[1] << "'." << std::endl;
+        return -1;
+    }
+
+    return 0;
+}